@@ -0,0 +1,56 @@
+#include "allocations.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static atomic<size_t> allocation_count(0);
+static atomic<size_t> allocation_bytes(0);
+
+AllocationCount allocations_so_far()
+{
+    AllocationCount allocations;
+    allocations.count = allocation_count.load(memory_order_relaxed);
+    allocations.bytes = allocation_bytes.load(memory_order_relaxed);
+    return allocations;
+}
+
+static void *counted_allocation(size_t size)
+{
+    allocation_count.fetch_add(1, memory_order_relaxed);
+    allocation_bytes.fetch_add(size, memory_order_relaxed);
+
+    void *memory = malloc(size == 0 ? 1 : size);
+    if (memory == nullptr)
+        throw bad_alloc();
+    return memory;
+}
+
+void *operator new(size_t size)
+{
+    return counted_allocation(size);
+}
+
+void *operator new[](size_t size)
+{
+    return counted_allocation(size);
+}
+
+void operator delete(void *memory) noexcept
+{
+    free(memory);
+}
+
+void operator delete[](void *memory) noexcept
+{
+    free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept
+{
+    free(memory);
+}
+
+void operator delete[](void *memory, size_t) noexcept
+{
+    free(memory);
+}
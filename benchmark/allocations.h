@@ -0,0 +1,25 @@
+/*
+allocations.h
+
+Counts heap allocations made by the benchmark process. The global `operator new` and
+`operator delete` are replaced in allocations.cpp, so linking that file in is enough to
+start counting. Allocation counts are deterministic, which makes them a useful signal
+alongside timings that are subject to noise.
+*/
+
+#pragma once
+#ifndef ALLOCATIONS_H
+#define ALLOCATIONS_H
+
+#include <cstddef>
+using namespace std;
+
+struct AllocationCount
+{
+    size_t count = 0;
+    size_t bytes = 0;
+};
+
+AllocationCount allocations_so_far();
+
+#endif
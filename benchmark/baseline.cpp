@@ -0,0 +1,463 @@
+#include "baseline.h"
+#include "synthetic.h"
+#include "../compiler/json.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+// CORPUS
+
+vector<CorpusProgram> collect_corpus()
+{
+    vector<CorpusProgram> corpus;
+
+    // Example and test programs
+    for (string dir : {"game", "test"})
+    {
+        if (!fs::exists(dir))
+            continue;
+
+        vector<CorpusProgram> programs;
+        for (const auto &entry : fs::recursive_directory_iterator(dir))
+        {
+            if (entry.is_regular_file() && entry.path().extension() == ".gambit")
+            {
+                auto path = entry.path().generic_string();
+                programs.push_back({path.substr(0, path.length() - 7), path});
+            }
+        }
+
+        // Directory iteration order is unspecified, so the corpus is sorted to keep baselines stable
+        sort(programs.begin(), programs.end(), [](const CorpusProgram &a, const CorpusProgram &b)
+             { return a.name < b.name; });
+        corpus.insert(corpus.end(), programs.begin(), programs.end());
+    }
+
+    // Synthetic programs
+    fs::create_directories("local/benchmark");
+
+    SyntheticParameters large;
+    large.entities = 16;
+    large.overloads = 4;
+    large.enum_size = 16;
+    large.nesting_depth = 8;
+    large.expression_length = 16;
+
+    vector<pair<string, SyntheticParameters>> synthetic = {
+        {"synthetic-default", SyntheticParameters()},
+        {"synthetic-large", large},
+    };
+
+    for (auto &entry : synthetic)
+    {
+        auto file_path = "local/benchmark/" + entry.first + ".gambit";
+        if (save_synthetic_program(file_path, entry.second))
+            corpus.push_back({entry.first, file_path});
+    }
+
+    return corpus;
+}
+
+// A minimal JSON reader, which is just enough to read back the baseline files written above.
+struct JsonValue
+{
+    enum Kind
+    {
+        Null,
+        Boolean,
+        Number,
+        String,
+        Array,
+        Object,
+    };
+
+    Kind kind = Null;
+    bool boolean = false;
+    double number = 0;
+    string str;
+    vector<JsonValue> array;
+    map<string, JsonValue> object;
+
+    const JsonValue &at(string key) const
+    {
+        static const JsonValue null_value;
+        auto it = object.find(key);
+        return it == object.end() ? null_value : it->second;
+    }
+};
+
+class JsonReader
+{
+public:
+    JsonReader(const string &text) : text(text){};
+
+    bool read(JsonValue &value)
+    {
+        return read_value(value) && (skip_whitespace(), position == text.length());
+    }
+
+private:
+    const string &text;
+    size_t position = 0;
+
+    void skip_whitespace()
+    {
+        while (position < text.length() && isspace((unsigned char)text[position]))
+            position++;
+    }
+
+    bool consume(char c)
+    {
+        skip_whitespace();
+        if (position < text.length() && text[position] == c)
+        {
+            position++;
+            return true;
+        }
+        return false;
+    }
+
+    bool read_string(string &str)
+    {
+        if (!consume('"'))
+            return false;
+
+        while (position < text.length() && text[position] != '"')
+        {
+            char c = text[position++];
+            if (c == '\\' && position < text.length())
+            {
+                char escaped = text[position++];
+                switch (escaped)
+                {
+                case 'n':
+                    str += '\n';
+                    break;
+                case 't':
+                    str += '\t';
+                    break;
+                case 'r':
+                    str += '\r';
+                    break;
+                case 'b':
+                    str += '\b';
+                    break;
+                case 'f':
+                    str += '\f';
+                    break;
+                case 'u':
+                    // Only the control characters written by `to_json(string)` are expected here
+                    str += (char)stoi(text.substr(position, 4), nullptr, 16);
+                    position += 4;
+                    break;
+                default:
+                    str += escaped;
+                }
+            }
+            else
+            {
+                str += c;
+            }
+        }
+
+        return consume('"');
+    }
+
+    bool read_value(JsonValue &value)
+    {
+        skip_whitespace();
+        if (position >= text.length())
+            return false;
+
+        char c = text[position];
+
+        if (c == '{')
+        {
+            position++;
+            value.kind = JsonValue::Object;
+            if (consume('}'))
+                return true;
+            do
+            {
+                string key;
+                JsonValue element;
+                if (!read_string(key) || !consume(':') || !read_value(element))
+                    return false;
+                value.object[key] = element;
+            } while (consume(','));
+            return consume('}');
+        }
+
+        if (c == '[')
+        {
+            position++;
+            value.kind = JsonValue::Array;
+            if (consume(']'))
+                return true;
+            do
+            {
+                JsonValue element;
+                if (!read_value(element))
+                    return false;
+                value.array.push_back(element);
+            } while (consume(','));
+            return consume(']');
+        }
+
+        if (c == '"')
+        {
+            value.kind = JsonValue::String;
+            return read_string(value.str);
+        }
+
+        for (string keyword : {"true", "false", "null"})
+        {
+            if (text.compare(position, keyword.length(), keyword) == 0)
+            {
+                position += keyword.length();
+                value.kind = keyword == "null" ? JsonValue::Null : JsonValue::Boolean;
+                value.boolean = keyword == "true";
+                return true;
+            }
+        }
+
+        size_t length = 0;
+        try
+        {
+            value.number = stod(text.substr(position), &length);
+        }
+        catch (const logic_error &)
+        {
+            return false;
+        }
+        value.kind = JsonValue::Number;
+        position += length;
+        return true;
+    }
+};
+
+// RECORD
+// NOTE: Times are stored in microseconds, as `to_json(double)` only serialises six decimal places.
+
+static size_t total_allocations(const PhaseTimings &timings)
+{
+    size_t total = 0;
+    for (auto allocations : timings.allocations)
+        total += allocations;
+    return total;
+}
+
+static PhaseMeasurement measure_program(const CorpusProgram &program, const BaselineOptions &options)
+{
+    printf("%-40s", program.name.c_str());
+    fflush(stdout);
+
+    auto measurement = measure_phases(program.file_path, options.repetitions);
+
+    printf(" %10s  %zu/%d phases  %zu allocations\n",
+           format_seconds(measurement.total.median).c_str(),
+           measurement.last_run.phases_completed,
+           (int)PHASE_COUNT,
+           total_allocations(measurement.last_run));
+
+    return measurement;
+}
+
+bool record_baseline(string baseline_path, BaselineOptions options)
+{
+    JsonContainer json;
+    json.object();
+    json.array("programs");
+
+    for (const auto &program : collect_corpus())
+    {
+        auto measurement = measure_program(program, options);
+        const auto &last_run = measurement.last_run;
+
+        json.object();
+        json.add("name", program.name);
+        json.add("phases_completed", (int)last_run.phases_completed);
+        json.add("gambit_errors", (int)last_run.gambit_errors);
+        json.object("phases");
+        for (size_t phase = 0; phase < last_run.phases_completed; phase++)
+        {
+            json.object(phase_names[phase]);
+            json.add("median_us", measurement.phases[phase].median * 1e6);
+            json.add("mad_us", measurement.phases[phase].mad * 1e6);
+            json.add("allocations", (int)last_run.allocations[phase]);
+            json.add("allocated_bytes", (int)last_run.allocated_bytes[phase]);
+            json.close();
+        }
+        json.close();
+        json.close();
+    }
+
+    json.close();
+    json.close();
+
+    std::ofstream output;
+    output.open(baseline_path);
+    if (!output.is_open())
+    {
+        cout << "Error attempting to save baseline to " + baseline_path << endl;
+        return false;
+    }
+
+    output << (string)json;
+    output.close();
+
+    cout << "Saved baseline to " << baseline_path << endl;
+    return true;
+}
+
+// COMPARE
+
+static bool load_baseline(string baseline_path, JsonValue &baseline)
+{
+    std::ifstream file(baseline_path);
+    if (!file.is_open())
+    {
+        cout << "Could not open baseline " << baseline_path << endl;
+        return false;
+    }
+
+    stringstream buffer;
+    buffer << file.rdbuf();
+    string text = buffer.str();
+
+    JsonReader reader(text);
+    if (!reader.read(baseline) || baseline.at("programs").kind != JsonValue::Array)
+    {
+        cout << "Could not read baseline " << baseline_path << endl;
+        return false;
+    }
+
+    return true;
+}
+
+static string format_change(double baseline, double current)
+{
+    if (baseline == 0)
+        return current == 0 ? "+0.0%" : "new";
+
+    char buf[32];
+    snprintf(buf, sizeof buf, "%+.1f%%", (current - baseline) / baseline * 100);
+    return buf;
+}
+
+static void print_comparison_row(string program, string phase, string baseline, string current, string change, string allocations, string status)
+{
+    printf("%-32s %-10s %12s %12s %8s %10s  %s\n",
+           program.c_str(), phase.c_str(), baseline.c_str(), current.c_str(), change.c_str(), allocations.c_str(), status.c_str());
+}
+
+int compare_to_baseline(string baseline_path, BaselineOptions options)
+{
+    JsonValue baseline;
+    if (!load_baseline(baseline_path, baseline))
+        return -1;
+
+    map<string, const JsonValue *> baseline_programs;
+    for (const auto &program : baseline.at("programs").array)
+        baseline_programs[program.at("name").str] = &program;
+
+    // Measure everything before printing the comparison, so that the table is not broken up
+    vector<pair<CorpusProgram, PhaseMeasurement>> measurements;
+    for (const auto &program : collect_corpus())
+        measurements.emplace_back(program, measure_program(program, options));
+
+    int regressions = 0;
+
+    cout << endl;
+    print_comparison_row("program", "phase", "baseline", "current", "time", "allocs", "");
+
+    for (const auto &[program, measurement] : measurements)
+    {
+        const auto &last_run = measurement.last_run;
+
+        auto it = baseline_programs.find(program.name);
+        if (it == baseline_programs.end())
+        {
+            print_comparison_row(program.name, "", "", "", "", "", "not in baseline");
+            continue;
+        }
+
+        const JsonValue &recorded = *it->second;
+        baseline_programs.erase(it);
+
+        size_t recorded_phases = (size_t)recorded.at("phases_completed").number;
+        if (last_run.phases_completed < recorded_phases)
+        {
+            string status = "REGRESSION: stopped after " + to_string(last_run.phases_completed) + " of " + to_string(recorded_phases) + " phases";
+            if (last_run.compiler_error != "")
+                status += " (" + last_run.compiler_error + ")";
+            print_comparison_row(program.name, "", "", "", "", "", status);
+            regressions++;
+        }
+
+        for (size_t phase = 0; phase < last_run.phases_completed; phase++)
+        {
+            const JsonValue &recorded_phase = recorded.at("phases").at(phase_names[phase]);
+            if (recorded_phase.kind != JsonValue::Object)
+                continue;
+
+            double baseline_median = recorded_phase.at("median_us").number / 1e6;
+            double baseline_mad = recorded_phase.at("mad_us").number / 1e6;
+            double baseline_allocations = recorded_phase.at("allocations").number;
+
+            double current_median = measurement.phases[phase].median;
+            double current_mad = measurement.phases[phase].mad;
+            double current_allocations = (double)last_run.allocations[phase];
+
+            // Timings are only a regression if the change is outside the threshold, outside of
+            // the measured noise, and larger than the timer can reliably resolve.
+            double delta = current_median - baseline_median;
+            bool slower = delta > baseline_median * options.threshold &&
+                          delta > options.noise_deviations * max(baseline_mad, current_mad) &&
+                          delta > options.min_seconds;
+            bool faster = -delta > baseline_median * options.threshold &&
+                          -delta > options.noise_deviations * max(baseline_mad, current_mad) &&
+                          -delta > options.min_seconds;
+
+            // Allocation counts are deterministic, so any growth beyond the threshold is real
+            bool more_allocations = current_allocations > baseline_allocations * (1 + options.threshold);
+
+            string status;
+            if (slower)
+                status = "REGRESSION: slower";
+            if (more_allocations)
+                status += string(status == "" ? "REGRESSION: " : ", ") + "more allocations";
+            if (status == "" && faster)
+                status = "faster";
+
+            if (slower || more_allocations)
+                regressions++;
+
+            print_comparison_row(phase == 0 ? program.name : "",
+                                 phase_names[phase],
+                                 format_seconds(baseline_median),
+                                 format_seconds(current_median),
+                                 format_change(baseline_median, current_median),
+                                 format_change(baseline_allocations, current_allocations),
+                                 status);
+        }
+    }
+
+    for (const auto &[name, recorded] : baseline_programs)
+        print_comparison_row(name, "", "", "", "", "", "missing from corpus");
+
+    cout << endl;
+    if (regressions > 0)
+        cout << regressions << " regression(s) found against " << baseline_path << endl;
+    else
+        cout << "No regressions found against " << baseline_path << endl;
+
+    return regressions;
+}
@@ -0,0 +1,49 @@
+/*
+baseline.h
+
+Records the performance of the compiler over a fixed corpus of programs into a baseline
+JSON file, and compares later builds of the compiler against that baseline.
+
+The corpus is made up of every program in game/ and test/, as well as a number of synthetic
+programs. A comparison fails if any phase of any program is slower than the baseline by more
+than the noise threshold, allocates more than the baseline by more than the threshold, or no
+longer completes a phase that it used to.
+*/
+
+#pragma once
+#ifndef BASELINE_H
+#define BASELINE_H
+
+#include "phases.h"
+#include <string>
+#include <vector>
+using namespace std;
+
+struct BaselineOptions
+{
+    RepetitionOptions repetitions;
+
+    // A phase is a regression if its median time grows by more than this fraction of the
+    // baseline, and the growth is larger than `noise_deviations` median absolute deviations.
+    double threshold = 0.10;
+    double noise_deviations = 3;
+
+    // Differences smaller than this are ignored, as phases that take only a few microseconds
+    // are dominated by timer resolution and scheduling noise.
+    double min_seconds = 20e-6;
+};
+
+struct CorpusProgram
+{
+    string name;
+    string file_path;
+};
+
+vector<CorpusProgram> collect_corpus();
+
+bool record_baseline(string baseline_path, BaselineOptions options);
+
+// Returns the number of regressions found, or -1 if the baseline could not be read.
+int compare_to_baseline(string baseline_path, BaselineOptions options);
+
+#endif
@@ -0,0 +1,95 @@
+#include "batch.h"
+#include "tic-tac-toe.h"
+#include <chrono>
+#include <cstdio>
+#include <memory>
+using namespace std;
+
+struct BatchResult
+{
+    double seconds = 0;
+    uint64_t wins[2] = {0, 0};
+    uint64_t draws = 0;
+
+    void record(int8_t winner)
+    {
+        if (winner < 0)
+            draws++;
+        else
+            wins[winner]++;
+    }
+};
+
+static void print_result(const char *name, const BatchResult &result, uint64_t games, double one_at_a_time)
+{
+    double games_per_second = games / result.seconds;
+    printf("%-16s %14.0f %9.2fx %9.1f%% %9.1f%% %9.1f%%\n",
+           name,
+           games_per_second,
+           one_at_a_time > 0 ? games_per_second / one_at_a_time : 1.0,
+           100.0 * result.wins[0] / games,
+           100.0 * result.wins[1] / games,
+           100.0 * result.draws / games);
+}
+
+static BatchResult play_one_at_a_time(const TicTacToe::State &start, uint64_t games)
+{
+    BatchResult result;
+    GambitRandom random(1234);
+    auto state = make_unique<TicTacToe::State>();
+    uint32_t moves[TicTacToe::MAX_MOVES];
+
+    auto begin = chrono::steady_clock::now();
+    for (uint64_t i = 0; i < games; i++)
+    {
+        gambit_clone(*state, start);
+        gambit_playout<TicTacToe>(*state, random, moves);
+        result.record(state->outcome.winner);
+    }
+    result.seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    return result;
+}
+
+template <uint32_t Lanes>
+static BatchResult play_batched(const TicTacToe::State &start, uint64_t games)
+{
+    BatchResult result;
+    GambitBatchRandom<Lanes> random(1234);
+    auto batch = make_unique<TicTacToe::Batch<Lanes>>();
+
+    auto begin = chrono::steady_clock::now();
+    gambit_batch_playouts<TicTacToe>(*batch, start, games, random, [&](const TicTacToe::Batch<Lanes> &batch, uint32_t lane)
+                                     { result.record(batch.outcome.winner[lane]); });
+    result.seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    return result;
+}
+
+template <uint32_t Lanes>
+static void benchmark_lanes(const TicTacToe::State &start, uint64_t games, double one_at_a_time)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%u lanes", Lanes);
+    print_result(name, play_batched<Lanes>(start, games), games, one_at_a_time);
+}
+
+bool benchmark_batch(BatchBenchmarkOptions options)
+{
+    auto start = make_unique<TicTacToe::State>();
+    TicTacToe::setup(*start);
+
+    printf("%llu random games of tic-tac-toe, played one at a time and in batches of lanes that\n", (unsigned long long)options.games);
+    printf("step in lockstep. Each lane starts a new game as soon as its last one ends.\n\n");
+    printf("%-16s %14s %10s %10s %10s %10s\n", "", "games/sec", "speedup", "player 1", "player 2", "draws");
+
+    auto one_at_a_time = play_one_at_a_time(*start, options.games);
+    print_result("one at a time", one_at_a_time, options.games, 0);
+
+    double baseline = options.games / one_at_a_time.seconds;
+    benchmark_lanes<16>(*start, options.games, baseline);
+    benchmark_lanes<64>(*start, options.games, baseline);
+    benchmark_lanes<256>(*start, options.games, baseline);
+    benchmark_lanes<1024>(*start, options.games, baseline);
+    benchmark_lanes<4096>(*start, options.games, baseline);
+
+    return true;
+}
@@ -0,0 +1,23 @@
+/*
+batch.h
+
+Measures how many games per second can be played out at random, comparing playing one game at a
+time against playing batches of games in lockstep (see runtime/batch.h). Batches of several sizes
+are played, on the hand written port of tic-tac-toe, and the share of games won by each player is
+printed for both, as they should play out the same games on average.
+*/
+
+#pragma once
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <cstdint>
+
+struct BatchBenchmarkOptions
+{
+    uint64_t games = 1000000;
+};
+
+bool benchmark_batch(BatchBenchmarkOptions options);
+
+#endif
@@ -0,0 +1,381 @@
+/*
+card-attack.h
+
+A port of game/card-attack to C++, written against the runtime in the way that the generator
+lays out a game: entity tables and state property columns in a single state struct, with every
+write to the state going through the journal functions. The compiler cannot yet generate the
+control flow of `main`, so the port writes it by hand, as a state machine that stops at each
+`choose` and waits for the move that was chosen.
+
+Moves are the values written by legal_moves, and only mean something for the state they were
+generated from. The `choose bool` and `choose[2]` of an attack are combined into one decision,
+over every attack that `can_attack` allows (as suggested by the TODO in the game). Games are
+ended as a draw after MAX_TURNS, as random play can otherwise keep passing forever.
+
+The rules deal hands face up, so the only thing a player cannot see is the order of the deck.
+The HiddenHands variant deals them face down instead, with a card only revealed to the other
+player once tokens are put on it, to give information set searches (see ismcts.h) something to
+work with.
+*/
+
+#pragma once
+#ifndef CARD_ATTACK_H
+#define CARD_ATTACK_H
+
+#include "../runtime/gambit.h"
+#include <cstdint>
+#include <cstring>
+
+enum CardAttackRank
+{
+    ACE = 0,
+    JACK = 10,
+    QUEEN = 11,
+    KING = 12,
+    RANK_COUNT = 13,
+};
+
+constexpr int SUIT_COUNT = 4;
+constexpr uint32_t HAND_SIZE = 8;
+
+enum CardAttackPhase
+{
+    CHOOSE_CARD,    // Which card would you like to add tokens to?
+    CHOOSE_TOKENS,  // How many tokens?
+    CHOOSE_ATTACK,  // Who would you like to attack, and with who?
+    CHOOSE_DISCARD, // Which attacker would you like to discard?
+};
+
+template <uint32_t CardCapacity>
+struct CardAttackState
+{
+    GambitEntityTable<CardCapacity> Card;
+    GambitEntityTable<2> Player;
+
+    GambitColumn<int, CardCapacity> Card_rank;
+    GambitColumn<int, CardCapacity> Card_suit;
+    GambitColumn<int, CardCapacity> Card_tokens;
+    GambitColumn<GambitList<GambitEntity, HAND_SIZE>, 2> Player_cards;
+    GambitColumn<int, 2> Player_tokens;
+
+    // The local variables of `main`
+    GambitList<GambitEntity, CardCapacity> deck;
+    GambitEntity current_player;
+    GambitEntity other_player;
+    GambitEntity chosen_card;
+    GambitEntity attacker_one;
+    GambitEntity attacker_two;
+
+    int phase;
+    int turn;
+
+    GambitOutcome outcome;
+};
+
+template <uint32_t CardCapacity>
+inline void gambit_hash(GambitHasher &hasher, const CardAttackState<CardCapacity> &state)
+{
+    gambit_hash(hasher, state.Card);
+    gambit_hash(hasher, state.Player);
+    gambit_hash(hasher, state.Card_rank);
+    gambit_hash(hasher, state.Card_suit);
+    gambit_hash(hasher, state.Card_tokens);
+    gambit_hash(hasher, state.Player_cards);
+    gambit_hash(hasher, state.Player_tokens);
+    gambit_hash(hasher, state.deck);
+    gambit_hash(hasher, state.current_player);
+    gambit_hash(hasher, state.other_player);
+    gambit_hash(hasher, state.chosen_card);
+    gambit_hash(hasher, state.attacker_one);
+    gambit_hash(hasher, state.attacker_two);
+    gambit_hash(hasher, state.phase);
+    gambit_hash(hasher, state.turn);
+    gambit_hash(hasher, state.outcome);
+}
+
+template <uint32_t CardCapacity = 52, bool HiddenHands = false>
+struct CardAttack
+{
+    static_assert(CardCapacity >= SUIT_COUNT * RANK_COUNT, "There must be room for every card in the deck");
+
+    using State = CardAttackState<CardCapacity>;
+
+    static constexpr uint32_t PLAYER_COUNT = 2;
+    static constexpr uint32_t MAX_TURNS = 200;
+    static constexpr GambitUndo undo = GambitUndo::JOURNAL;
+
+    // Enough for every attack. Players with more tokens than this can only add up to this many
+    // to a card at once.
+    static constexpr uint32_t MAX_MOVES = 256;
+
+    using Hidden = GambitHidden<GambitEntity, CardCapacity>;
+
+    // FUNCTIONS //
+
+    static int value(const State &state, GambitEntity card)
+    {
+        int rank = state.Card_rank[card];
+        if (rank == ACE)
+            return 11;
+        if (rank >= JACK)
+            return 10;
+        return rank + 1;
+    }
+
+    static int power(const State &state, GambitEntity card)
+    {
+        return value(state, card) + state.Card_tokens[card];
+    }
+
+    static bool can_attack(const State &state, GambitEntity attacker_one, GambitEntity attacker_two, GambitEntity defender)
+    {
+        return power(state, attacker_one) + power(state, attacker_two) > power(state, defender) &&
+               (state.Card_suit[attacker_one] == state.Card_suit[defender] || state.Card_suit[attacker_two] == state.Card_suit[defender]);
+    }
+
+    // GAME //
+
+    static void setup(State &state, GambitRandom &random)
+    {
+        std::memset(&state, 0, sizeof(State));
+
+        GambitEntity player_one = gambit_create(state.Player);
+        GambitEntity player_two = gambit_create(state.Player);
+        gambit_write(state.Player_tokens[player_one], 10);
+        gambit_write(state.Player_tokens[player_two], 10);
+
+        for (int suit = 0; suit < SUIT_COUNT; suit++)
+        {
+            for (int rank = 0; rank < RANK_COUNT; rank++)
+            {
+                GambitEntity card = gambit_create(state.Card);
+                gambit_write(state.Card_suit[card], suit);
+                gambit_write(state.Card_rank[card], rank);
+                gambit_write(state.Card_tokens[card], 0);
+                gambit_insert(state.deck, card);
+            }
+        }
+
+        gambit_shuffle(state.deck, random);
+
+        for (uint32_t i = 0; i < HAND_SIZE; i++)
+        {
+            gambit_insert(state.Player_cards[player_one], gambit_pop(state.deck));
+            gambit_insert(state.Player_cards[player_two], gambit_pop(state.deck));
+        }
+
+        gambit_write(state.current_player, player_one);
+        gambit_write(state.other_player, player_two);
+        start_turn(state);
+    }
+
+    // Writes the moves that can be made to `moves`, which must have room for MAX_MOVES, and
+    // returns how many there are
+    static uint32_t legal_moves(const State &state, uint32_t *moves)
+    {
+        uint32_t count = 0;
+        const auto &cards = state.Player_cards[state.current_player];
+
+        switch (state.phase)
+        {
+        case CHOOSE_CARD:
+            // The last move is `none`
+            count = gambit_list_moves(cards, moves);
+            moves[count++] = cards.size();
+            break;
+
+        case CHOOSE_TOKENS:
+            // 1..current_player.tokens
+            count = gambit_range_moves(1, state.Player_tokens[state.current_player], moves, MAX_MOVES);
+            break;
+
+        case CHOOSE_ATTACK:
+        {
+            // 0 is not attacking
+            moves[count++] = 0;
+
+            const auto &defenders = state.Player_cards[state.other_player];
+            for (uint32_t i = 0; i < cards.size(); i++)
+            {
+                for (uint32_t j = i + 1; j < cards.size(); j++)
+                {
+                    for (uint32_t k = 0; k < defenders.size(); k++)
+                    {
+                        if (can_attack(state, cards[i], cards[j], defenders[k]))
+                            moves[count++] = encode_attack(i, j, k);
+                    }
+                }
+            }
+            break;
+        }
+
+        case CHOOSE_DISCARD:
+            moves[count++] = 0;
+            moves[count++] = 1;
+            break;
+        }
+
+        return count;
+    }
+
+    static void apply(State &state, uint32_t move)
+    {
+        auto &cards = state.Player_cards[state.current_player];
+
+        switch (state.phase)
+        {
+        case CHOOSE_CARD:
+            if (move >= cards.size())
+            {
+                attack_phase(state);
+                return;
+            }
+
+            gambit_write(state.chosen_card, cards[move]);
+            gambit_write(state.phase, CHOOSE_TOKENS);
+            return;
+
+        case CHOOSE_TOKENS:
+        {
+            int tokens = 1 + (int)move;
+            gambit_write(state.Player_tokens[state.current_player], state.Player_tokens[state.current_player] - tokens);
+            gambit_write(state.Card_tokens[state.chosen_card], state.Card_tokens[state.chosen_card] + tokens);
+            attack_phase(state);
+            return;
+        }
+
+        case CHOOSE_ATTACK:
+        {
+            if (move == 0)
+            {
+                end_turn(state);
+                return;
+            }
+
+            uint32_t attack = move - 1;
+            GambitEntity attacker_one = cards[attack / (HAND_SIZE * HAND_SIZE)];
+            GambitEntity attacker_two = cards[attack / HAND_SIZE % HAND_SIZE];
+            GambitEntity defender = state.Player_cards[state.other_player][attack % HAND_SIZE];
+
+            gambit_remove(state.Player_cards[state.other_player], defender);
+            gambit_write(state.Player_tokens[state.current_player], state.Player_tokens[state.current_player] + power(state, defender));
+
+            int power_one = power(state, attacker_one);
+            int power_two = power(state, attacker_two);
+            if (power_one == power_two)
+            {
+                gambit_write(state.attacker_one, attacker_one);
+                gambit_write(state.attacker_two, attacker_two);
+                gambit_write(state.phase, CHOOSE_DISCARD);
+                return;
+            }
+
+            discard(state, power_one < power_two ? attacker_one : attacker_two);
+            end_turn(state);
+            return;
+        }
+
+        case CHOOSE_DISCARD:
+            discard(state, move == 0 ? state.attacker_one : state.attacker_two);
+            end_turn(state);
+            return;
+        }
+    }
+
+    static bool is_terminal(const State &state) { return state.outcome.ended; }
+
+    static uint32_t current_player(const State &state) { return entity_index(state.current_player); }
+
+    // 1 for a win, 0.5 for a draw (or a game that has not ended) and 0 for a loss
+    static double outcome(const State &state, uint32_t player)
+    {
+        if (!state.outcome.ended || state.outcome.winner < 0)
+            return 0.5;
+        return (uint32_t)state.outcome.winner == player ? 1.0 : 0.0;
+    }
+
+    static void hide(State &state, uint32_t observer, Hidden &hidden)
+    {
+        hidden.hide_all(state.deck);
+        if (!HiddenHands)
+            return;
+
+        GambitEntity opponent = current_player(state) == observer ? state.other_player : state.current_player;
+        hidden.hide_if(state.Player_cards[opponent], [&](GambitEntity card)
+                       { return state.Card_tokens[card] == 0; });
+    }
+
+private:
+    static uint32_t encode_attack(uint32_t attacker_one, uint32_t attacker_two, uint32_t defender)
+    {
+        return 1 + (attacker_one * HAND_SIZE + attacker_two) * HAND_SIZE + defender;
+    }
+
+    static void start_turn(State &state)
+    {
+        if (state.Player_tokens[state.current_player] > 0)
+            gambit_write(state.phase, CHOOSE_CARD);
+        else
+            attack_phase(state);
+    }
+
+    // Players are only asked whether to attack if they have an attack they could make
+    static void attack_phase(State &state)
+    {
+        const auto &cards = state.Player_cards[state.current_player];
+        const auto &defenders = state.Player_cards[state.other_player];
+        for (uint32_t i = 0; i < cards.size(); i++)
+        {
+            for (uint32_t j = i + 1; j < cards.size(); j++)
+            {
+                for (uint32_t k = 0; k < defenders.size(); k++)
+                {
+                    if (can_attack(state, cards[i], cards[j], defenders[k]))
+                    {
+                        gambit_write(state.phase, CHOOSE_ATTACK);
+                        return;
+                    }
+                }
+            }
+        }
+
+        end_turn(state);
+    }
+
+    static void discard(State &state, GambitEntity attacker)
+    {
+        gambit_remove(state.Player_cards[state.current_player], attacker);
+        gambit_write(state.Player_tokens[state.current_player], state.Player_tokens[state.current_player] + state.Card_tokens[attacker]);
+    }
+
+    static void end_turn(State &state)
+    {
+        int current_tokens = state.Player_tokens[state.current_player];
+        int other_tokens = state.Player_tokens[state.other_player];
+
+        if (state.Player_cards[state.current_player].size() < 2 && state.Player_cards[state.other_player].size() < 2)
+        {
+            if (current_tokens > other_tokens)
+                gambit_wins(state, state.current_player);
+            else if (current_tokens < other_tokens)
+                gambit_wins(state, state.other_player);
+            else
+                gambit_draw(state);
+            return;
+        }
+
+        if (state.turn + 1 >= (int)MAX_TURNS)
+        {
+            gambit_draw(state);
+            return;
+        }
+
+        GambitEntity current_player = state.current_player;
+        gambit_write(state.turn, state.turn + 1);
+        gambit_write(state.current_player, state.other_player);
+        gambit_write(state.other_player, current_player);
+        start_turn(state);
+    }
+};
+
+#endif
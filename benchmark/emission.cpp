@@ -0,0 +1,172 @@
+#include "emission.h"
+#include "statistics.h"
+#include "../compiler/generator.h"
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+// SYNTHETIC IR
+
+static C_Index add_expression(C_Program &ir, C_Expression expr)
+{
+    ir.expressions.push_back(expr);
+    return (C_Index)(ir.expressions.size() - 1);
+}
+
+static C_Index add_statement(C_Program &ir, C_Statement::Kind kind, C_Index operand = 0)
+{
+    C_Statement stmt = {};
+    stmt.kind = kind;
+    stmt.expression = operand;
+    ir.statements.push_back(stmt);
+    return (C_Index)(ir.statements.size() - 1);
+}
+
+static C_Index add_int(C_Program &ir, int value)
+{
+    C_Expression expr = {};
+    expr.kind = C_Expression::INT_LITERAL;
+    expr.int_value = value;
+    return add_expression(ir, expr);
+}
+
+static C_Index add_binary(C_Program &ir, C_Expression::Kind kind, C_Index lhs, C_Index rhs)
+{
+    C_Expression expr = {};
+    expr.kind = kind;
+    expr.lhs = lhs;
+    expr.rhs = rhs;
+    return add_expression(ir, expr);
+}
+
+// Each function body is a flat code block that cycles through the statements the Converter
+// produces: if statements with a nested block, expression statements, and return statements.
+C_Program generate_synthetic_ir(size_t functions, size_t statements_per_function)
+{
+    C_Program ir;
+
+    for (size_t f = 0; f < functions; f++)
+    {
+        C_Function funct;
+        funct.identity = intern_string(ir, "function_" + to_string(f));
+        funct.body = add_statement(ir, C_Statement::CODE_BLOCK);
+
+        size_t s = 0;
+        while (s < statements_per_function)
+        {
+            int n = (int)s;
+            switch (s % 3)
+            {
+            case 0:
+            {
+                auto condition = add_binary(ir, C_Expression::BINARY_EQUAL, add_int(ir, n), add_int(ir, n + 1));
+                add_statement(ir, C_Statement::IF_STATEMENT, condition);
+                auto block = add_statement(ir, C_Statement::CODE_BLOCK);
+                ir.statements[block].statement_count = 1;
+                auto sum = add_binary(ir, C_Expression::BINARY_ADD, add_int(ir, n), add_int(ir, 2));
+                add_statement(ir, C_Statement::EXPRESSION_STATEMENT, sum);
+                s += 3;
+                break;
+            }
+            case 1:
+            {
+                auto product = add_binary(ir, C_Expression::BINARY_MUL, add_int(ir, n), add_int(ir, 3));
+                auto sum = add_binary(ir, C_Expression::BINARY_ADD, product, add_int(ir, n + 4));
+                add_statement(ir, C_Statement::EXPRESSION_STATEMENT, sum);
+                s += 1;
+                break;
+            }
+            case 2:
+            {
+                add_statement(ir, C_Statement::RETURN_STATEMENT, add_int(ir, n));
+                s += 1;
+                break;
+            }
+            }
+        }
+
+        ir.statements[funct.body].statement_count = (C_Index)(ir.statements.size() - (funct.body + 1));
+        ir.functions.push_back(funct);
+    }
+
+    return ir;
+}
+
+// BENCHMARK
+
+bool benchmark_emission(RepetitionOptions options, size_t max_threads)
+{
+    printf("%-12s %10s %14s %14s %14s %14s\n", "statements", "bytes", "string", "string MB/s", "file", "file MB/s");
+
+    for (size_t statements : {1000, 10000, 100000})
+    {
+        auto ir = generate_synthetic_ir(statements / 1000, 1000);
+
+        size_t bytes = 0;
+        auto to_string_summary = measure(options, [&]()
+                                         {
+                                             Generator generator;
+                                             bytes = generator.generate(ir).size();
+                                         });
+
+        auto file_path = "local/benchmark/emission.c";
+        bool file_ok = true;
+        auto to_file_summary = measure(options, [&]()
+                                       {
+                                           std::ofstream output(file_path);
+                                           file_ok = file_ok && output.is_open();
+                                           Generator generator;
+                                           generator.generate(ir, output);
+                                       });
+
+        if (!file_ok)
+        {
+            printf("Error attempting to write generated source to %s\n", file_path);
+            return false;
+        }
+
+        auto megabytes_per_second = [&](const Summary &summary)
+        {
+            char buf[32];
+            snprintf(buf, sizeof buf, "%.1f", bytes / summary.median / 1e6);
+            return string(buf);
+        };
+
+        printf("%-12zu %10zu %14s %14s %14s %14s\n",
+               ir.statements.size(),
+               bytes,
+               format_seconds(to_string_summary.median).c_str(),
+               megabytes_per_second(to_string_summary).c_str(),
+               format_seconds(to_file_summary.median).c_str(),
+               megabytes_per_second(to_file_summary).c_str());
+    }
+
+    // Parallel generation, with many functions so that there is enough work to divide up
+    auto ir = generate_synthetic_ir(1000, 200);
+    string expected = Generator().generate(ir);
+    double serial_median = 0;
+
+    printf("\n%-12s %14s %10s   (%zu statements in %zu functions)\n", "threads", "string", "speedup", ir.statements.size(), ir.functions.size());
+    for (size_t threads = 1; threads <= max_threads; threads *= 2)
+    {
+        Generator generator(threads);
+        bool matches = true;
+        auto summary = measure(options, [&]()
+                               { matches = generator.generate(ir) == expected && matches; });
+
+        if (!matches)
+        {
+            printf("Generating with %zu threads gave different output to generating with one\n", threads);
+            return false;
+        }
+
+        if (threads == 1)
+            serial_median = summary.median;
+
+        char speedup[32];
+        snprintf(speedup, sizeof speedup, "%.2fx", serial_median / summary.median);
+        printf("%-12zu %14s %10s\n", threads, format_seconds(summary.median).c_str(), speedup);
+    }
+
+    return true;
+}
@@ -0,0 +1,23 @@
+/*
+emission.h
+
+Measures how quickly the Generator emits C source code from a large IR. The IR is built
+directly, rather than by compiling a Gambit program, so that programs with tens of thousands
+of statements can be benchmarked without waiting on the earlier phases of the compiler.
+*/
+
+#pragma once
+#ifndef EMISSION_H
+#define EMISSION_H
+
+#include "phases.h"
+#include "../compiler/ir.h"
+#include <string>
+using namespace std;
+
+C_Program generate_synthetic_ir(size_t functions, size_t statements_per_function);
+
+// Also compares generating with 1 to max_threads threads, which should scale with the number of cores
+bool benchmark_emission(RepetitionOptions options, size_t max_threads);
+
+#endif
@@ -0,0 +1,79 @@
+#include "layout.h"
+#include "baseline.h"
+#include "../compiler/checker.h"
+#include "../compiler/converter.h"
+#include "../compiler/errors.h"
+#include "../compiler/ir.h"
+#include "../compiler/lexer.h"
+#include "../compiler/parser.h"
+#include "../compiler/resolver.h"
+#include "../compiler/source.h"
+#include <cstdio>
+
+static bool convert_to_ir(string file_path, C_Program &ir)
+{
+    try
+    {
+        Source source(file_path);
+
+        Lexer lexer;
+        lexer.tokenise(source);
+
+        Parser parser;
+        auto program = parser.parse(source);
+
+        Resolver resolver;
+        resolver.resolve(source, program);
+
+        Checker checker;
+        checker.check(source, program);
+
+        if (source.errors.size() > 0)
+            return false;
+
+        Converter converter;
+        ir = converter.convert(program);
+        return true;
+    }
+    catch (const CompilerError &)
+    {
+        return false;
+    }
+}
+
+void report_ir_layout()
+{
+    printf("Bytes per node\n");
+    printf("%-14s %6zu\n", "C_Function", sizeof(C_Function));
+    printf("%-14s %6zu\n", "C_Statement", sizeof(C_Statement));
+    printf("%-14s %6zu\n", "C_Expression", sizeof(C_Expression));
+
+    printf("\n%-32s %10s %10s %11s %8s %12s %12s\n", "program", "functions", "statements", "expressions", "strings", "node bytes", "string bytes");
+    for (const auto &program : collect_corpus())
+    {
+        C_Program ir;
+        if (!convert_to_ir(program.file_path, ir))
+        {
+            printf("%-32s (does not compile)\n", program.name.c_str());
+            continue;
+        }
+
+        size_t node_bytes = ir.functions.size() * sizeof(C_Function) +
+                            ir.statements.size() * sizeof(C_Statement) +
+                            ir.expressions.size() * sizeof(C_Expression);
+
+        // Each pooled string is counted once, however many nodes refer to it
+        size_t string_bytes = 0;
+        for (const auto &str : ir.strings)
+            string_bytes += sizeof(string) + str.size();
+
+        printf("%-32s %10zu %10zu %11zu %8zu %12zu %12zu\n",
+               program.name.c_str(),
+               ir.functions.size(),
+               ir.statements.size(),
+               ir.expressions.size(),
+               ir.strings.size(),
+               node_bytes,
+               string_bytes);
+    }
+}
@@ -0,0 +1,17 @@
+/*
+layout.h
+
+Reports the memory layout of the Intermediate Representation: the size of each kind of IR
+node, and how many bytes the IR of each program in the benchmark corpus takes up.
+*/
+
+#pragma once
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+#include <string>
+using namespace std;
+
+void report_ir_layout();
+
+#endif
@@ -0,0 +1,318 @@
+#include "baseline.h"
+#include "batch.h"
+#include "emission.h"
+#include "layout.h"
+#include "phases.h"
+#include "search.h"
+#include "selfplay.h"
+#include "statistics.h"
+#include "storage.h"
+#include "synthetic.h"
+#include "undo.h"
+#include "../compiler/thread-pool.h"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+using namespace std;
+
+// Options
+
+enum class Mode
+{
+    Scaling,
+    Record,
+    Compare,
+    Layout,
+    Emission,
+    Storage,
+    Undo,
+    Search,
+    Batch,
+    Selfplay,
+};
+
+struct Options
+{
+    Mode mode = Mode::Scaling;
+    string baseline_path;
+    BaselineOptions baseline;
+    SearchBenchmarkOptions search;
+    BatchBenchmarkOptions batch;
+    GambitSelfplayOptions selfplay;
+    size_t max_n = 64;
+    size_t max_threads = max<size_t>(ThreadPool::default_thread_count(), 4);
+    vector<SyntheticDimension> dimensions = synthetic_dimensions;
+};
+
+void print_usage()
+{
+    cout << "USAGE: benchmark [scaling] [-repetitions N] [-max N] [-dimension NAME]" << endl;
+    cout << "       benchmark record <baseline.json> [-repetitions N]" << endl;
+    cout << "       benchmark compare <baseline.json> [-repetitions N] [-threshold F]" << endl;
+    cout << "       benchmark layout" << endl;
+    cout << "       benchmark emission [-repetitions N] [-threads N]" << endl;
+    cout << "       benchmark storage [-repetitions N]" << endl;
+    cout << "       benchmark undo [-repetitions N]" << endl;
+    cout << "       benchmark search [-seconds F] [-threads N]" << endl;
+    cout << "       benchmark batch [-games N]" << endl;
+    cout << "       benchmark selfplay [-games N] [-threads N] [-players LIST] [-output FILE]" << endl;
+    cout << "Dimensions:";
+    for (auto dimension : synthetic_dimensions)
+        cout << " " << to_string(dimension);
+    cout << endl;
+}
+
+bool parse_options(int argc, char *argv[], Options &options)
+{
+    bool dimension_specified = false;
+    int i = 1;
+
+    if (i < argc)
+    {
+        string mode = argv[i];
+        if (mode == "scaling")
+            i++;
+        else if (mode == "layout")
+        {
+            options.mode = Mode::Layout;
+            i++;
+        }
+        else if (mode == "emission")
+        {
+            options.mode = Mode::Emission;
+            i++;
+        }
+        else if (mode == "storage")
+        {
+            options.mode = Mode::Storage;
+            i++;
+        }
+        else if (mode == "undo")
+        {
+            options.mode = Mode::Undo;
+            i++;
+        }
+        else if (mode == "search")
+        {
+            options.mode = Mode::Search;
+            i++;
+        }
+        else if (mode == "batch")
+        {
+            options.mode = Mode::Batch;
+            i++;
+        }
+        else if (mode == "selfplay")
+        {
+            options.mode = Mode::Selfplay;
+            i++;
+        }
+        else if (mode == "record" || mode == "compare")
+        {
+            if (i + 1 >= argc)
+                return false;
+            options.mode = mode == "record" ? Mode::Record : Mode::Compare;
+            options.baseline_path = argv[i + 1];
+            i += 2;
+        }
+    }
+
+    for (; i < argc; i++)
+    {
+        string flag = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if ((flag == "-r" || flag == "-repetitions") && has_value)
+            options.baseline.repetitions.min_repetitions = stoul(argv[++i]);
+
+        else if ((flag == "-t" || flag == "-threshold") && has_value)
+            options.baseline.threshold = stod(argv[++i]);
+
+        else if ((flag == "-m" || flag == "-max") && has_value && options.mode == Mode::Scaling)
+            options.max_n = stoul(argv[++i]);
+
+        else if (flag == "-threads" && has_value && options.mode == Mode::Emission)
+            options.max_threads = max<size_t>(stoul(argv[++i]), 1);
+
+        else if (flag == "-threads" && has_value && options.mode == Mode::Search)
+            options.search.max_threads = max<uint32_t>((uint32_t)stoul(argv[++i]), 1);
+
+        else if (flag == "-seconds" && has_value && options.mode == Mode::Search)
+            options.search.seconds = stod(argv[++i]);
+
+        else if (flag == "-games" && has_value && options.mode == Mode::Batch)
+            options.batch.games = max<uint64_t>(stoull(argv[++i]), 1);
+
+        else if (flag == "-games" && has_value && options.mode == Mode::Selfplay)
+            options.selfplay.games = max<uint64_t>(stoull(argv[++i]), 1);
+
+        else if (flag == "-threads" && has_value && options.mode == Mode::Selfplay)
+            options.selfplay.threads = max<uint32_t>((uint32_t)stoul(argv[++i]), 1);
+
+        else if (flag == "-players" && has_value && options.mode == Mode::Selfplay)
+        {
+            if (!gambit_parse_players(argv[++i], options.selfplay.players))
+                return false;
+        }
+
+        else if (flag == "-output" && has_value && options.mode == Mode::Selfplay)
+            options.selfplay.output = argv[++i];
+
+        else if ((flag == "-d" || flag == "-dimension") && has_value && options.mode == Mode::Scaling)
+        {
+            string name = argv[++i];
+            if (!dimension_specified)
+                options.dimensions.clear();
+            dimension_specified = true;
+
+            bool found = false;
+            for (auto dimension : synthetic_dimensions)
+            {
+                if (to_string(dimension) == name)
+                {
+                    options.dimensions.push_back(dimension);
+                    found = true;
+                }
+            }
+
+            if (!found)
+            {
+                cout << "Unknown dimension '" << name << "'" << endl;
+                return false;
+            }
+        }
+
+        else
+            return false;
+    }
+
+    return true;
+}
+
+// Synthetic programs
+
+string synthetic_program_path(string name)
+{
+    return "local/benchmark/" + name + ".gambit";
+}
+
+// Scaling benchmark
+
+void print_row(string label, const array<string, PHASE_COUNT> &cells, string total)
+{
+    printf("%-8s", label.c_str());
+    for (auto cell : cells)
+        printf(" %20s", cell.c_str());
+    printf(" %20s\n", total.c_str());
+}
+
+string format_summary(Summary summary)
+{
+    return format_seconds(summary.median) + " +-" + format_seconds(summary.mad);
+}
+
+bool benchmark_dimension(SyntheticDimension dimension, const Options &options)
+{
+    cout << "\n"
+         << to_string(dimension) << endl;
+    print_row("N", phase_names, "total");
+
+    vector<double> ns;
+    array<vector<double>, PHASE_COUNT> medians;
+    vector<double> total_medians;
+
+    for (size_t n = 1; n <= options.max_n; n *= 2)
+    {
+        auto parameters = with_dimension(SyntheticParameters(), dimension, n);
+        auto file_path = synthetic_program_path(to_string(dimension) + "-" + to_string(n));
+        if (!save_synthetic_program(file_path, parameters))
+            return false;
+
+        auto measurement = measure_phases(file_path, options.baseline.repetitions);
+        auto last_run = measurement.last_run;
+        if (last_run.compiler_error != "" || last_run.gambit_errors > 0 || last_run.phases_completed < PHASE_COUNT)
+        {
+            cout << "Synthetic program " << file_path << " did not compile cleanly ("
+                 << last_run.gambit_errors << " errors). " << last_run.compiler_error << endl;
+            return false;
+        }
+
+        array<string, PHASE_COUNT> cells;
+        for (size_t phase = 0; phase < PHASE_COUNT; phase++)
+        {
+            cells[phase] = format_summary(measurement.phases[phase]);
+            medians[phase].push_back(measurement.phases[phase].median);
+        }
+        print_row(to_string(n), cells, format_summary(measurement.total));
+
+        ns.push_back((double)n);
+        total_medians.push_back(measurement.total.median);
+    }
+
+    array<string, PHASE_COUNT> exponents;
+    for (size_t phase = 0; phase < PHASE_COUNT; phase++)
+    {
+        char buf[32];
+        snprintf(buf, sizeof buf, "N^%.2f", scaling_exponent(ns, medians[phase]));
+        exponents[phase] = buf;
+    }
+    char total_exponent[32];
+    snprintf(total_exponent, sizeof total_exponent, "N^%.2f", scaling_exponent(ns, total_medians));
+    print_row("scaling", exponents, total_exponent);
+
+    return true;
+}
+
+// Main
+
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (!parse_options(argc, argv, options))
+    {
+        print_usage();
+        return 1;
+    }
+
+    if (options.mode == Mode::Record)
+        return record_baseline(options.baseline_path, options.baseline) ? 0 : 1;
+
+    if (options.mode == Mode::Compare)
+        return compare_to_baseline(options.baseline_path, options.baseline) == 0 ? 0 : 1;
+
+    if (options.mode == Mode::Layout)
+    {
+        report_ir_layout();
+        return 0;
+    }
+
+    if (options.mode == Mode::Emission)
+        return benchmark_emission(options.baseline.repetitions, options.max_threads) ? 0 : 1;
+
+    if (options.mode == Mode::Storage)
+        return benchmark_storage(options.baseline.repetitions) ? 0 : 1;
+
+    if (options.mode == Mode::Undo)
+        return benchmark_undo(options.baseline.repetitions) ? 0 : 1;
+
+    if (options.mode == Mode::Search)
+        return benchmark_search(options.search) ? 0 : 1;
+
+    if (options.mode == Mode::Batch)
+        return benchmark_batch(options.batch) ? 0 : 1;
+
+    if (options.mode == Mode::Selfplay)
+        return benchmark_selfplay(options.selfplay) ? 0 : 1;
+
+    cout << "Median time per phase (+- median absolute deviation), with at least "
+         << options.baseline.repetitions.min_repetitions << " repetitions per program." << endl;
+    cout << "Each dimension is varied from 1 to " << options.max_n << " while all others are held at their defaults." << endl;
+
+    bool success = true;
+    for (auto dimension : options.dimensions)
+        success = benchmark_dimension(dimension, options) && success;
+
+    return success ? 0 : 1;
+}
@@ -0,0 +1,131 @@
+#include "phases.h"
+#include "allocations.h"
+#include "../compiler/checker.h"
+#include "../compiler/converter.h"
+#include "../compiler/errors.h"
+#include "../compiler/evaluator.h"
+#include "../compiler/generator.h"
+#include "../compiler/lexer.h"
+#include "../compiler/optimiser.h"
+#include "../compiler/parser.h"
+#include "../compiler/resolver.h"
+#include "../compiler/source.h"
+#include <chrono>
+#include <vector>
+
+const array<string, PHASE_COUNT> phase_names = {
+    "lexer",
+    "parser",
+    "resolver",
+    "checker",
+    "evaluator",
+    "converter",
+    "optimiser",
+    "generator",
+};
+
+PhaseTimings time_phases(string file_path)
+{
+    PhaseTimings timings;
+
+    auto phase_start = chrono::steady_clock::now();
+    auto phase_allocations = allocations_so_far();
+    auto start_phase = [&]()
+    {
+        phase_allocations = allocations_so_far();
+        phase_start = chrono::steady_clock::now();
+    };
+    auto finish_phase = [&](Phase phase)
+    {
+        auto phase_end = chrono::steady_clock::now();
+        auto allocations = allocations_so_far();
+        timings.seconds[phase] = chrono::duration<double>(phase_end - phase_start).count();
+        timings.allocations[phase] = allocations.count - phase_allocations.count;
+        timings.allocated_bytes[phase] = allocations.bytes - phase_allocations.bytes;
+        timings.phases_completed = phase + 1;
+        start_phase();
+    };
+
+    try
+    {
+        Source source(file_path);
+        start_phase();
+
+        Lexer lexer;
+        lexer.tokenise(source);
+        finish_phase(LEXER);
+
+        Parser parser;
+        auto program = parser.parse(source);
+        finish_phase(PARSER);
+
+        Resolver resolver;
+        resolver.resolve(source, program);
+        finish_phase(RESOLVER);
+
+        Checker checker;
+        checker.check(source, program);
+        finish_phase(CHECKER);
+
+        // As in the compiler itself, the program is only converted if there are no errors
+        timings.gambit_errors = source.errors.size();
+        if (source.errors.size() > 0)
+            return timings;
+
+        Evaluator evaluator;
+        evaluator.evaluate(program);
+        finish_phase(EVALUATOR);
+
+        Converter converter;
+        auto representation = converter.convert(program);
+        finish_phase(CONVERTER);
+
+        Optimiser optimiser;
+        optimiser.optimise(representation);
+        finish_phase(OPTIMISER);
+
+        Generator generator;
+        auto generated = generator.generate(representation);
+        finish_phase(GENERATOR);
+    }
+    catch (CompilerError &error)
+    {
+        timings.compiler_error = error.what();
+    }
+
+    return timings;
+}
+
+PhaseMeasurement measure_phases(string file_path, RepetitionOptions options)
+{
+    PhaseMeasurement measurement;
+
+    for (size_t i = 0; i < options.warmup; i++)
+        measurement.last_run = time_phases(file_path);
+
+    array<vector<double>, PHASE_COUNT> samples;
+    vector<double> total_samples;
+    double total_seconds = 0;
+
+    while (total_samples.size() < options.max_repetitions &&
+           (total_samples.size() < options.min_repetitions || total_seconds < options.min_total_seconds))
+    {
+        measurement.last_run = time_phases(file_path);
+
+        double run_seconds = 0;
+        for (size_t phase = 0; phase < PHASE_COUNT; phase++)
+        {
+            samples[phase].push_back(measurement.last_run.seconds[phase]);
+            run_seconds += measurement.last_run.seconds[phase];
+        }
+
+        total_samples.push_back(run_seconds);
+        total_seconds += run_seconds;
+    }
+
+    for (size_t phase = 0; phase < PHASE_COUNT; phase++)
+        measurement.phases[phase] = summarise(samples[phase]);
+    measurement.total = summarise(total_samples);
+
+    return measurement;
+}
@@ -0,0 +1,93 @@
+/*
+phases.h
+
+Runs a Gambit source file through each phase of the compiler, timing each phase individually.
+*/
+
+#pragma once
+#ifndef PHASES_H
+#define PHASES_H
+
+#include "statistics.h"
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+using namespace std;
+
+enum Phase
+{
+    LEXER,
+    PARSER,
+    RESOLVER,
+    CHECKER,
+    EVALUATOR,
+    CONVERTER,
+    OPTIMISER,
+    GENERATOR,
+
+    PHASE_COUNT
+};
+
+extern const array<string, PHASE_COUNT> phase_names;
+
+struct PhaseTimings
+{
+    array<double, PHASE_COUNT> seconds = {};
+    array<size_t, PHASE_COUNT> allocations = {};
+    array<size_t, PHASE_COUNT> allocated_bytes = {};
+
+    // Phases that did not run (because of an error in the program, or a compiler error)
+    // are recorded as not completed, and have a time and allocation count of 0.
+    size_t phases_completed = 0;
+    size_t gambit_errors = 0;
+    string compiler_error;
+};
+
+PhaseTimings time_phases(string file_path);
+
+// Each program is compiled a few times before measuring to warm up caches. It is then compiled
+// repeatedly until both the minimum number of repetitions and the minimum total time have been
+// reached, so that fast phases are measured over enough runs to smooth out timer noise.
+struct RepetitionOptions
+{
+    size_t warmup = 2;
+    size_t min_repetitions = 10;
+    size_t max_repetitions = 1000;
+    double min_total_seconds = 0.5;
+};
+
+struct PhaseMeasurement
+{
+    array<Summary, PHASE_COUNT> phases;
+    Summary total;
+    PhaseTimings last_run; // Used to report how far compilation got, and any errors
+};
+
+PhaseMeasurement measure_phases(string file_path, RepetitionOptions options = {});
+
+// Times `run` repeatedly, with the same warm up and number of repetitions as measure_phases
+template <typename F>
+Summary measure(const RepetitionOptions &options, F run)
+{
+    for (size_t i = 0; i < options.warmup; i++)
+        run();
+
+    vector<double> samples;
+    double total_seconds = 0;
+    while (samples.size() < options.max_repetitions &&
+           (samples.size() < options.min_repetitions || total_seconds < options.min_total_seconds))
+    {
+        auto start = chrono::steady_clock::now();
+        run();
+        auto end = chrono::steady_clock::now();
+
+        double seconds = chrono::duration<double>(end - start).count();
+        samples.push_back(seconds);
+        total_seconds += seconds;
+    }
+
+    return summarise(samples);
+}
+
+#endif
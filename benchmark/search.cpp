@@ -0,0 +1,157 @@
+#include "search.h"
+#include "card-attack.h"
+#include "tic-tac-toe.h"
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+using namespace std;
+
+constexpr uint32_t TRANSPOSITIONS = 1 << 18;
+constexpr uint64_t REUSE_ITERATIONS = 2000;
+
+template <typename Game>
+static GambitSearchStats run_search(const typename Game::State &root, SearchBenchmarkOptions options, uint32_t threads, GambitParallelism parallelism, uint32_t transpositions = 0)
+{
+    GambitSearchOptions search_options;
+    search_options.budget.iterations = 0;
+    search_options.budget.seconds = options.seconds;
+    search_options.threads = threads;
+    search_options.parallelism = parallelism;
+    search_options.transpositions = transpositions;
+
+    auto search = make_unique<GambitMCTS<Game>>(search_options);
+    search->search(root);
+    return search->last_stats();
+}
+
+template <typename Game>
+static void benchmark_game(const char *name, const typename Game::State &root, SearchBenchmarkOptions options)
+{
+    printf("\n%s (%zu byte state)\n", name, sizeof(typename Game::State));
+    printf("%-8s %18s %10s %18s %10s\n", "threads", "tree playouts/sec", "speedup", "root playouts/sec", "speedup");
+
+    double single_thread = 0;
+    for (uint32_t threads = 1; threads <= options.max_threads; threads *= 2)
+    {
+        auto tree = run_search<Game>(root, options, threads, GambitParallelism::TREE);
+        if (threads == 1)
+        {
+            single_thread = tree.playouts_per_second();
+            printf("%-8u %18.0f %9.2fx %18s %10s\n", threads, single_thread, 1.0, "-", "-");
+            continue;
+        }
+
+        auto root_parallel = run_search<Game>(root, options, threads, GambitParallelism::ROOT);
+        printf("%-8u %18.0f %9.2fx %18.0f %9.2fx\n",
+               threads,
+               tree.playouts_per_second(),
+               tree.playouts_per_second() / single_thread,
+               root_parallel.playouts_per_second(),
+               root_parallel.playouts_per_second() / single_thread);
+    }
+
+    // A single thread, so that the hit rate does not depend on how the threads interleave
+    auto without = run_search<Game>(root, options, 1, GambitParallelism::TREE);
+    auto with = run_search<Game>(root, options, 1, GambitParallelism::TREE, TRANSPOSITIONS);
+    printf("\n%-16s %14s %10s %10s %12s\n", "transpositions", "playouts/sec", "nodes", "hit rate", "KB saved");
+    printf("%-16s %14.0f %10u %10s %12s\n", "off", without.playouts_per_second(), without.nodes, "-", "-");
+    printf("%-16s %14.0f %10u %9.1f%% %12.1f\n",
+           "on",
+           with.playouts_per_second(),
+           with.nodes,
+           with.transposition_hit_rate() * 100,
+           with.bytes_saved() / 1024.0);
+}
+
+// Plays a game between two searches with the same budget, both with and without keeping the tree
+// between turns, and compares how many playouts each move was chosen from
+template <typename Game>
+static void benchmark_reuse(const typename Game::State &root)
+{
+    printf("\n%-16s %8s %14s %14s %10s\n", "tree reuse", "moves", "playouts/move", "nodes reused", "seconds");
+    for (bool reuse : {false, true})
+    {
+        GambitSearchOptions search_options;
+        search_options.budget.iterations = REUSE_ITERATIONS;
+        auto player_one = make_unique<GambitMCTS<Game>>(search_options);
+        search_options.seed = 1;
+        auto player_two = make_unique<GambitMCTS<Game>>(search_options);
+
+        auto state = make_unique<typename Game::State>();
+        gambit_clone(*state, root);
+
+        uint32_t moves = 0;
+        uint64_t playouts = 0;
+        uint64_t reused = 0;
+        auto start = chrono::steady_clock::now();
+        while (!Game::is_terminal(*state))
+        {
+            auto &player = Game::current_player(*state) == 0 ? player_one : player_two;
+            uint32_t move = player->search(*state);
+            playouts += player->last_stats().root_visits;
+            reused += player->last_stats().nodes_reused;
+            moves++;
+
+            Game::apply(*state, move);
+            if (reuse)
+            {
+                player_one->advance(move);
+                player_two->advance(move);
+            }
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        printf("%-16s %8u %14.0f %14.0f %10.2f\n", reuse ? "on" : "off", moves, (double)playouts / moves, (double)reused / moves, seconds);
+    }
+}
+
+// Searches the same state on one thread both with the full state in view, and only with what the
+// player making the decision can see
+template <typename Game>
+static void benchmark_hidden(const char *name, const typename Game::State &root, SearchBenchmarkOptions options)
+{
+    GambitSearchOptions search_options;
+    search_options.budget.iterations = 0;
+    search_options.budget.seconds = options.seconds;
+
+    auto full = make_unique<GambitMCTS<Game>>(search_options);
+    full->search(root);
+    auto hidden = make_unique<GambitISMCTS<Game>>(search_options);
+    hidden->search(root);
+
+    printf("\n%s\n", name);
+    printf("%-16s %14s %10s\n", "search", "playouts/sec", "nodes");
+    printf("%-16s %14.0f %10u\n", "mcts", full->last_stats().playouts_per_second(), full->last_stats().nodes);
+    printf("%-16s %14.0f %10u\n", "ismcts", hidden->last_stats().playouts_per_second(), hidden->last_stats().nodes);
+}
+
+bool benchmark_search(SearchBenchmarkOptions options)
+{
+    printf("Monte-Carlo tree search from the start of each game, for %.1f seconds\n", options.seconds);
+    printf("Tree parallel threads share one tree, using virtual loss. Root parallel threads search\n");
+    printf("trees of their own, pinned across %zu NUMA node(s). This machine has %u hardware threads.\n",
+           gambit_numa_nodes().size(), thread::hardware_concurrency());
+    printf("Each game is then searched on one thread with a transposition table. Nodes that share the\n");
+    printf("children of a transposed node save at least the memory of those children. Finally, two\n");
+    printf("searches of %llu iterations a move play each game, with and without keeping the tree.\n", (unsigned long long)REUSE_ITERATIONS);
+
+    auto tic_tac_toe = make_unique<TicTacToe::State>();
+    TicTacToe::setup(*tic_tac_toe);
+    benchmark_game<TicTacToe>("tic-tac-toe", *tic_tac_toe, options);
+    benchmark_reuse<TicTacToe>(*tic_tac_toe);
+
+    GambitRandom random(1234);
+    auto card_attack = make_unique<CardAttack<>::State>();
+    CardAttack<>::setup(*card_attack, random);
+    benchmark_game<CardAttack<>>("card-attack", *card_attack, options);
+    benchmark_reuse<CardAttack<>>(*card_attack);
+
+    printf("\nWith hands dealt face down, an information set search deals the cards it cannot see at\n");
+    printf("random before each playout, where a search of the full state sees every card.\n");
+    auto hidden_hands = make_unique<CardAttack<52, true>::State>();
+    gambit_clone(*hidden_hands, *card_attack);
+    benchmark_hidden<CardAttack<52, true>>("card-attack with hidden hands", *hidden_hands, options);
+
+    return true;
+}
@@ -0,0 +1,27 @@
+/*
+search.h
+
+Measures how many playouts per second the runtime's Monte-Carlo tree search manages on the hand
+written ports of the sample games, searching from the start of each game. Each game is searched
+with 1, 2, 4, ... threads up to the maximum, to show how the search scales, both with the threads
+sharing one tree and with each thread searching its own, and then with and without a
+transposition table. Each game is then played out by two searches, to show how many more playouts
+each move is chosen from when the tree is kept between turns. Lastly, card-attack is dealt with
+hidden hands, and searched with and without an information set search (see ismcts.h).
+*/
+
+#pragma once
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <cstdint>
+
+struct SearchBenchmarkOptions
+{
+    double seconds = 1;
+    uint32_t max_threads = 64;
+};
+
+bool benchmark_search(SearchBenchmarkOptions options);
+
+#endif
@@ -0,0 +1,54 @@
+#include "selfplay.h"
+#include "card-attack.h"
+#include "tic-tac-toe.h"
+#include <cstdio>
+#include <filesystem>
+#include <string>
+using namespace std;
+namespace fs = std::filesystem;
+
+template <typename Game, typename Setup>
+static bool benchmark_game(const char *name, GambitSelfplayOptions options, Setup setup)
+{
+    // Each game is streamed to a file of its own, in the same directory
+    if (!options.output.empty())
+    {
+        fs::path path = options.output;
+        options.output = path.replace_filename(string(name) + "-" + path.filename().string()).string();
+    }
+
+    GambitSelfplaySummary summary;
+    if (!gambit_selfplay<Game>(options, setup, summary))
+    {
+        printf("Could not open %s\n", options.output.c_str());
+        return false;
+    }
+
+    printf("\n%s\n", name);
+    gambit_print_summary(summary);
+    return true;
+}
+
+bool benchmark_selfplay(GambitSelfplayOptions options)
+{
+    printf("%llu games of each game, with the players", (unsigned long long)options.games);
+    for (size_t i = 0; i < options.players.size(); i++)
+    {
+        const auto &player = options.players[i];
+        printf(i == 0 ? " " : ",");
+        if (player.kind == GambitPlayer::RANDOM)
+            printf("random");
+        else if (player.budget.iterations > 0)
+            printf("mcts:%llu", (unsigned long long)player.budget.iterations);
+        else
+            printf("mcts:%gs", player.budget.seconds);
+    }
+    printf("\n");
+
+    bool success = benchmark_game<TicTacToe>("tic-tac-toe", options, [](TicTacToe::State &state, GambitRandom &)
+                                             { TicTacToe::setup(state); });
+    success = benchmark_game<CardAttack<>>("card-attack", options, [](CardAttack<>::State &state, GambitRandom &random)
+                                           { CardAttack<>::setup(state, random); }) &&
+              success;
+    return success;
+}
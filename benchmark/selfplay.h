@@ -0,0 +1,17 @@
+/*
+selfplay.h
+
+Plays games between computer players on the hand written ports of the sample games, with the
+runtime's self-play runner (see runtime/selfplay.h), and reports how often each player won, how
+long the games lasted, and how many games were played a second.
+*/
+
+#pragma once
+#ifndef SELFPLAY_H
+#define SELFPLAY_H
+
+#include "../runtime/selfplay.h"
+
+bool benchmark_selfplay(GambitSelfplayOptions options);
+
+#endif
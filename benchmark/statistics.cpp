@@ -0,0 +1,73 @@
+#include "statistics.h"
+#include <algorithm>
+#include <cmath>
+
+static double median_of_sorted(const vector<double> &sorted)
+{
+    size_t n = sorted.size();
+    if (n == 0)
+        return 0;
+    if (n % 2 == 1)
+        return sorted[n / 2];
+    return (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+}
+
+Summary summarise(vector<double> samples)
+{
+    Summary summary;
+    summary.samples = samples.size();
+    if (samples.size() == 0)
+        return summary;
+
+    sort(samples.begin(), samples.end());
+    summary.median = median_of_sorted(samples);
+    summary.min = samples.front();
+    summary.max = samples.back();
+
+    vector<double> deviations;
+    deviations.reserve(samples.size());
+    for (auto sample : samples)
+        deviations.push_back(fabs(sample - summary.median));
+    sort(deviations.begin(), deviations.end());
+    summary.mad = median_of_sorted(deviations);
+
+    return summary;
+}
+
+double scaling_exponent(const vector<double> &x, const vector<double> &y)
+{
+    // Points with a non-positive value cannot be placed on a log-log plot, and are skipped
+    double sum_x = 0, sum_y = 0, sum_xx = 0, sum_xy = 0;
+    size_t n = 0;
+    for (size_t i = 0; i < x.size() && i < y.size(); i++)
+    {
+        if (x[i] <= 0 || y[i] <= 0)
+            continue;
+
+        double lx = log(x[i]);
+        double ly = log(y[i]);
+        sum_x += lx;
+        sum_y += ly;
+        sum_xx += lx * lx;
+        sum_xy += lx * ly;
+        n++;
+    }
+
+    double denominator = n * sum_xx - sum_x * sum_x;
+    if (n < 2 || denominator == 0)
+        return 0;
+
+    return (n * sum_xy - sum_x * sum_y) / denominator;
+}
+
+string format_seconds(double seconds)
+{
+    char buf[32];
+    if (seconds >= 1)
+        snprintf(buf, sizeof buf, "%.2fs", seconds);
+    else if (seconds >= 1e-3)
+        snprintf(buf, sizeof buf, "%.2fms", seconds * 1e3);
+    else
+        snprintf(buf, sizeof buf, "%.1fus", seconds * 1e6);
+    return buf;
+}
@@ -0,0 +1,35 @@
+/*
+statistics.h
+
+Summary statistics for repeated benchmark measurements. Medians and median absolute
+deviations are used rather than means and standard deviations, as timings are skewed by
+the occasional run that is interrupted by the operating system.
+*/
+
+#pragma once
+#ifndef STATISTICS_H
+#define STATISTICS_H
+
+#include <string>
+#include <vector>
+using namespace std;
+
+struct Summary
+{
+    size_t samples = 0;
+    double median = 0;
+    double mad = 0; // Median absolute deviation
+    double min = 0;
+    double max = 0;
+};
+
+Summary summarise(vector<double> samples);
+
+// Fits `y = a * x^k` with least squares over (log x, log y) and returns k. For example,
+// a phase that scales linearly with `x` will have an exponent close to 1, and one that
+// scales quadratically will have an exponent close to 2.
+double scaling_exponent(const vector<double> &x, const vector<double> &y);
+
+string format_seconds(double seconds);
+
+#endif
@@ -0,0 +1,158 @@
+#include "storage.h"
+#include "../runtime/gambit.h"
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+constexpr uint32_t CAPACITY = GAMBIT_ENTITY_CAPACITY;
+constexpr size_t LOOKUPS = 1 << 16;
+
+// Results are summed into a volatile so that the lookups are not optimised away
+static volatile long long sink;
+
+static string format_bytes(size_t bytes)
+{
+    char buf[32];
+    if (bytes >= 1 << 20)
+        snprintf(buf, sizeof buf, "%.1f MB", bytes / (double)(1 << 20));
+    else if (bytes >= 1 << 10)
+        snprintf(buf, sizeof buf, "%.1f KB", bytes / (double)(1 << 10));
+    else
+        snprintf(buf, sizeof buf, "%zu B", bytes);
+    return buf;
+}
+
+static string format_nanoseconds(const Summary &summary, size_t operations)
+{
+    char buf[32];
+    snprintf(buf, sizeof buf, "%.2f ns", summary.median / operations * 1e9);
+    return buf;
+}
+
+bool benchmark_storage(RepetitionOptions options)
+{
+    mt19937 random(1234);
+
+    // COLUMNS //
+    printf("Columns (one entity parameter, capacity %u)\n", CAPACITY);
+    printf("%-10s %12s %14s %14s\n", "entities", "memory", "random read", "scan");
+
+    for (uint32_t entity_count : {16u, 64u, CAPACITY})
+    {
+        auto table = make_unique<GambitEntityTable<>>();
+        auto column = make_unique<GambitColumn<int>>();
+
+        vector<GambitEntity> entities;
+        for (uint32_t i = 0; i < entity_count; i++)
+        {
+            auto entity = table->create();
+            (*column)[entity] = (int)i;
+            entities.push_back(entity);
+        }
+
+        vector<GambitEntity> reads(LOOKUPS);
+        for (auto &read : reads)
+            read = entities[random() % entities.size()];
+
+        auto random_read = measure(options, [&]()
+                                   {
+                                       long long total = 0;
+                                       for (auto entity : reads)
+                                           total += (*column)[entity];
+                                       sink = total; });
+
+        // Scanning every entity, as a `filter` over all cards would
+        size_t scans = LOOKUPS / entity_count;
+        auto scan = measure(options, [&]()
+                            {
+                                long long total = 0;
+                                for (size_t s = 0; s < scans; s++)
+                                {
+                                    for (uint32_t i = 0; i < table->count; i++)
+                                        total += table->alive[i] ? column->values[i] : 0;
+                                }
+                                sink = total; });
+
+        printf("%-10u %12s %14s %14s\n",
+               entity_count,
+               format_bytes(sizeof(GambitColumn<int>)).c_str(),
+               format_nanoseconds(random_read, LOOKUPS).c_str(),
+               format_nanoseconds(scan, scans * entity_count).c_str());
+    }
+
+    // SPARSE MAPS //
+    using Map = GambitSparseMap<int, 2>;
+    printf("\nSparse maps (two entity parameters, %u entries at most)\n", Map::capacity());
+    printf("%-10s %12s %14s %14s %14s %14s\n", "entries", "memory", "hit", "miss", "dense memory", "dense read");
+
+    size_t dense_bytes = sizeof(int) * CAPACITY * CAPACITY;
+    for (uint32_t entry_count : {16u, 256u, Map::capacity()})
+    {
+        auto table = make_unique<GambitEntityTable<>>();
+        auto map = make_unique<Map>();
+        auto dense = make_unique<int[]>(CAPACITY * CAPACITY);
+
+        vector<GambitEntity> entities;
+        for (uint32_t i = 0; i < CAPACITY; i++)
+            entities.push_back(table->create());
+
+        vector<GambitKey<2>> keys;
+        while (keys.size() < entry_count)
+        {
+            auto a = entities[random() % entities.size()];
+            auto b = entities[random() % entities.size()];
+            auto key = gambit_key(a, b);
+            if (map->get(key, -1) != -1)
+                continue;
+
+            map->set(key, (int)keys.size());
+            dense[entity_index(a) * CAPACITY + entity_index(b)] = (int)keys.size();
+            keys.push_back(key);
+        }
+
+        vector<GambitKey<2>> hits(LOOKUPS);
+        vector<GambitKey<2>> misses(LOOKUPS);
+        for (size_t i = 0; i < LOOKUPS; i++)
+        {
+            hits[i] = keys[random() % keys.size()];
+
+            // Entity ids from a later generation are never in the map
+            auto a = make_entity(random() % CAPACITY, 2);
+            auto b = make_entity(random() % CAPACITY, 2);
+            misses[i] = gambit_key(a, b);
+        }
+
+        auto hit = measure(options, [&]()
+                           {
+                               long long total = 0;
+                               for (const auto &key : hits)
+                                   total += map->get(key, 0);
+                               sink = total; });
+
+        auto miss = measure(options, [&]()
+                            {
+                                long long total = 0;
+                                for (const auto &key : misses)
+                                    total += map->get(key, 0);
+                                sink = total; });
+
+        auto dense_read = measure(options, [&]()
+                                  {
+                                      long long total = 0;
+                                      for (const auto &key : hits)
+                                          total += dense[(key.ids[0] & GAMBIT_INDEX_MASK) * CAPACITY + (key.ids[1] & GAMBIT_INDEX_MASK)];
+                                      sink = total; });
+
+        printf("%-10u %12s %14s %14s %14s %14s\n",
+               entry_count,
+               format_bytes(sizeof(Map)).c_str(),
+               format_nanoseconds(hit, LOOKUPS).c_str(),
+               format_nanoseconds(miss, LOOKUPS).c_str(),
+               format_bytes(dense_bytes).c_str(),
+               format_nanoseconds(dense_read, LOOKUPS).c_str());
+    }
+
+    printf("\nA dense array over three entity parameters would take %s.\n", format_bytes(dense_bytes * CAPACITY).c_str());
+    return true;
+}
@@ -0,0 +1,18 @@
+/*
+storage.h
+
+Measures the memory used by each kind of state property storage in the runtime, and how quickly
+values can be looked up in it. Columns, used for properties with a single entity parameter, are
+compared against sparse maps, used for properties with several. Sparse maps are also compared
+against the dense two dimensional array that they replace.
+*/
+
+#pragma once
+#ifndef STORAGE_H
+#define STORAGE_H
+
+#include "phases.h"
+
+bool benchmark_storage(RepetitionOptions options);
+
+#endif
@@ -0,0 +1,210 @@
+#include "synthetic.h"
+#include <fstream>
+#include <iostream>
+
+const vector<SyntheticDimension> synthetic_dimensions = {
+    SyntheticDimension::Entities,
+    SyntheticDimension::StateProperties,
+    SyntheticDimension::FunctionProperties,
+    SyntheticDimension::Overloads,
+    SyntheticDimension::EnumSize,
+    SyntheticDimension::NestingDepth,
+    SyntheticDimension::ExpressionLength,
+};
+
+string to_string(SyntheticDimension dimension)
+{
+    switch (dimension)
+    {
+    case SyntheticDimension::Entities:
+        return "entities";
+    case SyntheticDimension::StateProperties:
+        return "state_properties";
+    case SyntheticDimension::FunctionProperties:
+        return "function_properties";
+    case SyntheticDimension::Overloads:
+        return "overloads";
+    case SyntheticDimension::EnumSize:
+        return "enum_size";
+    case SyntheticDimension::NestingDepth:
+        return "nesting_depth";
+    case SyntheticDimension::ExpressionLength:
+        return "expression_length";
+    }
+
+    return "unknown";
+}
+
+SyntheticParameters with_dimension(SyntheticParameters parameters, SyntheticDimension dimension, size_t n)
+{
+    switch (dimension)
+    {
+    case SyntheticDimension::Entities:
+        parameters.entities = n;
+        break;
+    case SyntheticDimension::StateProperties:
+        parameters.state_properties = n;
+        break;
+    case SyntheticDimension::FunctionProperties:
+        parameters.function_properties = n;
+        break;
+    case SyntheticDimension::Overloads:
+        parameters.overloads = n;
+        break;
+    case SyntheticDimension::EnumSize:
+        parameters.enum_size = n;
+        break;
+    case SyntheticDimension::NestingDepth:
+        parameters.nesting_depth = n;
+        break;
+    case SyntheticDimension::ExpressionLength:
+        parameters.expression_length = n;
+        break;
+    }
+
+    return parameters;
+}
+
+// NOTE: Every dimension is clamped to at least 1, as a program with (for example) no state
+//       properties would leave the generated expressions with nothing to reference.
+
+static string indent(size_t depth)
+{
+    return string(depth * 4, ' ');
+}
+
+// Generates an expression over the entity variable `e`, cycling through each kind of term
+// (state property, literal, function property, overloaded property) so that a longer
+// expression exercises more of the resolver and checker.
+static string generate_expression(const SyntheticParameters &p, size_t entity, size_t seed, size_t max_function)
+{
+    string expr;
+    for (size_t t = 0; t < p.expression_length; t++)
+    {
+        if (t > 0)
+            expr += (t % 2 == 0) ? " + " : " * ";
+
+        size_t term = seed + t;
+        switch (term % 4)
+        {
+        case 0:
+            expr += "e.state_" + to_string(term % p.state_properties);
+            break;
+        case 1:
+            expr += to_string(term);
+            break;
+        case 2:
+            // Function properties may only reference earlier function properties, so that
+            // the first function property (max_function = 0) never references another.
+            if (max_function > 0)
+                expr += "e.function_" + to_string(term % max_function);
+            else
+                expr += "e.state_" + to_string(term % p.state_properties);
+            break;
+        case 3:
+        {
+            size_t arity = term % p.overloads + 1;
+            string instance_list = "(e";
+            for (size_t i = 1; i < arity; i++)
+                instance_list += ", e";
+            instance_list += ")";
+            expr += instance_list + ".overloaded_" + to_string(entity);
+            break;
+        }
+        }
+    }
+    return expr;
+}
+
+string generate_synthetic_program(SyntheticParameters p)
+{
+    p.entities = max<size_t>(p.entities, 1);
+    p.state_properties = max<size_t>(p.state_properties, 1);
+    p.function_properties = max<size_t>(p.function_properties, 1);
+    p.overloads = max<size_t>(p.overloads, 1);
+    p.enum_size = max<size_t>(p.enum_size, 1);
+    p.expression_length = max<size_t>(p.expression_length, 1);
+
+    string src;
+    src += "// Synthetic Gambit program\n";
+    src += "// entities: " + to_string(p.entities) +
+           ", state_properties: " + to_string(p.state_properties) +
+           ", function_properties: " + to_string(p.function_properties) +
+           ", overloads: " + to_string(p.overloads) +
+           ", enum_size: " + to_string(p.enum_size) +
+           ", nesting_depth: " + to_string(p.nesting_depth) +
+           ", expression_length: " + to_string(p.expression_length) + "\n";
+
+    for (size_t i = 0; i < p.entities; i++)
+    {
+        string entity = "Entity_" + to_string(i);
+        string enum_type = "Enum_" + to_string(i);
+
+        // Enum
+        src += "\nenum " + enum_type + " { ";
+        for (size_t v = 0; v < p.enum_size; v++)
+            src += (v > 0 ? ", VALUE_" : "VALUE_") + to_string(v);
+        src += " }\n";
+
+        // Entity
+        src += "\nentity " + entity + "\n";
+
+        // State properties
+        src += "state " + enum_type + " (" + entity + " e).kind\n";
+        for (size_t s = 0; s < p.state_properties; s++)
+            src += "state int (" + entity + " e).state_" + to_string(s) + ": " + to_string(s) + "\n";
+
+        // Enum lookup (scales with enum size)
+        src += "\nfn int (" + entity + " e).rank: match e.kind {\n";
+        for (size_t v = 0; v < p.enum_size; v++)
+            src += "    VALUE_" + to_string(v) + ": " + to_string(v) + "\n";
+        src += "}\n";
+
+        // Overloaded property (one overload for each arity up to the number of overloads)
+        src += "\n";
+        for (size_t o = 0; o < p.overloads; o++)
+        {
+            src += "fn int (";
+            for (size_t a = 0; a <= o; a++)
+                src += (a > 0 ? ", " : "") + entity + " e" + to_string(a);
+            src += ").overloaded_" + to_string(i) + ": " + to_string(o) + "\n";
+        }
+
+        // Function properties
+        src += "\n";
+        for (size_t f = 0; f < p.function_properties; f++)
+            src += "fn int (" + entity + " e).function_" + to_string(f) + ": " + generate_expression(p, i, f, f) + "\n";
+
+        // Procedure
+        src += "\nprocedure_" + to_string(i) + "() {\n";
+        src += indent(1) + entity + " e\n";
+        for (size_t d = 0; d < p.nesting_depth; d++)
+        {
+            src += indent(d + 1) + "if e.state_" + to_string(d % p.state_properties) + " == " + to_string(d) + " {\n";
+            src += indent(d + 2) + "value_" + to_string(d) + " :: " + generate_expression(p, i, d, p.function_properties) + "\n";
+        }
+        src += indent(p.nesting_depth + 1) + "if e.kind == VALUE_" + to_string(p.enum_size - 1) + " {\n";
+        src += indent(p.nesting_depth + 2) + "e.rank + " + generate_expression(p, i, p.nesting_depth, p.function_properties) + "\n";
+        src += indent(p.nesting_depth + 1) + "}\n";
+        for (size_t d = p.nesting_depth; d > 0; d--)
+            src += indent(d) + "}\n";
+        src += "}\n";
+    }
+
+    return src;
+}
+
+bool save_synthetic_program(string file_path, SyntheticParameters parameters)
+{
+    std::ofstream output;
+    output.open(file_path);
+    if (!output.is_open())
+    {
+        cout << "Error attempting to save synthetic program to " + file_path << endl;
+        return false;
+    }
+
+    output << generate_synthetic_program(parameters);
+    output.close();
+    return true;
+}
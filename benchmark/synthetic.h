@@ -0,0 +1,50 @@
+/*
+synthetic.h
+
+Generates synthetic Gambit programs that can be scaled along a number of independent
+dimensions. These are used to benchmark how each phase of the compiler scales as programs
+grow, as the example programs are far too small to show this.
+
+Generated programs should always compile without errors, so that every phase is exercised.
+*/
+
+#pragma once
+#ifndef SYNTHETIC_H
+#define SYNTHETIC_H
+
+#include <string>
+#include <vector>
+using namespace std;
+
+struct SyntheticParameters
+{
+    size_t entities = 4;            // Number of entity types, each with their own enum, properties, and procedure
+    size_t state_properties = 4;    // Number of state properties per entity
+    size_t function_properties = 4; // Number of function properties per entity
+    size_t overloads = 2;           // Number of overloads of each entity's `overloaded` property
+    size_t enum_size = 4;           // Number of values in each enum
+    size_t nesting_depth = 2;       // Number of nested if statements in each procedure
+    size_t expression_length = 4;   // Number of terms in each generated expression
+};
+
+// Each dimension of SyntheticParameters that can be varied by the benchmarks
+enum class SyntheticDimension
+{
+    Entities,
+    StateProperties,
+    FunctionProperties,
+    Overloads,
+    EnumSize,
+    NestingDepth,
+    ExpressionLength,
+};
+
+extern const vector<SyntheticDimension> synthetic_dimensions;
+
+string to_string(SyntheticDimension dimension);
+SyntheticParameters with_dimension(SyntheticParameters parameters, SyntheticDimension dimension, size_t n);
+
+string generate_synthetic_program(SyntheticParameters parameters);
+bool save_synthetic_program(string file_path, SyntheticParameters parameters);
+
+#endif
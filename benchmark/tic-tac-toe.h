@@ -0,0 +1,292 @@
+/*
+tic-tac-toe.h
+
+A port of game/tic-tac-toe to C++, written against the runtime in the same way as card-attack.h.
+The state is small enough that searches clone it, rather than journaling writes to it.
+
+Moves are the index of the chosen square in `board.squares`, generated by filtering it in place
+as `board.available_squares` does, so that applying a move does not filter it again. The game's
+`is_full` checks for marked squares where it means unmarked ones, so the port checks for the latter.
+
+The port can also be played in batches (see batch.h), with the state of every game stored across
+the games in the same way as a generated program's GambitBatchState.
+*/
+
+#pragma once
+#ifndef TIC_TAC_TOE_H
+#define TIC_TAC_TOE_H
+
+#include "../runtime/gambit.h"
+#include <cstdint>
+#include <cstring>
+
+constexpr int NO_MARK = -1;
+
+struct TicTacToeState
+{
+    GambitEntityTable<9> Square;
+    GambitEntityTable<1> Board;
+    GambitEntityTable<2> Player;
+
+    GambitColumn<int, 9> Square_index;
+    GambitColumn<int, 9> Square_mark;
+    GambitColumn<GambitList<GambitEntity, 9>, 1> Board_squares;
+
+    // The global `board`, and the local variables of `main`
+    GambitEntity board;
+    GambitEntity current_player;
+    GambitEntity other_player;
+
+    GambitOutcome outcome;
+};
+
+inline void gambit_hash(GambitHasher &hasher, const TicTacToeState &state)
+{
+    gambit_hash(hasher, state.Square);
+    gambit_hash(hasher, state.Board);
+    gambit_hash(hasher, state.Player);
+    gambit_hash(hasher, state.Square_index);
+    gambit_hash(hasher, state.Square_mark);
+    gambit_hash(hasher, state.Board_squares);
+    gambit_hash(hasher, state.board);
+    gambit_hash(hasher, state.current_player);
+    gambit_hash(hasher, state.other_player);
+    gambit_hash(hasher, state.outcome);
+}
+
+template <uint32_t Lanes>
+struct TicTacToeBatchState
+{
+    GambitEntityTable<9> Square[Lanes];
+    GambitEntityTable<1> Board[Lanes];
+    GambitEntityTable<2> Player[Lanes];
+
+    GambitBatchColumn<int, 9, Lanes> Square_index;
+    GambitBatchColumn<int, 9, Lanes> Square_mark;
+    GambitBatchColumn<GambitList<GambitEntity, 9>, 1, Lanes> Board_squares;
+
+    GambitEntity board[Lanes];
+    GambitEntity current_player[Lanes];
+    GambitEntity other_player[Lanes];
+
+    GambitBatchOutcome<Lanes> outcome;
+};
+
+template <uint32_t Lanes>
+inline void gambit_batch_load(TicTacToeBatchState<Lanes> &batch, uint32_t lane, const TicTacToeState &state)
+{
+    gambit_batch_load(batch.Square, lane, state.Square);
+    gambit_batch_load(batch.Board, lane, state.Board);
+    gambit_batch_load(batch.Player, lane, state.Player);
+    gambit_batch_load(batch.Square_index, lane, state.Square_index);
+    gambit_batch_load(batch.Square_mark, lane, state.Square_mark);
+    gambit_batch_load(batch.Board_squares, lane, state.Board_squares);
+    gambit_batch_load(batch.board, lane, state.board);
+    gambit_batch_load(batch.current_player, lane, state.current_player);
+    gambit_batch_load(batch.other_player, lane, state.other_player);
+    gambit_batch_load(batch.outcome, lane, state.outcome);
+}
+
+template <uint32_t Lanes>
+inline void gambit_batch_store(TicTacToeState &state, const TicTacToeBatchState<Lanes> &batch, uint32_t lane)
+{
+    gambit_batch_store(state.Square, batch.Square, lane);
+    gambit_batch_store(state.Board, batch.Board, lane);
+    gambit_batch_store(state.Player, batch.Player, lane);
+    gambit_batch_store(state.Square_index, batch.Square_index, lane);
+    gambit_batch_store(state.Square_mark, batch.Square_mark, lane);
+    gambit_batch_store(state.Board_squares, batch.Board_squares, lane);
+    gambit_batch_store(state.board, batch.board, lane);
+    gambit_batch_store(state.current_player, batch.current_player, lane);
+    gambit_batch_store(state.other_player, batch.other_player, lane);
+    gambit_batch_store(state.outcome, batch.outcome, lane);
+}
+
+struct TicTacToe
+{
+    using State = TicTacToeState;
+
+    template <uint32_t Lanes>
+    using Batch = TicTacToeBatchState<Lanes>;
+
+    static constexpr uint32_t PLAYER_COUNT = 2;
+    static constexpr uint32_t MAX_MOVES = 9;
+    static constexpr GambitUndo undo = GambitUndo::CLONE;
+
+    // FUNCTIONS //
+
+    // NAUGHT for player 1 and CROSS for player 2
+    static int mark(GambitEntity player) { return (int)entity_index(player); }
+
+    static bool winning_track(int a, int b, int c) { return a != NO_MARK && a == b && a == c; }
+
+    static int winner(const State &state)
+    {
+        static const int lines[8][3] = {
+            {0, 1, 2}, {3, 4, 5}, {6, 7, 8}, {0, 3, 6}, {1, 4, 7}, {2, 5, 8}, {0, 4, 8}, {2, 4, 6}};
+
+        const auto &squares = state.Board_squares[state.board];
+        for (const auto &line : lines)
+        {
+            int a = state.Square_mark[squares[line[0]]];
+            int b = state.Square_mark[squares[line[1]]];
+            int c = state.Square_mark[squares[line[2]]];
+            if (winning_track(a, b, c))
+                return a;
+        }
+        return NO_MARK;
+    }
+
+    static bool is_full(const State &state)
+    {
+        for (GambitEntity square : state.Board_squares[state.board])
+        {
+            if (state.Square_mark[square] == NO_MARK)
+                return false;
+        }
+        return true;
+    }
+
+    // GAME //
+
+    static void setup(State &state)
+    {
+        std::memset(&state, 0, sizeof(State));
+
+        gambit_write(state.board, gambit_create(state.Board));
+        for (int i = 0; i < 9; i++)
+        {
+            GambitEntity square = gambit_create(state.Square);
+            gambit_write(state.Square_index[square], i);
+            gambit_write(state.Square_mark[square], NO_MARK);
+            gambit_insert(state.Board_squares[state.board], square);
+        }
+
+        gambit_write(state.current_player, gambit_create(state.Player));
+        gambit_write(state.other_player, gambit_create(state.Player));
+    }
+
+    static uint32_t legal_moves(const State &state, uint32_t *moves)
+    {
+        return gambit_filter_moves(
+            state.Board_squares[state.board], [&](GambitEntity square)
+            { return state.Square_mark[square] == NO_MARK; },
+            moves);
+    }
+
+    static void apply(State &state, uint32_t move)
+    {
+        GambitEntity chosen_square = state.Board_squares[state.board][move];
+        gambit_write(state.Square_mark[chosen_square], mark(state.current_player));
+
+        if (winner(state) != NO_MARK)
+        {
+            gambit_wins(state, state.current_player);
+            return;
+        }
+
+        if (is_full(state))
+        {
+            gambit_draw(state);
+            return;
+        }
+
+        GambitEntity current_player = state.current_player;
+        gambit_write(state.current_player, state.other_player);
+        gambit_write(state.other_player, current_player);
+    }
+
+    static bool is_terminal(const State &state) { return state.outcome.ended; }
+
+    static uint32_t current_player(const State &state) { return entity_index(state.current_player); }
+
+    static double outcome(const State &state, uint32_t player)
+    {
+        if (!state.outcome.ended || state.outcome.winner < 0)
+            return 0.5;
+        return (uint32_t)state.outcome.winner == player ? 1.0 : 0.0;
+    }
+
+    // BATCHES //
+
+    // Makes a random move in every lane, as `apply` does. Each loop goes over every lane, and
+    // chooses between values rather than branching, so that it can be vectorised. `setup` creates
+    // the squares of the board in order, so the square at each position of `board.squares` has
+    // that position as its index in every lane, and the marks are read by position rather than
+    // through the list.
+    template <uint32_t Lanes>
+    static void step(Batch<Lanes> &batch, GambitBatchRandom<Lanes> &random)
+    {
+        auto &marks = batch.Square_mark.values;
+        auto &outcome = batch.outcome;
+
+        // Lanes that have ended have no squares to choose from
+        uint32_t available[Lanes];
+        for (uint32_t lane = 0; lane < Lanes; lane++)
+            available[lane] = 0;
+        for (uint32_t square = 0; square < 9; square++)
+        {
+            for (uint32_t lane = 0; lane < Lanes; lane++)
+                available[lane] += marks[square][lane] == NO_MARK;
+        }
+        for (uint32_t lane = 0; lane < Lanes; lane++)
+            available[lane] = outcome.ended[lane] ? 0 : available[lane];
+
+        uint32_t chosen[Lanes];
+        random.below(available, chosen);
+
+        // The chosen square is found by counting down the unmarked squares. Lanes that have ended
+        // start below zero, so that they never mark a square.
+        int remaining[Lanes];
+        int player_mark[Lanes];
+        for (uint32_t lane = 0; lane < Lanes; lane++)
+        {
+            remaining[lane] = outcome.ended[lane] ? -1 : (int)chosen[lane];
+            player_mark[lane] = (int)(batch.current_player[lane].id & GAMBIT_INDEX_MASK);
+        }
+        for (uint32_t square = 0; square < 9; square++)
+        {
+            for (uint32_t lane = 0; lane < Lanes; lane++)
+            {
+                int current = marks[square][lane];
+                bool unmarked = current == NO_MARK;
+                marks[square][lane] = unmarked && remaining[lane] == 0 ? player_mark[lane] : current;
+                remaining[lane] -= unmarked;
+            }
+        }
+
+        static const int lines[8][3] = {
+            {0, 1, 2}, {3, 4, 5}, {6, 7, 8}, {0, 3, 6}, {1, 4, 7}, {2, 5, 8}, {0, 4, 8}, {2, 4, 6}};
+
+        bool won[Lanes];
+        for (uint32_t lane = 0; lane < Lanes; lane++)
+            won[lane] = false;
+        for (const auto &line : lines)
+        {
+            for (uint32_t lane = 0; lane < Lanes; lane++)
+            {
+                int a = marks[line[0]][lane];
+                int b = marks[line[1]][lane];
+                int c = marks[line[2]][lane];
+                won[lane] |= (a != NO_MARK) & (a == b) & (a == c);
+            }
+        }
+
+        // The board is full if the move marked the last unmarked square
+        for (uint32_t lane = 0; lane < Lanes; lane++)
+        {
+            bool playing = !outcome.ended[lane];
+            bool ends = playing && (won[lane] || available[lane] == 1);
+            outcome.winner[lane] = ends ? (int8_t)(won[lane] ? player_mark[lane] : -1) : outcome.winner[lane];
+            outcome.ended[lane] = outcome.ended[lane] || ends;
+
+            bool swap = playing && !ends;
+            uint32_t current = batch.current_player[lane].id;
+            uint32_t other = batch.other_player[lane].id;
+            batch.current_player[lane].id = swap ? other : current;
+            batch.other_player[lane].id = swap ? current : other;
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,102 @@
+#include "undo.h"
+#include "card-attack.h"
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+// Results are summed into a volatile so that the moves are not optimised away
+static volatile long long sink;
+
+template <uint32_t CardCapacity>
+static void benchmark_card_attack(RepetitionOptions options)
+{
+    using Game = CardAttack<CardCapacity>;
+    using State = typename Game::State;
+
+    GambitRandom random(1234);
+    auto root = make_unique<State>();
+    Game::setup(*root, random);
+
+    // The moves of one random game, which every strategy plays along. At each position, every
+    // legal move is made and then undone.
+    vector<uint32_t> line;
+    size_t moves_tried = 0;
+    {
+        auto state = make_unique<State>(*root);
+        uint32_t moves[Game::MAX_MOVES];
+        while (!Game::is_terminal(*state))
+        {
+            uint32_t count = Game::legal_moves(*state, moves);
+            moves_tried += count;
+            line.push_back(moves[random.below(count)]);
+            Game::apply(*state, line.back());
+        }
+    }
+
+    GambitStatePool<State> pool;
+    auto state = make_unique<State>();
+    auto clone = measure(options, [&]()
+                         {
+                             long long total = 0;
+                             uint32_t moves[Game::MAX_MOVES];
+                             gambit_clone(*state, *root);
+                             for (uint32_t chosen : line)
+                             {
+                                 uint32_t count = Game::legal_moves(*state, moves);
+                                 for (uint32_t i = 0; i < count; i++)
+                                 {
+                                     State *child = pool.clone(*state);
+                                     Game::apply(*child, moves[i]);
+                                     total += child->phase;
+                                     pool.release(child);
+                                 }
+                                 Game::apply(*state, chosen);
+                             }
+                             sink = total; });
+
+    // The journal is also used to get back to the root at the end of each repetition
+    GambitJournal journal;
+    size_t writes = 0;
+    auto make_unmake = measure(options, [&]()
+                               {
+                                   GambitJournalScope scope(journal);
+                                   long long total = 0;
+                                   uint32_t moves[Game::MAX_MOVES];
+                                   writes = 0;
+                                   for (uint32_t chosen : line)
+                                   {
+                                       uint32_t count = Game::legal_moves(*root, moves);
+                                       for (uint32_t i = 0; i < count; i++)
+                                       {
+                                           auto checkpoint = journal.checkpoint();
+                                           Game::apply(*root, moves[i]);
+                                           total += root->phase;
+                                           writes += journal.checkpoint() - checkpoint;
+                                           journal.rollback(checkpoint);
+                                       }
+                                       Game::apply(*root, chosen);
+                                   }
+                                   journal.rollback(0);
+                                   sink = total; });
+
+    char state_size[32];
+    snprintf(state_size, sizeof state_size, "%.1f KB", sizeof(State) / 1024.0);
+    printf("%-10u %12s %10zu %14.1f %14.1f %16.1f\n",
+           CardCapacity,
+           state_size,
+           line.size(),
+           clone.median / moves_tried * 1e9,
+           make_unmake.median / moves_tried * 1e9,
+           (double)writes / moves_tried);
+}
+
+bool benchmark_undo(RepetitionOptions options)
+{
+    printf("Card attack, making and undoing every legal move along one random game\n");
+    printf("%-10s %12s %10s %14s %14s %16s\n", "cards", "state size", "plies", "clone (ns)", "journal (ns)", "writes per move");
+
+    benchmark_card_attack<52>(options);
+    benchmark_card_attack<256>(options);
+    benchmark_card_attack<4096>(options);
+    return true;
+}
@@ -0,0 +1,18 @@
+/*
+undo.h
+
+Compares the two ways a search can get back to a state after applying a move to it: applying
+the move to a clone of the state, or applying it to the state itself and rolling back the
+journal. Both are measured on card attack, with the standard deck and with a state sized for a
+much larger one, as cloning scales with the size of the state and the journal does not.
+*/
+
+#pragma once
+#ifndef UNDO_H
+#define UNDO_H
+
+#include "phases.h"
+
+bool benchmark_undo(RepetitionOptions options);
+
+#endif
@@ -11,16 +11,18 @@
 
 #define STRUCT_PTR_FIELD_IDENTITY(field) json.add(#field, node->field->identity);
 
-#define VARIANT(T)   \
-    if (IS(node, T)) \
+// The VARIANT macros are case labels, and should be used inside a `switch (node.index())`
+
+#define VARIANT(T)                    \
+    case INDEX_OF(decltype(node), T): \
         return to_json(AS(node, T), depth);
 
-#define VARIANT_PTR(T)   \
-    if (IS_PTR(node, T)) \
+#define VARIANT_PTR(T)                    \
+    case INDEX_OF_PTR(decltype(node), T): \
         return to_json(AS_PTR(node, T), depth);
 
-#define VARIANT_PTR_IDENTITY(T) \
-    if (IS_PTR(node, T))        \
+#define VARIANT_PTR_IDENTITY(T)           \
+    case INDEX_OF_PTR(decltype(node), T): \
         return to_json(AS_PTR(node, T)->identity, depth);
 
 // PROGRAM
@@ -59,6 +61,8 @@ string to_json(const ptr<Scope> &node, const size_t &depth)
 
 string to_json(const Scope::LookupValue &node, const size_t &depth)
 {
+    switch (node.index())
+    {
     VARIANT_PTR(Scope::OverloadedIdentity);
     VARIANT_PTR(Procedure);
     VARIANT_PTR(Variable);
@@ -67,6 +71,7 @@ string to_json(const Scope::LookupValue &node, const size_t &depth)
     VARIANT_PTR(FunctionProperty);
 
     VARIANT(Pattern);
+    }
 
     throw json_serialisation_error("Could not serialise Scope::LookupValue variant.");
 }
@@ -103,6 +108,8 @@ string to_json(const ptr<Variable> &node, const size_t &depth)
     STRUCT_PTR_FIELD(identity);
     STRUCT_PTR_FIELD(pattern);
     STRUCT_PTR_FIELD(is_constant);
+    if (node->constant_value.has_value())
+        STRUCT_PTR_FIELD(constant_value);
     json.close();
     return (string)json;
 }
@@ -111,10 +118,13 @@ string to_json(const ptr<Variable> &node, const size_t &depth)
 
 string to_json(const UnresolvedLiteral &node, const size_t &depth)
 {
+    switch (node.index())
+    {
     VARIANT_PTR(PrimitiveLiteral);
     VARIANT_PTR(ListLiteral);
     VARIANT_PTR(IdentityLiteral);
     VARIANT_PTR(OptionLiteral);
+    }
 
     throw json_serialisation_error("Could not serialise UnresolvedLiteral variant.");
 }
@@ -265,10 +275,13 @@ string to_json(const ptr<EnumType> &node, const size_t &depth)
 
 string to_json(const Property &node, const size_t &depth)
 {
+    switch (node.index())
+    {
     VARIANT_PTR(IdentityLiteral);
     VARIANT_PTR(StateProperty);
     VARIANT_PTR(FunctionProperty);
     VARIANT_PTR(InvalidProperty);
+    }
 
     throw json_serialisation_error("Could not serialise Property variant.");
 }
@@ -297,6 +310,11 @@ string to_json(const ptr<FunctionProperty> &node, const size_t &depth)
     STRUCT_PTR_FIELD(scope);
     STRUCT_PTR_FIELD(parameters);
     STRUCT_PTR_FIELD(body);
+    if (node->constant_results.size() > 0)
+    {
+        STRUCT_PTR_FIELD(constant_domain);
+        STRUCT_PTR_FIELD(constant_results);
+    }
     json.close();
     return (string)json;
 }
@@ -314,6 +332,8 @@ string to_json(const ptr<InvalidProperty> &node, const size_t &depth)
 
 string to_json(const Pattern &node, const size_t &depth)
 {
+    switch (node.index())
+    {
     VARIANT(UnresolvedLiteral);
     VARIANT_PTR(PatternLiteral);
 
@@ -331,6 +351,7 @@ string to_json(const Pattern &node, const size_t &depth)
 
     VARIANT_PTR(UninferredPattern);
     VARIANT_PTR(InvalidPattern);
+    }
 
     throw json_serialisation_error("Could not serialise Pattern variant.");
 }
@@ -398,6 +419,8 @@ string to_json(const ptr<InvalidPattern> &node, const size_t &depth)
 
 string to_json(const Expression &node, const size_t &depth)
 {
+    switch (node.index())
+    {
     VARIANT(UnresolvedLiteral);
     VARIANT_PTR(ExpressionLiteral);
 
@@ -424,6 +447,7 @@ string to_json(const Expression &node, const size_t &depth)
     VARIANT_PTR(MatchExpression);
 
     VARIANT_PTR(InvalidExpression);
+    }
 
     throw json_serialisation_error("Could not serialise Expression variant.");
 };
@@ -613,6 +637,8 @@ string to_json(const ptr<InvalidExpression> &node, const size_t &depth)
 
 string to_json(const Statement &node, const size_t &depth)
 {
+    switch (node.index())
+    {
     VARIANT_PTR(IfStatement);
     VARIANT_PTR(ForStatement);
     VARIANT_PTR(LoopStatement);
@@ -624,6 +650,7 @@ string to_json(const Statement &node, const size_t &depth)
 
     VARIANT_PTR(CodeBlock);
     VARIANT(Expression);
+    }
 
     throw json_serialisation_error("Could not serialise Statement variant.");
 };
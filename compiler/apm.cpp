@@ -2,40 +2,38 @@
 #include "errors.h"
 #include "intrinsic.h"
 #include "source.h"
+#include "trace.h"
 
 // DECLARATION AND FETCHING
 
-string identity_of(Scope::LookupValue value)
+string identity_of(const Scope::LookupValue &value)
 {
-    if (IS_PTR(value, Scope::OverloadedIdentity))
-        return AS_PTR(value, Scope::OverloadedIdentity)->identity;
-    if (IS_PTR(value, Procedure))
-        return AS_PTR(value, Procedure)->identity;
-    if (IS_PTR(value, Variable))
-        return AS_PTR(value, Variable)->identity;
-
-    if (IS_PTR(value, StateProperty))
-        return AS_PTR(value, StateProperty)->identity;
-    if (IS_PTR(value, FunctionProperty))
-        return AS_PTR(value, FunctionProperty)->identity;
-
-    if (IS(value, Pattern))
-    {
-        auto pattern = AS(value, Pattern);
+    auto visitor = overloaded{
+        [&](const Pattern &pattern) -> string
+        {
+            switch (pattern.index())
+            {
+            case INDEX_OF_PTR(Pattern, PrimitiveType):
+                return AS_PTR(pattern, PrimitiveType)->identity;
+            case INDEX_OF_PTR(Pattern, EnumType):
+                return AS_PTR(pattern, EnumType)->identity;
+            case INDEX_OF_PTR(Pattern, EntityType):
+                return AS_PTR(pattern, EntityType)->identity;
+            case INDEX_OF_PTR(Pattern, UnionPattern):
+                return AS_PTR(pattern, UnionPattern)->identity;
+            }
 
-        if (IS_PTR(pattern, PrimitiveType))
-            return AS_PTR(pattern, PrimitiveType)->identity;
-        if (IS_PTR(pattern, EnumType))
-            return AS_PTR(pattern, EnumType)->identity;
-        if (IS_PTR(pattern, EntityType))
-            return AS_PTR(pattern, EntityType)->identity;
-        if (IS_PTR(pattern, UnionPattern))
-            return AS_PTR(pattern, UnionPattern)->identity;
+            throw CompilerError("Cannot get identity of Scope::LookupValue Pattern variant", get_span(value));
+        },
 
-        throw CompilerError("Cannot get identity of Scope::LookupValue Pattern variant", get_span(value));
-    }
+        // Every other alternative is a declaration, all of which have an identity
+        [](const auto &node) -> string
+        {
+            return node->identity;
+        },
+    };
 
-    throw CompilerError("Cannot get identity of Scope::LookupValue variant", get_span(value));
+    return visit_node(value, visitor);
 }
 
 bool directly_declared_in_scope(ptr<Scope> scope, string identity)
@@ -107,28 +105,29 @@ bool is_callable(Expression expr)
 
 // PATTERN ANALYSIS
 
-Pattern determine_expression_pattern(Expression expression)
+Pattern determine_expression_pattern(const Expression &expression)
 {
-
+    switch (expression.index())
+    {
     // Literals
-    if (IS(expression, UnresolvedLiteral))
+    case INDEX_OF(Expression, UnresolvedLiteral):
     {
         auto unresolved_literal = AS(expression, UnresolvedLiteral);
         throw CompilerError("Cannot determine pattern of expression before identities have been resolved.", get_span(unresolved_literal));
     }
 
-    if (IS_PTR(expression, ExpressionLiteral))
+    case INDEX_OF_PTR(Expression, ExpressionLiteral):
     {
         return determine_expression_pattern(AS_PTR(expression, ExpressionLiteral)->expr);
     }
 
     // Values
-    if (IS_PTR(expression, PrimitiveValue))
+    case INDEX_OF_PTR(Expression, PrimitiveValue):
     {
         return AS_PTR(expression, PrimitiveValue);
     }
 
-    if (IS_PTR(expression, ListValue))
+    case INDEX_OF_PTR(Expression, ListValue):
     {
         auto list_value = AS_PTR(expression, ListValue);
 
@@ -151,19 +150,19 @@ Pattern determine_expression_pattern(Expression expression)
         return list_type;
     }
 
-    if (IS_PTR(expression, EnumValue))
+    case INDEX_OF_PTR(Expression, EnumValue):
     {
         return AS_PTR(expression, EnumValue);
     }
 
-    if (IS_PTR(expression, Variable))
+    case INDEX_OF_PTR(Expression, Variable):
     {
         auto variable = AS_PTR(expression, Variable);
         return variable->pattern;
     }
 
     // Operations
-    if (IS_PTR(expression, Unary))
+    case INDEX_OF_PTR(Expression, Unary):
     {
         auto unary = AS_PTR(expression, Unary);
         auto op = unary->op;
@@ -177,9 +176,11 @@ Pattern determine_expression_pattern(Expression expression)
         // If the value is `int` or `amt`, the pattern should actually be `int`
         if (op == "-")
             return Intrinsic::type_num;
+
+        break;
     }
 
-    if (IS_PTR(expression, Binary))
+    case INDEX_OF_PTR(Expression, Binary):
     {
         auto binary = AS_PTR(expression, Binary);
         auto op = binary->op;
@@ -189,17 +190,19 @@ Pattern determine_expression_pattern(Expression expression)
         // FIXME: Depending on the operation and arguments, sometimes the pattern can actually be `int` or `amt`
         if (op == "+" || op == "*" || op == "-" || op == "/")
             return Intrinsic::type_num;
+
+        break;
     }
 
     // Indexing
-    if (IS_PTR(expression, IndexWithExpression))
+    case INDEX_OF_PTR(Expression, IndexWithExpression):
     {
         auto index_with_expression = AS_PTR(expression, IndexWithExpression);
         auto subject_pattern = determine_expression_pattern(index_with_expression->subject);
         return determine_pattern_of_contents_of(subject_pattern);
     }
 
-    if (IS_PTR(expression, IndexWithIdentity))
+    case INDEX_OF_PTR(Expression, IndexWithIdentity):
     {
         // NOTE: As of writing, the resolver converts all IndexWithIdentity nodes into either a PropertyAccess or an enum value.
         //       This means an IndexWithIdentity should never be passed into this function. However, assuming that at some point
@@ -210,13 +213,13 @@ Pattern determine_expression_pattern(Expression expression)
     }
 
     // Calls
-    if (IS_PTR(expression, Call))
+    case INDEX_OF_PTR(Expression, Call):
     {
         // TODO: Return the correct pattern
         return CREATE(AnyPattern);
     }
 
-    if (IS_PTR(expression, PropertyAccess))
+    case INDEX_OF_PTR(Expression, PropertyAccess):
     {
         auto property_access = AS_PTR(expression, PropertyAccess);
         auto property = property_access->property;
@@ -236,7 +239,7 @@ Pattern determine_expression_pattern(Expression expression)
     }
 
     // Choose expression
-    if (IS_PTR(expression, ChooseExpression))
+    case INDEX_OF_PTR(Expression, ChooseExpression):
     {
         auto choose_expression = AS_PTR(expression, ChooseExpression);
         auto choices_pattern = determine_expression_pattern(choose_expression->choices);
@@ -244,7 +247,7 @@ Pattern determine_expression_pattern(Expression expression)
     }
 
     // "Statements style" expressions
-    if (IS_PTR(expression, IfExpression))
+    case INDEX_OF_PTR(Expression, IfExpression):
     {
         auto if_expression = AS_PTR(expression, IfExpression);
 
@@ -255,7 +258,7 @@ Pattern determine_expression_pattern(Expression expression)
         return create_union_pattern(rule_result_patterns);
     }
 
-    if (IS_PTR(expression, MatchExpression))
+    case INDEX_OF_PTR(Expression, MatchExpression):
     {
         auto match = AS_PTR(expression, MatchExpression);
 
@@ -267,10 +270,11 @@ Pattern determine_expression_pattern(Expression expression)
     }
 
     // Invalid expression
-    if (IS_PTR(expression, InvalidExpression))
+    case INDEX_OF_PTR(Expression, InvalidExpression):
     {
         return CREATE(InvalidPattern);
     }
+    }
 
     throw CompilerError("Cannot determine pattern of Expression variant.", get_span(expression));
 }
@@ -536,6 +540,8 @@ bool is_pattern_optional(Pattern pattern)
 
 bool does_instance_list_match_parameters(ptr<InstanceList> instance_list, vector<ptr<Variable>> parameters)
 {
+    TRACE_FUNCTION("APM");
+
     auto values = instance_list->values;
 
     if (values.size() > parameters.size())
@@ -564,147 +570,93 @@ bool does_instance_list_match_parameters(ptr<InstanceList> instance_list, vector
 
 // SPANS
 
-Span get_span(UnresolvedLiteral literal)
+// Only some APM nodes record the span they were declared at
+template <typename T, typename = void>
+struct has_span : false_type
 {
-    if (IS_PTR(literal, PrimitiveLiteral))
-        return AS_PTR(literal, PrimitiveLiteral)->span;
-    if (IS_PTR(literal, ListLiteral))
-        return AS_PTR(literal, ListLiteral)->span;
-    if (IS_PTR(literal, IdentityLiteral))
-        return AS_PTR(literal, IdentityLiteral)->span;
-    if (IS_PTR(literal, OptionLiteral))
-        return AS_PTR(literal, OptionLiteral)->span;
-
-    throw CompilerError("Could not get span of UnresolvedLiteral variant.");
-}
+};
 
-Span get_span(Pattern pattern)
+template <typename T>
+struct has_span<ptr<T>, void_t<decltype(declval<T>().span)>> : true_type
 {
-    if (IS(pattern, UnresolvedLiteral))
-        return get_span(AS(pattern, UnresolvedLiteral));
-    if (IS_PTR(pattern, PatternLiteral))
-        return AS_PTR(pattern, PatternLiteral)->span;
-
-    // if (IS_PTR(pattern, AnyPattern))
-    //     return AS_PTR(pattern, AnyPattern)->span;
-
-    // if (IS_PTR(pattern, UnionPattern))
-    //     return AS_PTR(pattern, UnionPattern)->span;
+};
 
-    // if (IS_PTR(pattern, PrimitiveValue))
-    //     return AS_PTR(pattern, PrimitiveValue)->span;
-    if (IS_PTR(pattern, EnumValue))
-        return AS_PTR(pattern, EnumValue)->span;
-
-    // if (IS_PTR(pattern, PrimitiveType))
-    //     return AS_PTR(pattern, PrimitiveType)->span;
-    // if (IS_PTR(pattern, ListType))
-    //     return AS_PTR(pattern, ListType)->span;
-    if (IS_PTR(pattern, EnumType))
-        return AS_PTR(pattern, EnumType)->span;
-    if (IS_PTR(pattern, EntityType))
-        return AS_PTR(pattern, EntityType)->span;
-
-    // if (IS_PTR(pattern, UninferredPattern))
-    //     return AS_PTR(pattern, UninferredPattern)->span;
-
-    // if (IS_PTR(pattern, InvalidPattern))
-    //     return AS_PTR(pattern, InvalidPattern)->span;
+Span get_span(const UnresolvedLiteral &literal)
+{
+    return visit_node(literal, [](const auto &node) -> Span
+                      { return node->span; });
+}
 
-    throw CompilerError("Could not get span of Pattern variant.");
+Span get_span(const Pattern &pattern)
+{
+    auto visitor = overloaded{
+        [](const UnresolvedLiteral &literal) -> Span
+        {
+            return get_span(literal);
+        },
+        [](const auto &node) -> Span
+        {
+            if constexpr (has_span<decay_t<decltype(node)>>::value)
+                return node->span;
+            else
+                throw CompilerError("Could not get span of Pattern variant.");
+        },
+    };
+
+    return visit_node(pattern, visitor);
 }
 
-Span get_span(Expression expr)
+Span get_span(const Expression &expr)
 {
-    if (IS(expr, UnresolvedLiteral))
-        return get_span(AS(expr, UnresolvedLiteral));
-    if (IS_PTR(expr, ExpressionLiteral))
-        return AS_PTR(expr, ExpressionLiteral)->span;
-
-    // if (IS_PTR(expr, PrimitiveValue))
-    //     return AS_PTR(expr, PrimitiveValue)->span;
-    // if (IS_PTR(expr, ListValue))
-    //     return AS_PTR(expr, ListValue)->span;
-    if (IS_PTR(expr, EnumValue))
-        return AS_PTR(expr, EnumValue)->span;
-    if (IS_PTR(expr, Variable))
-        return AS_PTR(expr, Variable)->span;
-
-    if (IS_PTR(expr, Unary))
-        return AS_PTR(expr, Unary)->span;
-    if (IS_PTR(expr, Binary))
-        return AS_PTR(expr, Binary)->span;
-
-    if (IS_PTR(expr, InstanceList))
-        return AS_PTR(expr, InstanceList)->span;
-    if (IS_PTR(expr, IndexWithExpression))
-        return AS_PTR(expr, IndexWithExpression)->span;
-    if (IS_PTR(expr, IndexWithIdentity))
-        return AS_PTR(expr, IndexWithIdentity)->span;
-
-    if (IS_PTR(expr, Call))
-        return AS_PTR(expr, Call)->span;
-    if (IS_PTR(expr, PropertyAccess))
-        return AS_PTR(expr, PropertyAccess)->span;
-
-    if (IS_PTR(expr, ChooseExpression))
-        return AS_PTR(expr, ChooseExpression)->span;
-
-    if (IS_PTR(expr, IfExpression))
-        return AS_PTR(expr, IfExpression)->span;
-    if (IS_PTR(expr, MatchExpression))
-        return AS_PTR(expr, MatchExpression)->span;
-
-    // if (IS_PTR(expr, InvalidExpression))
-    //     return AS_PTR(expr, InvalidExpression)->span;
-
-    throw CompilerError("Could not get span of Expression variant.");
+    auto visitor = overloaded{
+        [](const UnresolvedLiteral &literal) -> Span
+        {
+            return get_span(literal);
+        },
+        [](const auto &node) -> Span
+        {
+            if constexpr (has_span<decay_t<decltype(node)>>::value)
+                return node->span;
+            else
+                throw CompilerError("Could not get span of Expression variant.");
+        },
+    };
+
+    return visit_node(expr, visitor);
 }
 
-Span get_span(Statement stmt)
+Span get_span(const Statement &stmt)
 {
-    if (IS_PTR(stmt, IfStatement))
-        return AS_PTR(stmt, IfStatement)->span;
-    if (IS_PTR(stmt, ForStatement))
-        return AS_PTR(stmt, ForStatement)->span;
-    if (IS_PTR(stmt, LoopStatement))
-        return AS_PTR(stmt, LoopStatement)->span;
-    if (IS_PTR(stmt, ReturnStatement))
-        return AS_PTR(stmt, ReturnStatement)->span;
-    if (IS_PTR(stmt, WinsStatement))
-        return AS_PTR(stmt, WinsStatement)->span;
-    if (IS_PTR(stmt, DrawStatement))
-        return AS_PTR(stmt, DrawStatement)->span;
-    if (IS_PTR(stmt, AssignmentStatement))
-        return AS_PTR(stmt, AssignmentStatement)->span;
-    if (IS_PTR(stmt, VariableDeclaration))
-        return AS_PTR(stmt, VariableDeclaration)->span;
-
-    if (IS_PTR(stmt, CodeBlock))
-        return AS_PTR(stmt, CodeBlock)->span;
-
-    if (IS(stmt, Expression))
-        return get_span(AS(stmt, Expression));
-
-    throw CompilerError("Could not get span of Statement variant.");
+    auto visitor = overloaded{
+        [](const Expression &expr) -> Span
+        {
+            return get_span(expr);
+        },
+        [](const auto &node) -> Span
+        {
+            return node->span;
+        },
+    };
+
+    return visit_node(stmt, visitor);
 }
 
-Span get_span(Scope::LookupValue value)
+Span get_span(const Scope::LookupValue &value)
 {
-    if (IS_PTR(value, Scope::OverloadedIdentity))
-        return get_span(AS_PTR(value, Scope::OverloadedIdentity)->overloads[0]); // FIXME: What span should we really use in this situation?
-    if (IS_PTR(value, Variable))
-        return AS_PTR(value, Variable)->span;
-    if (IS_PTR(value, Procedure))
-        return AS_PTR(value, Procedure)->span;
-
-    if (IS_PTR(value, StateProperty))
-        return AS_PTR(value, StateProperty)->span;
-    if (IS_PTR(value, FunctionProperty))
-        return AS_PTR(value, FunctionProperty)->span;
-
-    if (IS(value, Pattern))
-        return get_span(AS(value, Pattern));
-
-    throw CompilerError("Could not get span of Scope::LookupValue variant.");
-}
\ No newline at end of file
+    auto visitor = overloaded{
+        [](const ptr<Scope::OverloadedIdentity> &overloaded_identity) -> Span
+        {
+            return get_span(overloaded_identity->overloads[0]); // FIXME: What span should we really use in this situation?
+        },
+        [](const Pattern &pattern) -> Span
+        {
+            return get_span(pattern);
+        },
+        [](const auto &node) -> Span
+        {
+            return node->span;
+        },
+    };
+
+    return visit_node(value, visitor);
+}
@@ -15,6 +15,7 @@ side-effects be managed by the 'actual' compiler.
 
 #include "span.h"
 #include "utilty.h"
+#include "visitor.h"
 #include <optional>
 #include <string>
 #include <unordered_map>
@@ -243,7 +244,10 @@ struct Variable
     Span span;
     string identity;
     Pattern pattern;
-    bool is_constant;
+    bool is_constant = false;
+
+    // Set by the Evaluator if the variable is a constant whose value is known at compile time
+    optional<Expression> constant_value = {};
 };
 
 // LITERALS
@@ -343,6 +347,12 @@ struct FunctionProperty
     ptr<Scope> scope;
     vector<ptr<Variable>> parameters;
     optional<ptr<CodeBlock>> body;
+
+    // Set by the Evaluator if the property has a single parameter with a finite number of
+    // possible values, and its result depends only on that parameter. The result for each
+    // argument in `constant_domain` is given at the same position in `constant_results`.
+    vector<Expression> constant_domain;
+    vector<Expression> constant_results;
 };
 
 struct InvalidProperty
@@ -553,7 +563,7 @@ struct VariableDeclaration
 
 // Declaration and fetching
 [[nodiscard]] string
-identity_of(Scope::LookupValue value);
+identity_of(const Scope::LookupValue &value);
 [[nodiscard]] bool directly_declared_in_scope(ptr<Scope> scope, string identity);
 [[nodiscard]] bool declared_in_scope(ptr<Scope> scope, string identity);
 [[nodiscard]] bool is_overloadable(Scope::LookupValue value);
@@ -565,7 +575,7 @@ identity_of(Scope::LookupValue value);
 [[nodiscard]] bool is_callable(Expression expr);
 
 // Pattern analysis
-[[nodiscard]] Pattern determine_expression_pattern(Expression expr);
+[[nodiscard]] Pattern determine_expression_pattern(const Expression &expr);
 [[nodiscard]] Pattern determine_pattern_of_contents_of(Pattern pattern);
 [[nodiscard]] Pattern create_union_pattern(vector<Pattern> patterns);
 [[nodiscard]] bool is_pattern_subset_of_superset(Pattern subset, Pattern superset);
@@ -574,12 +584,12 @@ identity_of(Scope::LookupValue value);
 [[nodiscard]] bool does_instance_list_match_parameters(ptr<InstanceList> instance_list, vector<ptr<Variable>> parameters);
 
 // Spans
-[[nodiscard]] Span get_span(UnresolvedLiteral stmt);
-[[nodiscard]] Span get_span(Pattern pattern);
-[[nodiscard]] Span get_span(Expression expr);
-[[nodiscard]] Span get_span(Statement stmt);
+[[nodiscard]] Span get_span(const UnresolvedLiteral &stmt);
+[[nodiscard]] Span get_span(const Pattern &pattern);
+[[nodiscard]] Span get_span(const Expression &expr);
+[[nodiscard]] Span get_span(const Statement &stmt);
 
-[[nodiscard]] Span get_span(Scope::LookupValue value);
+[[nodiscard]] Span get_span(const Scope::LookupValue &value);
 
 // JSON SERIALISATION
 
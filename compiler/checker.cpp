@@ -1,5 +1,6 @@
 #include "checker.h"
 #include "intrinsic.h"
+#include "trace.h"
 
 // TODO: Currently, I assume that the checker will never actually modify
 //       the APM, only read it. It may be worth formalising that assumption
@@ -18,6 +19,8 @@
 
 void Checker::check(Source &source, ptr<Program> program)
 {
+    TRACE_FUNCTION("Checker");
+
     this->source = &source;
     check_program(program);
 }
@@ -26,11 +29,15 @@ void Checker::check(Source &source, ptr<Program> program)
 
 void Checker::check_program(ptr<Program> program)
 {
+    TRACE_FUNCTION("Checker");
+
     check_scope(program->global_scope);
 }
 
 void Checker::check_scope(ptr<Scope> scope)
 {
+    TRACE_FUNCTION("Checker");
+
     for (auto index : scope->lookup)
         check_scope_lookup_value(index.second, scope);
 }
@@ -50,6 +57,7 @@ void Checker::check_scope_lookup_value(Scope::LookupValue value, ptr<Scope> scop
     else if (IS_PTR(value, Procedure))
     {
         auto proc = AS_PTR(value, Procedure);
+        TRACE_FUNCTION_DETAIL("Checker", proc->identity);
         check_code_block(proc->body);
 
         // FIXME: If the body is a singleton, check the statement as if it were a return expression
@@ -61,6 +69,7 @@ void Checker::check_scope_lookup_value(Scope::LookupValue value, ptr<Scope> scop
     else if (IS_PTR(value, StateProperty))
     {
         auto state = AS_PTR(value, StateProperty);
+        TRACE_FUNCTION_DETAIL("Checker", state->identity);
         if (state->initial_value.has_value())
         {
             auto initial_value = state->initial_value.value();
@@ -75,6 +84,7 @@ void Checker::check_scope_lookup_value(Scope::LookupValue value, ptr<Scope> scop
     else if (IS_PTR(value, FunctionProperty))
     {
         auto funct = AS_PTR(value, FunctionProperty);
+        TRACE_FUNCTION_DETAIL("Checker", funct->identity);
         if (funct->body.has_value())
             check_code_block(funct->body.value());
 
@@ -90,39 +100,55 @@ void Checker::check_scope_lookup_value(Scope::LookupValue value, ptr<Scope> scop
 
 void Checker::check_code_block(ptr<CodeBlock> code_block)
 {
+    TRACE_FUNCTION("Checker");
+
     check_scope(code_block->scope);
-    for (auto stmt : code_block->statements)
+    for (const auto &stmt : code_block->statements)
         check_statement(stmt, code_block->scope);
 }
 
 // STATEMENTS //
 
-void Checker::check_statement(Statement stmt, ptr<Scope> scope)
+void Checker::check_statement(const Statement &stmt, ptr<Scope> scope)
 {
-    if (IS_PTR(stmt, IfStatement))
+    TRACE_FUNCTION("Checker");
+
+    switch (stmt.index())
+    {
+    case INDEX_OF_PTR(Statement, IfStatement):
         check_if_statement(AS_PTR(stmt, IfStatement), scope);
-    else if (IS_PTR(stmt, ForStatement))
+        break;
+    case INDEX_OF_PTR(Statement, ForStatement):
         check_for_statement(AS_PTR(stmt, ForStatement), scope);
-    else if (IS_PTR(stmt, LoopStatement))
+        break;
+    case INDEX_OF_PTR(Statement, LoopStatement):
         check_loop_statement(AS_PTR(stmt, LoopStatement), scope);
-    else if (IS_PTR(stmt, ReturnStatement))
+        break;
+    case INDEX_OF_PTR(Statement, ReturnStatement):
         check_return_statement(AS_PTR(stmt, ReturnStatement), scope);
-    else if (IS_PTR(stmt, WinsStatement))
+        break;
+    case INDEX_OF_PTR(Statement, WinsStatement):
         check_wins_statement(AS_PTR(stmt, WinsStatement), scope);
-    else if (IS_PTR(stmt, DrawStatement))
-        ; // skip
-    else if (IS_PTR(stmt, AssignmentStatement))
+        break;
+    case INDEX_OF_PTR(Statement, DrawStatement):
+        break; // skip
+    case INDEX_OF_PTR(Statement, AssignmentStatement):
         check_assignment_statement(AS_PTR(stmt, AssignmentStatement), scope);
-    else if (IS_PTR(stmt, VariableDeclaration))
+        break;
+    case INDEX_OF_PTR(Statement, VariableDeclaration):
         check_variable_declaration(AS_PTR(stmt, VariableDeclaration), scope);
+        break;
 
-    else if (IS_PTR(stmt, CodeBlock))
+    case INDEX_OF_PTR(Statement, CodeBlock):
         check_code_block(AS_PTR(stmt, CodeBlock));
-    else if (IS(stmt, Expression))
+        break;
+    case INDEX_OF(Statement, Expression):
         check_expression(AS(stmt, Expression), scope);
+        break;
 
-    else
+    default:
         throw CompilerError("Cannot check Statement variant.", get_span(stmt));
+    }
 }
 
 void Checker::check_if_statement(ptr<IfStatement> stmt, ptr<Scope> scope)
@@ -188,64 +214,80 @@ void Checker::check_variable_declaration(ptr<VariableDeclaration> stmt, ptr<Scop
 
 // EXPRESSIONS //
 
-void Checker::check_expression(Expression expr, ptr<Scope> scope)
+void Checker::check_expression(const Expression &expr, ptr<Scope> scope)
 {
+    TRACE_FUNCTION("Checker");
 
-    if (IS(expr, UnresolvedLiteral))
+    switch (expr.index())
+    {
+    case INDEX_OF(Expression, UnresolvedLiteral):
         throw CompilerError("Attempt to check UnresolvedLiteral. This should have already been resolved.");
-    else if (IS_PTR(expr, ExpressionLiteral))
+    case INDEX_OF_PTR(Expression, ExpressionLiteral):
         check_expression(AS_PTR(expr, ExpressionLiteral)->expr, scope);
+        break;
 
-    else if (IS_PTR(expr, PrimitiveValue))
-        ; // skip
-    else if (IS_PTR(expr, ListValue))
+    case INDEX_OF_PTR(Expression, PrimitiveValue):
+        break; // skip
+    case INDEX_OF_PTR(Expression, ListValue):
         check_list_value(AS_PTR(expr, ListValue), scope);
-    else if (IS_PTR(expr, EnumValue))
-        ; // skip
-    else if (IS_PTR(expr, Variable))
-        ; // skip
+        break;
+    case INDEX_OF_PTR(Expression, EnumValue):
+        break; // skip
+    case INDEX_OF_PTR(Expression, Variable):
+        break; // skip
 
-    else if (IS_PTR(expr, Unary))
+    case INDEX_OF_PTR(Expression, Unary):
         check_unary(AS_PTR(expr, Unary), scope);
-    else if (IS_PTR(expr, Binary))
+        break;
+    case INDEX_OF_PTR(Expression, Binary):
         check_binary(AS_PTR(expr, Binary), scope);
+        break;
 
-    else if (IS_PTR(expr, InstanceList))
+    case INDEX_OF_PTR(Expression, InstanceList):
         check_instance_list(AS_PTR(expr, InstanceList), scope);
-    else if (IS_PTR(expr, IndexWithExpression))
+        break;
+    case INDEX_OF_PTR(Expression, IndexWithExpression):
         check_index_with_expression(AS_PTR(expr, IndexWithExpression), scope);
-    else if (IS_PTR(expr, IndexWithIdentity))
+        break;
+    case INDEX_OF_PTR(Expression, IndexWithIdentity):
         check_index_with_identity(AS_PTR(expr, IndexWithIdentity), scope);
+        break;
 
-    else if (IS_PTR(expr, Call))
+    case INDEX_OF_PTR(Expression, Call):
         check_call(AS_PTR(expr, Call), scope);
-    else if (IS_PTR(expr, PropertyAccess))
+        break;
+    case INDEX_OF_PTR(Expression, PropertyAccess):
         check_property_access(AS_PTR(expr, PropertyAccess), scope);
+        break;
 
-    else if (IS_PTR(expr, ChooseExpression))
+    case INDEX_OF_PTR(Expression, ChooseExpression):
         check_choose_expression(AS_PTR(expr, ChooseExpression), scope);
+        break;
 
-    else if (IS_PTR(expr, IfExpression))
+    case INDEX_OF_PTR(Expression, IfExpression):
         check_if_expression(AS_PTR(expr, IfExpression), scope);
-    else if (IS_PTR(expr, MatchExpression))
+        break;
+    case INDEX_OF_PTR(Expression, MatchExpression):
         check_match(AS_PTR(expr, MatchExpression), scope);
+        break;
 
-    else if (IS_PTR(expr, InvalidExpression))
-        ; // skip
+    case INDEX_OF_PTR(Expression, InvalidExpression):
+        break; // skip
 
-    else
+    default:
         throw CompilerError("Cannot check Expression variant.", get_span(expr));
+    }
 }
 
 void Checker::check_list_value(ptr<ListValue> list, ptr<Scope> scope)
 {
-    for (auto value : list->values)
+    for (const auto &value : list->values)
         check_expression(value, scope);
 }
 
 void Checker::check_instance_list(ptr<InstanceList> list, ptr<Scope> scope)
 {
-    for (auto value : list->values)
+    for (const auto &value : list->values)
         check_expression(value, scope);
 }
 
@@ -288,6 +330,8 @@ void Checker::check_if_expression(ptr<IfExpression> if_expression, ptr<Scope> sc
 
 void Checker::check_match(ptr<MatchExpression> match, ptr<Scope> scope)
 {
+    TRACE_FUNCTION("Checker");
+
     check_expression(match->subject, scope);
     auto subject_pattern = determine_expression_pattern(match->subject);
 
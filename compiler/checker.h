@@ -23,7 +23,7 @@ private:
     void check_code_block(ptr<CodeBlock> code_block);
 
     // STATEMENTS //
-    void check_statement(Statement statement, ptr<Scope> scope);
+    void check_statement(const Statement &statement, ptr<Scope> scope);
 
     void check_if_statement(ptr<IfStatement> stmt, ptr<Scope> scope);
     void check_for_statement(ptr<ForStatement> stmt, ptr<Scope> scope);
@@ -34,7 +34,7 @@ private:
     void check_variable_declaration(ptr<VariableDeclaration> stmt, ptr<Scope> scope);
 
     // EXPRESSIONS //
-    void check_expression(Expression expression, ptr<Scope> scope);
+    void check_expression(const Expression &expression, ptr<Scope> scope);
 
     void check_list_value(ptr<ListValue> list, ptr<Scope> scope);
 
@@ -1,20 +1,64 @@
 #include "errors.h"
 #include "converter.h"
+#include "evaluator.h"
+#include "intrinsic.h"
+#include "trace.h"
+#include <algorithm>
+#include <functional>
+
+// The value of an expression, if it is a single value that is known at compile time
+static optional<Expression> constant_of(Expression expression)
+{
+    while (IS_PTR(expression, ExpressionLiteral))
+        expression = AS_PTR(expression, ExpressionLiteral)->expr;
+
+    if (IS_PTR(expression, EnumValue) || IS_PTR(expression, PrimitiveValue))
+        return expression;
+
+    if (IS_PTR(expression, Variable))
+    {
+        auto constant_value = AS_PTR(expression, Variable)->constant_value;
+        if (constant_value.has_value() && !IS_PTR(constant_value.value(), ListValue))
+            return constant_value;
+    }
+
+    return {};
+}
 
 C_Program Converter::convert(ptr<Program> program)
 {
+    TRACE_FUNCTION("Converter");
+
     // Reserve identities that will be used in the C program
     identities_used.insert("GambitEntity");
+    identities_used.insert("GambitState");
+    identities_used.insert("gambit_state");
     identities_used.insert("main");
 
+    // Reserve enough space that small programs never need to reallocate the IR
+    ir.statements.reserve(256);
+    ir.expressions.reserve(256);
+
+    convert_state(program);
+
     // Convert everything in global scope
-    for (auto entry : program->global_scope->lookup)
+    // NOTE: The lookup is an unordered_map, so procedures are sorted by identity before they are
+    //       converted. This keeps the order of functions in the generated code (and the identities
+    //       given to them by `create_identity`) the same from one compilation to the next.
+    vector<ptr<Procedure>> procedures;
+    for (const auto &entry : program->global_scope->lookup)
     {
         auto value = entry.second;
         if (IS_PTR(value, Procedure))
-            convert_procedure(AS_PTR(value, Procedure));
+            procedures.push_back(AS_PTR(value, Procedure));
     }
 
+    sort(procedures.begin(), procedures.end(), [](const ptr<Procedure> &a, const ptr<Procedure> &b)
+         { return a->identity < b->identity; });
+
+    for (const auto &procedure : procedures)
+        convert_procedure(procedure);
+
     return ir;
 }
 
@@ -38,26 +82,330 @@ string Converter::create_identity(string identity)
 
 void Converter::convert_procedure(ptr<Procedure> procedure)
 {
+    TRACE_FUNCTION_DETAIL("Converter", procedure->identity);
+
     C_Function funct;
-    funct.identity = create_identity(procedure->identity);
+    funct.identity = intern_string(ir, create_identity(procedure->identity));
     funct.body = convert_statement(procedure->body);
 
+    if (procedure->identity == "main")
+        ir.entry_point = (C_Index)ir.functions.size();
     ir.functions.push_back(funct);
 }
 
-size_t Converter::create_statement(C_Statement::Kind kind)
+// ENTITIES AND STATE //
+
+static bool is_optional_enum(const Pattern &pattern)
 {
-    ir.statements.emplace_back().kind = kind;
-    return ir.statements.size() - 1;
+    if (IS_PTR(pattern, PatternLiteral))
+        return is_optional_enum(AS_PTR(pattern, PatternLiteral)->pattern);
+
+    if (!IS_PTR(pattern, UnionPattern))
+        return false;
+
+    bool has_none = false;
+    bool has_enum = false;
+    for (auto sub_pattern : AS_PTR(pattern, UnionPattern)->patterns)
+    {
+        while (IS_PTR(sub_pattern, PatternLiteral))
+            sub_pattern = AS_PTR(sub_pattern, PatternLiteral)->pattern;
+
+        has_none = has_none || (IS_PTR(sub_pattern, PrimitiveValue) && AS_PTR(sub_pattern, PrimitiveValue) == Intrinsic::none_val);
+        has_enum = has_enum || IS_PTR(sub_pattern, EnumType);
+    }
+    return has_none && has_enum;
+}
+
+// Collects every entity type and state property declared in global scope, sorted by identity so
+// that the layout of the game state is the same from one compilation to the next
+void Converter::convert_state(ptr<Program> program)
+{
+    TRACE_FUNCTION("Converter");
+
+    vector<ptr<EntityType>> entity_types;
+    vector<ptr<StateProperty>> state_properties;
+
+    function<void(const Scope::LookupValue &)> collect = [&](const Scope::LookupValue &value)
+    {
+        if (IS_PTR(value, Scope::OverloadedIdentity))
+        {
+            for (const auto &overload : AS_PTR(value, Scope::OverloadedIdentity)->overloads)
+                collect(overload);
+        }
+        else if (IS_PTR(value, StateProperty))
+        {
+            state_properties.push_back(AS_PTR(value, StateProperty));
+        }
+        else if (IS(value, Pattern) && IS_PTR(AS(value, Pattern), EntityType))
+        {
+            entity_types.push_back(AS_PTR(AS(value, Pattern), EntityType));
+        }
+    };
+
+    for (const auto &entry : program->global_scope->lookup)
+        collect(entry.second);
+
+    sort(entity_types.begin(), entity_types.end(), [](const ptr<EntityType> &a, const ptr<EntityType> &b)
+         { return a->identity < b->identity; });
+
+    for (const auto &entity_type : entity_types)
+    {
+        C_Entity entity;
+        entity.identity = intern_string(ir, create_identity(entity_type->identity));
+        entity_indexes[entity_type.get()] = (C_Index)ir.entities.size();
+        ir.entities.push_back(entity);
+    }
+
+    // Properties are named after the entities of their parameters as well, as several entities
+    // may have a property with the same identity
+    auto entities_of = [&](const ptr<StateProperty> &property) -> optional<vector<C_Index>>
+    {
+        if (property->parameters.size() == 0)
+            return {};
+
+        vector<C_Index> entities;
+        for (const auto &parameter : property->parameters)
+        {
+            auto pattern = parameter->pattern;
+            while (IS_PTR(pattern, PatternLiteral))
+                pattern = AS_PTR(pattern, PatternLiteral)->pattern;
+            if (!IS_PTR(pattern, EntityType))
+                return {};
+
+            auto it = entity_indexes.find(AS_PTR(pattern, EntityType).get());
+            if (it == entity_indexes.end())
+                return {};
+            entities.push_back(it->second);
+        }
+        return entities;
+    };
+
+    auto property_name = [&](const ptr<StateProperty> &property)
+    {
+        string name;
+        auto entities = entities_of(property).value();
+        for (C_Index entity : entities)
+            name += ir.strings[ir.entities[entity].identity] + "_";
+        return name + property->identity;
+    };
+
+    state_properties.erase(remove_if(state_properties.begin(), state_properties.end(), [&](const ptr<StateProperty> &property)
+                                     { return !entities_of(property).has_value(); }),
+                           state_properties.end());
+
+    sort(state_properties.begin(), state_properties.end(), [&](const ptr<StateProperty> &a, const ptr<StateProperty> &b)
+         { return property_name(a) < property_name(b); });
+
+    for (const auto &property : state_properties)
+    {
+        // TODO: Store properties whose values do not have a C type yet, such as strings
+        auto type = get_state_type(property->pattern);
+        if (!type.has_value())
+            continue;
+
+        // A dense array over every combination of several entities would mostly be empty, so
+        // those properties only store the combinations that have been assigned a value
+        auto entities = entities_of(property).value();
+
+        C_StateProperty state_property = {};
+        state_property.storage = entities.size() == 1 ? C_StateProperty::COLUMN : C_StateProperty::SPARSE_MAP;
+        state_property.identity = intern_string(ir, create_identity(property_name(property)));
+        state_property.type = intern_string(ir, type.value());
+        state_property.first_parameter = (C_Index)ir.state_parameters.size();
+        state_property.parameter_count = (C_Index)entities.size();
+        state_property.initial_value.kind = C_Expression::INVALID;
+        ir.state_parameters.insert(ir.state_parameters.end(), entities.begin(), entities.end());
+
+        if (property->initial_value.has_value())
+        {
+            if (auto initial_value = constant_of(property->initial_value.value()))
+            {
+                if (auto literal = convert_constant(initial_value.value()))
+                    state_property.initial_value = literal.value();
+            }
+        }
+
+        // Zero is a valid enum value, so optional enums are explicitly set to `none`
+        if (state_property.initial_value.kind == C_Expression::INVALID && is_optional_enum(property->pattern))
+        {
+            state_property.initial_value.kind = C_Expression::INT_LITERAL;
+            state_property.initial_value.int_value = -1;
+        }
+
+        state_property_indexes[property.get()] = (C_Index)ir.state_properties.size();
+        ir.state_properties.push_back(state_property);
+    }
+}
+
+// Enums are stored as the index of their value, and entities as their id. Optional values use -1
+// and the id 0 to represent `none`. Lists are stored inline, with a fixed capacity.
+optional<string> Converter::get_state_type(const Pattern &pattern)
+{
+    if (IS_PTR(pattern, PatternLiteral))
+        return get_state_type(AS_PTR(pattern, PatternLiteral)->pattern);
+
+    if (IS_PTR(pattern, PrimitiveType))
+    {
+        auto primitive_type = AS_PTR(pattern, PrimitiveType);
+        if (primitive_type == Intrinsic::type_str || primitive_type == Intrinsic::type_none)
+            return {};
+        return primitive_type->cpp_identity;
+    }
+
+    if (IS_PTR(pattern, EnumType))
+        return "int";
+
+    if (IS_PTR(pattern, EntityType))
+        return "GambitEntity";
+
+    // Lists without a fixed size are given the default capacity of the runtime
+    if (IS_PTR(pattern, ListType))
+    {
+        auto list_type = AS_PTR(pattern, ListType);
+        auto item_type = get_state_type(list_type->list_of);
+        if (!item_type.has_value() || item_type.value().rfind("GambitList", 0) == 0)
+            return {};
+
+        string capacity = "GAMBIT_LIST_CAPACITY";
+        if (list_type->fixed_size.has_value())
+        {
+            auto fixed_size = constant_of(list_type->fixed_size.value());
+            auto literal = fixed_size.has_value() ? convert_constant(fixed_size.value()) : nullopt;
+            if (!literal.has_value() || literal.value().kind != C_Expression::INT_LITERAL || literal.value().int_value <= 0)
+                return {};
+            capacity = to_string(literal.value().int_value);
+        }
+
+        return "GambitList < " + item_type.value() + " , " + capacity + " >";
+    }
+
+    // Optional values
+    if (IS_PTR(pattern, UnionPattern))
+    {
+        const auto &patterns = AS_PTR(pattern, UnionPattern)->patterns;
+        optional<string> type;
+        for (const auto &sub_pattern : patterns)
+        {
+            if (IS_PTR(sub_pattern, PrimitiveValue) && AS_PTR(sub_pattern, PrimitiveValue) == Intrinsic::none_val)
+                continue;
+
+            if (type.has_value())
+                return {};
+
+            type = get_state_type(sub_pattern);
+            if (!type.has_value() || (type.value() != "int" && type.value() != "GambitEntity"))
+                return {};
+        }
+        return type;
+    }
+
+    return {};
+}
+
+// Reading a state property with a single entity parameter is an index into its column, and
+// reading one with several is a lookup into its sparse map
+optional<C_Expression> Converter::convert_state_property_access(ptr<PropertyAccess> property_access)
+{
+    if (!IS_PTR(property_access->property, StateProperty) || !IS_PTR(property_access->subject, InstanceList))
+        return {};
+
+    auto it = state_property_indexes.find(AS_PTR(property_access->property, StateProperty).get());
+    if (it == state_property_indexes.end())
+        return {};
+
+    const auto &property = ir.state_properties[it->second];
+    auto instance_list = AS_PTR(property_access->subject, InstanceList);
+    if (instance_list->values.size() != property.parameter_count)
+        return {};
+
+    C_Expression reference = {};
+    reference.kind = C_Expression::STATE_PROPERTY;
+    reference.state_property = it->second;
+
+    C_Expression expr = {};
+    expr.lhs = create_expression(reference);
+
+    if (property.storage == C_StateProperty::COLUMN)
+    {
+        expr.kind = C_Expression::SUB_SCRIPT;
+        expr.rhs = convert_expression(instance_list->values[0]);
+        return expr;
+    }
+
+    C_Index key = convert_expression(instance_list->values[0]);
+    for (size_t i = 1; i < instance_list->values.size(); i++)
+    {
+        C_Expression entity_key = {};
+        entity_key.kind = C_Expression::ENTITY_KEY;
+        entity_key.lhs = key;
+        entity_key.rhs = convert_expression(instance_list->values[i]);
+        key = create_expression(entity_key);
+    }
+
+    expr.kind = C_Expression::STATE_LOOKUP;
+    expr.rhs = key;
+    return expr;
+}
+
+// The state property access that is being written to, if the target of a write is one
+optional<C_Index> Converter::convert_state_write_target(Expression target)
+{
+    while (IS_PTR(target, ExpressionLiteral))
+        target = AS_PTR(target, ExpressionLiteral)->expr;
+
+    if (!IS_PTR(target, PropertyAccess))
+        return {};
+
+    auto state_access = convert_state_property_access(AS_PTR(target, PropertyAccess));
+    if (!state_access.has_value())
+        return {};
+
+    return create_expression(state_access.value());
+}
+
+C_Index Converter::create_statement(C_Statement::Kind kind)
+{
+    if (ir.statements.size() >= C_INDEX_MAX)
+        throw CompilerError("IR has exceeded the maximum number of statements.");
+
+    C_Statement stmt = {};
+    stmt.kind = kind;
+    ir.statements.push_back(stmt);
+    return (C_Index)(ir.statements.size() - 1);
+}
+
+C_Index Converter::create_expression(const C_Expression &expression)
+{
+    if (ir.expressions.size() >= C_INDEX_MAX)
+        throw CompilerError("IR has exceeded the maximum number of expressions.");
+
+    ir.expressions.push_back(expression);
+    return (C_Index)(ir.expressions.size() - 1);
+}
+
+// The match expression that an expression is, if it is one
+static ptr<MatchExpression> as_match_expression(Expression expression)
+{
+    while (IS_PTR(expression, ExpressionLiteral))
+        expression = AS_PTR(expression, ExpressionLiteral)->expr;
+
+    if (IS_PTR(expression, MatchExpression))
+        return AS_PTR(expression, MatchExpression);
+
+    return nullptr;
 }
 
 #define STMT ir.statements.at(stmt)
 
-size_t Converter::convert_statement(Statement apm)
+C_Index Converter::convert_statement(const Statement &apm)
 {
-    auto statement_index = ir.statements.size();
+    TRACE_FUNCTION("Converter");
+
+    auto statement_index = (C_Index)ir.statements.size();
 
-    if (IS_PTR(apm, IfStatement))
+    switch (apm.index())
+    {
+    case INDEX_OF_PTR(Statement, IfStatement):
     {
         auto if_statement = AS_PTR(apm, IfStatement);
 
@@ -74,14 +422,14 @@ size_t Converter::convert_statement(Statement apm)
 
         if (if_statement->else_block.has_value())
         {
-            create_statement(C_Statement::IF_STATEMENT);
+            create_statement(C_Statement::ELSE_STATEMENT);
             convert_statement(if_statement->else_block.value());
         }
 
         return statement_index;
     }
 
-    if (IS_PTR(apm, ForStatement))
+    case INDEX_OF_PTR(Statement, ForStatement):
     {
         auto for_statement = AS_PTR(apm, ForStatement);
         auto stmt = create_statement(C_Statement::FOR_LOOP);
@@ -90,7 +438,7 @@ size_t Converter::convert_statement(Statement apm)
         return statement_index;
     }
 
-    if (IS_PTR(apm, LoopStatement))
+    case INDEX_OF_PTR(Statement, LoopStatement):
     {
         auto loop_statement = AS_PTR(apm, LoopStatement);
         auto stmt = create_statement(C_Statement::WHILE_LOOP);
@@ -98,92 +446,131 @@ size_t Converter::convert_statement(Statement apm)
         return statement_index;
     }
 
-    if (IS_PTR(apm, ReturnStatement))
+    case INDEX_OF_PTR(Statement, ReturnStatement):
     {
         auto return_statement = AS_PTR(apm, ReturnStatement);
+        if (auto match = as_match_expression(return_statement->value))
+        {
+            if (convert_match_to_switch(match, true).has_value())
+                return statement_index;
+        }
+
         auto stmt = create_statement(C_Statement::RETURN_STATEMENT);
         STMT.expression = convert_expression(return_statement->value);
         return statement_index;
     }
 
-    if (IS_PTR(apm, WinsStatement))
+    case INDEX_OF_PTR(Statement, WinsStatement):
     {
         auto wins_statement = AS_PTR(apm, WinsStatement);
-        auto stmt = create_statement(C_Statement::EXPRESSION_STATEMENT);
-        // TODO: Implement
+        auto stmt = create_statement(C_Statement::WINS_STATEMENT);
+        STMT.expression = convert_expression(wins_statement->player);
         return statement_index;
     }
 
-    if (IS_PTR(apm, DrawStatement))
+    case INDEX_OF_PTR(Statement, DrawStatement):
     {
         auto draw_statement = AS_PTR(apm, DrawStatement);
-        auto stmt = create_statement(C_Statement::EXPRESSION_STATEMENT);
-        // TODO: Implement
+        create_statement(C_Statement::DRAW_STATEMENT);
         return statement_index;
     }
 
-    if (IS_PTR(apm, AssignmentStatement))
+    case INDEX_OF_PTR(Statement, AssignmentStatement):
     {
         auto assignment_statement = AS_PTR(apm, AssignmentStatement);
+        auto state_access = convert_state_write_target(assignment_statement->subject);
+
+        // TODO: Implement assignments to variables. Until then they are converted to an invalid
+        //       expression, in the same way as the variables themselves.
+        C_Expression write = {};
+        write.kind = C_Expression::INVALID;
+        if (state_access.has_value())
+        {
+            write.kind = C_Expression::STATE_WRITE;
+            write.lhs = state_access.value();
+            write.rhs = convert_expression(assignment_statement->value);
+        }
+        auto expression = create_expression(write);
+
         auto stmt = create_statement(C_Statement::EXPRESSION_STATEMENT);
-        // TODO: Implement
+        STMT.expression = expression;
         return statement_index;
     }
 
-    if (IS_PTR(apm, VariableDeclaration))
+    case INDEX_OF_PTR(Statement, VariableDeclaration):
     {
         auto variable_declaration = AS_PTR(apm, VariableDeclaration);
+
+        // Constants known at compile time are substituted wherever they are used
+        auto variable = variable_declaration->variable;
+        if (variable->constant_value.has_value())
+        {
+            if (convert_constant(variable->constant_value.value()).has_value() || get_variable_table(variable).has_value())
+                return statement_index;
+        }
+
         auto stmt = create_statement(C_Statement::VARIABLE_DECLARATION);
         // TODO: Implement
         return statement_index;
     }
 
-    if (IS_PTR(apm, CodeBlock))
+    case INDEX_OF_PTR(Statement, CodeBlock):
     {
         auto code_block = AS_PTR(apm, CodeBlock);
         auto stmt = create_statement(C_Statement::CODE_BLOCK);
 
-        for (auto stmt : code_block->statements)
+        for (const auto &stmt : code_block->statements)
         {
             convert_statement(stmt);
         }
 
-        STMT.statement_count = ir.statements.size() - (statement_index + 1);
+        STMT.statement_count = (C_Index)(ir.statements.size() - (statement_index + 1));
         return statement_index;
     }
 
-    if (IS(apm, Expression))
+    case INDEX_OF(Statement, Expression):
     {
         auto expr = AS(apm, Expression);
+        if (auto match = as_match_expression(expr))
+        {
+            if (convert_match_to_switch(match, false).has_value())
+                return statement_index;
+        }
+
         auto stmt = create_statement(C_Statement::EXPRESSION_STATEMENT);
         STMT.expression = convert_expression(expr);
         return statement_index;
     }
+    }
 
     throw CompilerError("Could not convert APM Statement, variant not recognised.");
 }
 
 #undef STMT
 
-size_t Converter::convert_expression(Expression apm)
+C_Index Converter::convert_expression(const Expression &apm)
 {
+    TRACE_FUNCTION("Converter");
+
+    C_Expression expr = {};
+    expr.kind = C_Expression::INVALID;
+
+    switch (apm.index())
+    {
     // Literals
-    if (IS(apm, UnresolvedLiteral))
+    case INDEX_OF(Expression, UnresolvedLiteral):
     {
         throw CompilerError("Attempt to convert APM UnresolvedLiteral");
     }
 
-    if (IS_PTR(apm, ExpressionLiteral))
+    case INDEX_OF_PTR(Expression, ExpressionLiteral):
     {
         auto expression_literal = AS_PTR(apm, ExpressionLiteral);
         return convert_expression(expression_literal->expr);
     }
 
-    C_Expression expr;
-    expr.kind = C_Expression::INVALID;
-
     // Values
-    if (IS_PTR(apm, PrimitiveValue))
+    case INDEX_OF_PTR(Expression, PrimitiveValue):
     {
         auto primitive_value = AS_PTR(apm, PrimitiveValue);
 
@@ -205,34 +592,52 @@ size_t Converter::convert_expression(Expression apm)
         else if (IS(primitive_value->value, string))
         {
             expr.kind = C_Expression::STRING_LITERAL;
-            expr.string_value = AS(primitive_value->value, string);
+            expr.string_value = intern_string(ir, AS(primitive_value->value, string));
         }
         else
         {
             throw CompilerError("Could not convert APM PrimitiveValue.");
         }
+        break;
     }
 
-    if (IS_PTR(apm, ListValue))
+    case INDEX_OF_PTR(Expression, ListValue):
     {
         auto list_value = AS_PTR(apm, ListValue);
         // TODO: Implement
+        break;
     }
 
-    if (IS_PTR(apm, EnumValue))
+    case INDEX_OF_PTR(Expression, EnumValue):
     {
         auto enum_value = AS_PTR(apm, EnumValue);
-        // TODO: Implement
+        if (auto constant = convert_constant(enum_value))
+            expr = constant.value();
+        break;
     }
 
-    if (IS_PTR(apm, Variable))
+    case INDEX_OF_PTR(Expression, Variable):
     {
         auto variable = AS_PTR(apm, Variable);
+        if (variable->constant_value.has_value())
+        {
+            if (auto constant = convert_constant(variable->constant_value.value()))
+            {
+                expr = constant.value();
+            }
+            else if (auto table = get_variable_table(variable))
+            {
+                expr.kind = C_Expression::TABLE_REFERENCE;
+                expr.table = table.value();
+            }
+            break;
+        }
         // TODO: Implement
+        break;
     }
 
     // Operations
-    if (IS_PTR(apm, Unary))
+    case INDEX_OF_PTR(Expression, Unary):
     {
         auto unary = AS_PTR(apm, Unary);
         if (false)
@@ -241,11 +646,24 @@ size_t Converter::convert_expression(Expression apm)
             throw CompilerError("Could not convert Unary " + unary->op);
 
         expr.lhs = convert_expression(unary->value);
+        break;
     }
 
-    if (IS_PTR(apm, Binary))
+    case INDEX_OF_PTR(Expression, Binary):
     {
         auto binary = AS_PTR(apm, Binary);
+        if (binary->op == "insert")
+        {
+            auto state_access = convert_state_write_target(binary->lhs);
+            if (!state_access.has_value())
+                break; // TODO: Implement inserting into lists that are not stored in the state
+
+            expr.kind = C_Expression::STATE_INSERT;
+            expr.lhs = state_access.value();
+            expr.rhs = convert_expression(binary->rhs);
+            break;
+        }
+
         if (binary->op == "+")
             expr.kind = C_Expression::BINARY_ADD;
         else if (binary->op == "-")
@@ -265,72 +683,584 @@ size_t Converter::convert_expression(Expression apm)
 
         expr.lhs = convert_expression(binary->lhs);
         expr.rhs = convert_expression(binary->rhs);
+        break;
     }
 
     // Indexing
-    if (IS_PTR(apm, InstanceList))
+    case INDEX_OF_PTR(Expression, InstanceList):
     {
         auto instance_list = AS_PTR(apm, InstanceList);
         // TODO: Implement
+        break;
     }
 
-    if (IS_PTR(apm, IndexWithExpression))
+    case INDEX_OF_PTR(Expression, IndexWithExpression):
     {
         auto index_with_expression = AS_PTR(apm, IndexWithExpression);
         expr.kind = C_Expression::SUB_SCRIPT;
         expr.lhs = convert_expression(index_with_expression->subject);
         expr.rhs = convert_expression(index_with_expression->index);
+        break;
     }
 
-    if (IS_PTR(apm, IndexWithIdentity))
+    case INDEX_OF_PTR(Expression, IndexWithIdentity):
     {
         throw CompilerError("Attempt to convert IndexWithIdentity expression. This should have already been resolved to a PropertyAccess or EnumValue");
     }
 
     // Calls
-    if (IS_PTR(apm, Call))
+    case INDEX_OF_PTR(Expression, Call):
     {
         auto call = AS_PTR(apm, Call);
         // TODO: Implement
+        break;
     }
 
-    if (IS_PTR(apm, PropertyAccess))
+    case INDEX_OF_PTR(Expression, PropertyAccess):
     {
         auto property_access = AS_PTR(apm, PropertyAccess);
+        if (auto constant = convert_constant_property_access(property_access))
+        {
+            expr = constant.value();
+            break;
+        }
+        if (auto state_access = convert_state_property_access(property_access))
+        {
+            expr = state_access.value();
+            break;
+        }
         // TODO: Implement
+        break;
     }
 
     // Keyword expressions
-    if (IS_PTR(apm, ChooseExpression))
+    case INDEX_OF_PTR(Expression, ChooseExpression):
     {
         auto choose_expression = AS_PTR(apm, ChooseExpression);
-        // TODO: Implement
+
+        // The prompt is only for people, so it is not kept
+        auto choices_pattern = determine_expression_pattern(choose_expression->choices);
+        while (IS_PTR(choices_pattern, PatternLiteral))
+            choices_pattern = AS_PTR(choices_pattern, PatternLiteral)->pattern;
+
+        if (IS_PTR(choices_pattern, ListType))
+        {
+            expr.kind = C_Expression::CHOOSE;
+            expr.lhs = convert_expression(choose_expression->player);
+            expr.rhs = convert_expression(choose_expression->choices);
+            break;
+        }
+
+        // TODO: Implement choosing from types, such as `choose bool`, and from ranges
+        break;
     }
 
     // "Statement style" expressions
-    if (IS_PTR(apm, IfExpression))
+    case INDEX_OF_PTR(Expression, IfExpression):
     {
         auto if_expression = AS_PTR(apm, IfExpression);
         // TODO: Implement
+        break;
     }
 
-    if (IS_PTR(apm, MatchExpression))
+    case INDEX_OF_PTR(Expression, MatchExpression):
     {
         auto match_expression = AS_PTR(apm, MatchExpression);
+        if (auto table_lookup = convert_match_to_table(match_expression))
+        {
+            expr = table_lookup.value();
+            break;
+        }
+
+        // Matches that are not a table become a switch, which is a statement, so there is nothing
+        // they can be converted to here (such as an integer match without an else)
+        if (analyse_match(match_expression).has_value())
+            throw CompilerError("Could not convert MatchExpression, as matches that cannot be looked up in a table can only be used as a statement or returned.", match_expression->span);
+
         // TODO: Implement
+        break;
     }
 
     // Invalid expression
-    if (IS_PTR(apm, InvalidExpression))
+    case INDEX_OF_PTR(Expression, InvalidExpression):
     {
         throw CompilerError("Attempt to convert APM InvalidExpression");
     }
+    }
 
     // TODO: Should error here!
     // if (e.kind == INVALID)
     //     throw CompilerError("Could not convert APM Expression, variant not recognised.");
 
-    auto expression_index = ir.expressions.size();
-    ir.expressions.emplace_back(expr);
-    return expression_index;
-}
\ No newline at end of file
+    return create_expression(expr);
+}
+// CONSTANTS //
+
+// Enums are represented by the index of the value in the enum
+optional<C_Expression> Converter::convert_constant(const Expression &value)
+{
+    C_Expression expr = {};
+
+    if (IS_PTR(value, EnumValue))
+    {
+        auto enum_value = AS_PTR(value, EnumValue);
+        if (!enum_value->type)
+            return {};
+
+        const auto &values = enum_value->type->values;
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            if (values[i] == enum_value)
+            {
+                expr.kind = C_Expression::INT_LITERAL;
+                expr.int_value = (int)i;
+                return expr;
+            }
+        }
+        return {};
+    }
+
+    if (!IS_PTR(value, PrimitiveValue))
+        return {};
+
+    auto primitive_value = AS_PTR(value, PrimitiveValue);
+    if (primitive_value->type == Intrinsic::type_none)
+        return {};
+
+    if (IS(primitive_value->value, double))
+    {
+        expr.kind = C_Expression::DOUBLE_LITERAL;
+        expr.double_value = AS(primitive_value->value, double);
+    }
+    else if (IS(primitive_value->value, int))
+    {
+        expr.kind = C_Expression::INT_LITERAL;
+        expr.int_value = AS(primitive_value->value, int);
+    }
+    else if (IS(primitive_value->value, bool))
+    {
+        expr.kind = C_Expression::BOOL_LITERAL;
+        expr.bool_value = AS(primitive_value->value, bool);
+    }
+    else
+    {
+        expr.kind = C_Expression::STRING_LITERAL;
+        expr.string_value = intern_string(ir, AS(primitive_value->value, string));
+    }
+
+    return expr;
+}
+
+// Tables are either a list of values, or a list of lists of values that are all the same length.
+// Every value must be a literal of the same kind, except that ints are promoted to doubles if the
+// table contains both.
+optional<C_Index> Converter::create_table(string identity, const vector<Expression> &values)
+{
+    if (values.size() == 0)
+        return {};
+
+    vector<Expression> flattened;
+    size_t row_length = 0;
+    if (IS_PTR(values[0], ListValue))
+    {
+        row_length = AS_PTR(values[0], ListValue)->values.size();
+        if (row_length == 0)
+            return {};
+
+        for (const auto &row : values)
+        {
+            if (!IS_PTR(row, ListValue) || AS_PTR(row, ListValue)->values.size() != row_length)
+                return {};
+            const auto &row_values = AS_PTR(row, ListValue)->values;
+            flattened.insert(flattened.end(), row_values.begin(), row_values.end());
+        }
+    }
+    else
+    {
+        flattened = values;
+    }
+
+    vector<C_Expression> literals;
+    bool has_int = false;
+    bool has_double = false;
+    for (const auto &value : flattened)
+    {
+        auto literal = convert_constant(value);
+        if (!literal.has_value())
+            return {};
+
+        auto kind = literal.value().kind;
+        has_int = has_int || kind == C_Expression::INT_LITERAL;
+        has_double = has_double || kind == C_Expression::DOUBLE_LITERAL;
+        literals.push_back(literal.value());
+    }
+
+    for (auto &literal : literals)
+    {
+        if (has_int && has_double && literal.kind == C_Expression::INT_LITERAL)
+        {
+            double value = literal.int_value;
+            literal.kind = C_Expression::DOUBLE_LITERAL;
+            literal.double_value = value;
+        }
+
+        if (literal.kind != literals[0].kind)
+            return {};
+    }
+
+    if (ir.tables.size() >= C_INDEX_MAX || ir.table_values.size() + literals.size() >= C_INDEX_MAX)
+        throw CompilerError("IR has exceeded the maximum number of table values.");
+
+    C_Table table;
+    table.identity = intern_string(ir, create_identity(identity));
+    table.first_value = (C_Index)ir.table_values.size();
+    table.value_count = (C_Index)literals.size();
+    table.row_length = (C_Index)row_length;
+
+    ir.table_values.insert(ir.table_values.end(), literals.begin(), literals.end());
+    ir.tables.push_back(table);
+    return (C_Index)(ir.tables.size() - 1);
+}
+
+// Properties are only looked up in a table if their parameter is a plain enum, so that the index
+// of the argument's enum value is also its index in the table
+optional<C_Index> Converter::get_property_table(ptr<FunctionProperty> property)
+{
+    auto it = property_tables.find(property.get());
+    if (it != property_tables.end())
+        return it->second;
+
+    optional<C_Index> table;
+    const auto &domain = property->constant_domain;
+    if (domain.size() > 0 && IS_PTR(domain[0], EnumValue))
+    {
+        auto enum_type = AS_PTR(domain[0], EnumValue)->type;
+        bool is_enum_domain = enum_type && enum_type->values.size() == domain.size();
+        for (size_t i = 0; is_enum_domain && i < domain.size(); i++)
+            is_enum_domain = IS_PTR(domain[i], EnumValue) && AS_PTR(domain[i], EnumValue) == enum_type->values[i];
+
+        if (is_enum_domain && (property->constant_results.size() == 0 || !IS_PTR(property->constant_results[0], ListValue)))
+            table = create_table(property->identity + "_table", property->constant_results);
+    }
+
+    property_tables[property.get()] = table;
+    return table;
+}
+
+optional<C_Index> Converter::get_variable_table(ptr<Variable> variable)
+{
+    auto it = variable_tables.find(variable.get());
+    if (it != variable_tables.end())
+        return it->second;
+
+    optional<C_Index> table;
+    if (variable->constant_value.has_value() && IS_PTR(variable->constant_value.value(), ListValue))
+        table = create_table(variable->identity, AS_PTR(variable->constant_value.value(), ListValue)->values);
+
+    variable_tables[variable.get()] = table;
+    return table;
+}
+
+// Accessing a property that the Evaluator has tabulated becomes a literal if the argument is
+// known at compile time, otherwise it becomes a lookup into the property's table
+optional<C_Expression> Converter::convert_constant_property_access(ptr<PropertyAccess> property_access)
+{
+    if (!IS_PTR(property_access->property, FunctionProperty))
+        return {};
+
+    auto property = AS_PTR(property_access->property, FunctionProperty);
+    if (property->constant_results.size() == 0 || !IS_PTR(property_access->subject, InstanceList))
+        return {};
+
+    auto instance_list = AS_PTR(property_access->subject, InstanceList);
+    if (instance_list->values.size() != 1)
+        return {};
+
+    auto argument = instance_list->values[0];
+    while (IS_PTR(argument, ExpressionLiteral))
+        argument = AS_PTR(argument, ExpressionLiteral)->expr;
+
+    optional<Expression> argument_value;
+    if (IS_PTR(argument, EnumValue) || IS_PTR(argument, PrimitiveValue))
+        argument_value = argument;
+    else if (IS_PTR(argument, Variable))
+        argument_value = AS_PTR(argument, Variable)->constant_value;
+
+    if (argument_value.has_value())
+    {
+        for (size_t i = 0; i < property->constant_domain.size(); i++)
+        {
+            auto equal = are_constants_equal(property->constant_domain[i], argument_value.value());
+            if (equal.has_value() && equal.value())
+                return convert_constant(property->constant_results[i]);
+        }
+    }
+
+    auto table = get_property_table(property);
+    if (!table.has_value())
+        return {};
+
+    C_Expression reference = {};
+    reference.kind = C_Expression::TABLE_REFERENCE;
+    reference.table = table.value();
+
+    C_Expression expr = {};
+    expr.kind = C_Expression::SUB_SCRIPT;
+    expr.lhs = create_expression(reference);
+    expr.rhs = convert_expression(argument);
+    return expr;
+}
+
+// MATCH EXPRESSIONS //
+
+// Adds the value(s) matched by a rule's pattern to `keys`. Enum values are keyed by their index in
+// `enum_type`, and integers by their value. Returns false if the pattern matches anything else.
+static bool collect_match_keys(Pattern pattern, ptr<EnumType> enum_type, vector<int> &keys)
+{
+    while (IS_PTR(pattern, PatternLiteral))
+        pattern = AS_PTR(pattern, PatternLiteral)->pattern;
+
+    if (IS_PTR(pattern, UnionPattern))
+    {
+        for (const auto &sub_pattern : AS_PTR(pattern, UnionPattern)->patterns)
+        {
+            if (!collect_match_keys(sub_pattern, enum_type, keys))
+                return false;
+        }
+        return true;
+    }
+
+    if (enum_type && IS_PTR(pattern, EnumValue))
+    {
+        auto enum_value = AS_PTR(pattern, EnumValue);
+        const auto &values = enum_type->values;
+        auto it = find(values.begin(), values.end(), enum_value);
+        if (it == values.end())
+            return false;
+
+        keys.push_back((int)(it - values.begin()));
+        return true;
+    }
+
+    if (!enum_type && IS_PTR(pattern, PrimitiveValue))
+    {
+        auto primitive_value = AS_PTR(pattern, PrimitiveValue);
+        if (!IS(primitive_value->value, int))
+            return false;
+
+        keys.push_back(AS(primitive_value->value, int));
+        return true;
+    }
+
+    return false;
+}
+
+// Matches can only be converted if their subject is a plain enum (which are represented by their
+// index) or an integer, and every rule other than the else rule matches specific values
+optional<Converter::MatchCases> Converter::analyse_match(ptr<MatchExpression> match)
+{
+    Pattern subject_pattern = determine_expression_pattern(match->subject);
+    while (IS_PTR(subject_pattern, PatternLiteral))
+        subject_pattern = AS_PTR(subject_pattern, PatternLiteral)->pattern;
+
+    ptr<EnumType> enum_type = nullptr;
+    if (IS_PTR(subject_pattern, EnumType))
+        enum_type = AS_PTR(subject_pattern, EnumType);
+    else if (IS_PTR(subject_pattern, PrimitiveType))
+    {
+        auto primitive_type = AS_PTR(subject_pattern, PrimitiveType);
+        if (primitive_type != Intrinsic::type_int && primitive_type != Intrinsic::type_amt)
+            return {};
+    }
+    else if (!IS_PTR(subject_pattern, PrimitiveValue))
+        return {};
+
+    MatchCases match_cases;
+    match_cases.enum_size = enum_type ? enum_type->values.size() : 0;
+
+    bool has_key = false;
+    for (const auto &rule : match->rules)
+    {
+        if (IS_PTR(rule.pattern, AnyPattern))
+        {
+            match_cases.else_result = rule.result;
+            break;
+        }
+
+        MatchCase match_case;
+        match_case.result = rule.result;
+        if (!collect_match_keys(rule.pattern, enum_type, match_case.keys))
+            return {};
+
+        for (int key : match_case.keys)
+        {
+            match_cases.min_key = has_key ? min(match_cases.min_key, key) : key;
+            match_cases.max_key = has_key ? max(match_cases.max_key, key) : key;
+            has_key = true;
+        }
+
+        match_cases.cases.push_back(match_case);
+    }
+
+    if (!has_key)
+        return {};
+
+    return match_cases;
+}
+
+// The results of the match for each key from the smallest to the largest (or for each value of
+// the enum), if they are all constant and there are no gaps in the table. Integers can be outside
+// of the keys, so integer matches must have an `else`, whose result is added to the end of the
+// table for the lookup to fall back to.
+optional<vector<Expression>> Converter::get_match_table_values(const MatchCases &match_cases)
+{
+    long long min_key = match_cases.enum_size > 0 ? 0 : match_cases.min_key;
+    size_t table_size = match_cases.enum_size;
+
+    if (match_cases.enum_size == 0)
+    {
+        if (!match_cases.else_result.has_value())
+            return {};
+
+        size_t key_count = 0;
+        for (const auto &match_case : match_cases.cases)
+            key_count += match_case.keys.size();
+
+        table_size = (size_t)((long long)match_cases.max_key - match_cases.min_key) + 1;
+        if (table_size > MAX_MATCH_TABLE_SIZE || table_size > key_count * 2)
+            return {};
+    }
+
+    vector<optional<Expression>> slots(table_size);
+    for (const auto &match_case : match_cases.cases)
+    {
+        for (int key : match_case.keys)
+        {
+            // Earlier rules take priority over later ones
+            auto &slot = slots[(size_t)(key - min_key)];
+            if (slot.has_value())
+                continue;
+
+            slot = constant_of(match_case.result);
+            if (!slot.has_value())
+                return {};
+        }
+    }
+
+    optional<Expression> else_value;
+    if (match_cases.else_result.has_value())
+        else_value = constant_of(match_cases.else_result.value());
+
+    vector<Expression> values;
+    for (auto &slot : slots)
+    {
+        if (!slot.has_value())
+            slot = else_value;
+        if (!slot.has_value())
+            return {};
+        values.push_back(slot.value());
+    }
+
+    if (match_cases.enum_size == 0)
+        values.push_back(else_value.value());
+
+    return values;
+}
+
+optional<C_Expression> Converter::convert_match_to_table(ptr<MatchExpression> match)
+{
+    auto match_cases = analyse_match(match);
+    if (!match_cases.has_value())
+        return {};
+
+    auto values = get_match_table_values(match_cases.value());
+    if (!values.has_value())
+        return {};
+
+    auto table = create_table("match_table", values.value());
+    if (!table.has_value())
+        return {};
+
+    C_Expression reference = {};
+    reference.kind = C_Expression::TABLE_REFERENCE;
+    reference.table = table.value();
+
+    // Enum subjects are always within the table, but integers are checked by the lookup
+    bool is_enum = match_cases.value().enum_size > 0;
+    C_Expression expr = {};
+    expr.kind = is_enum ? C_Expression::SUB_SCRIPT : C_Expression::MATCH_LOOKUP;
+    expr.lhs = create_expression(reference);
+    expr.rhs = convert_expression(match->subject);
+
+    int min_key = is_enum ? 0 : match_cases.value().min_key;
+    if (min_key != 0)
+    {
+        C_Expression offset = {};
+        offset.kind = C_Expression::INT_LITERAL;
+        offset.int_value = min_key;
+
+        C_Expression index = {};
+        index.kind = C_Expression::BINARY_SUB;
+        index.lhs = expr.rhs;
+        index.rhs = create_expression(offset);
+        expr.rhs = create_expression(index);
+    }
+
+    return expr;
+}
+
+// Matches used as a statement, or as the value of a return statement, become a switch statement
+// if they cannot be converted to a table. The result of each case is either evaluated as an
+// expression statement, or returned.
+optional<C_Index> Converter::convert_match_to_switch(ptr<MatchExpression> match, bool return_result)
+{
+    auto match_cases = analyse_match(match);
+    if (!match_cases.has_value() || get_match_table_values(match_cases.value()).has_value())
+        return {};
+
+    auto statement_index = (C_Index)ir.statements.size();
+
+    auto switch_stmt = create_statement(C_Statement::SWITCH_STATEMENT);
+    ir.statements[switch_stmt].expression = convert_expression(match->subject);
+
+    auto block = create_statement(C_Statement::CODE_BLOCK);
+
+    auto convert_result = [&](const Expression &result)
+    {
+        auto stmt = create_statement(return_result
+                                         ? C_Statement::RETURN_STATEMENT
+                                         : C_Statement::EXPRESSION_STATEMENT);
+        ir.statements[stmt].expression = convert_expression(result);
+
+        if (!return_result)
+            create_statement(C_Statement::BREAK_STATEMENT);
+    };
+
+    // Earlier rules take priority over later ones, and C does not allow a case to be repeated
+    unordered_set<int> keys_used;
+    for (const auto &match_case : match_cases.value().cases)
+    {
+        bool has_label = false;
+        for (int key : match_case.keys)
+        {
+            if (!keys_used.insert(key).second)
+                continue;
+
+            auto label = create_statement(C_Statement::CASE_LABEL);
+            ir.statements[label].case_value = key;
+            has_label = true;
+        }
+
+        if (has_label)
+            convert_result(match_case.result);
+    }
+
+    if (match_cases.value().else_result.has_value())
+    {
+        create_statement(C_Statement::DEFAULT_LABEL);
+        convert_result(match_cases.value().else_result.value());
+    }
+
+    ir.statements[block].statement_count = (C_Index)(ir.statements.size() - (block + 1));
+    return statement_index;
+}
@@ -2,6 +2,8 @@
 #ifndef CONVERTER_H
 #define CONVERTER_H
 
+#include <optional>
+#include <unordered_map>
 #include <unordered_set>
 #include "apm.h"
 #include "ir.h"
@@ -21,9 +23,57 @@ private:
 
     void convert_procedure(ptr<Procedure> procedure);
 
-    size_t create_statement(C_Statement::Kind kind);
-    size_t convert_statement(Statement statement);
-    size_t convert_expression(Expression expression);
+    // ENTITIES AND STATE //
+    unordered_map<EntityType *, C_Index> entity_indexes;
+    unordered_map<StateProperty *, C_Index> state_property_indexes;
+
+    void convert_state(ptr<Program> program);
+    optional<string> get_state_type(const Pattern &pattern);
+    optional<C_Expression> convert_state_property_access(ptr<PropertyAccess> property_access);
+    optional<C_Index> convert_state_write_target(Expression target);
+
+    C_Index create_statement(C_Statement::Kind kind);
+    C_Index create_expression(const C_Expression &expression);
+    C_Index convert_statement(const Statement &statement);
+    C_Index convert_expression(const Expression &expression);
+
+    // CONSTANTS //
+    // Values computed by the Evaluator are converted to literals, or to static tables
+    unordered_map<FunctionProperty *, optional<C_Index>> property_tables;
+    unordered_map<Variable *, optional<C_Index>> variable_tables;
+
+    optional<C_Expression> convert_constant(const Expression &value);
+    optional<C_Index> create_table(string identity, const vector<Expression> &values);
+    optional<C_Index> get_property_table(ptr<FunctionProperty> property);
+    optional<C_Index> get_variable_table(ptr<Variable> variable);
+    optional<C_Expression> convert_constant_property_access(ptr<PropertyAccess> property_access);
+
+    // MATCH EXPRESSIONS //
+    // Matches over an enum or an integer, where every rule matches constant values, are converted
+    // to a lookup into a static table if all of the results are constant, and otherwise to a switch
+    struct MatchCase
+    {
+        vector<int> keys;
+        Expression result;
+    };
+
+    struct MatchCases
+    {
+        vector<MatchCase> cases;
+        optional<Expression> else_result;
+        size_t enum_size = 0; // 0 if the subject is an integer
+        int min_key = 0;
+        int max_key = 0;
+    };
+
+    // Matches over an integer are only converted to a table if the range of their keys is no
+    // larger than this, and at least half of the keys in that range are matched
+    static constexpr size_t MAX_MATCH_TABLE_SIZE = 1024;
+
+    optional<MatchCases> analyse_match(ptr<MatchExpression> match);
+    optional<vector<Expression>> get_match_table_values(const MatchCases &match_cases);
+    optional<C_Expression> convert_match_to_table(ptr<MatchExpression> match);
+    optional<C_Index> convert_match_to_switch(ptr<MatchExpression> match, bool return_result);
 };
 
 #endif
\ No newline at end of file
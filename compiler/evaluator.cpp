@@ -0,0 +1,581 @@
+#include "errors.h"
+#include "evaluator.h"
+#include "intrinsic.h"
+#include "trace.h"
+#include <limits>
+
+void Evaluator::evaluate(ptr<Program> program)
+{
+    TRACE_FUNCTION("Evaluator");
+
+    evaluate_scope(program->global_scope);
+}
+
+// PROGRAM STRUCTURE //
+
+void Evaluator::evaluate_scope(ptr<Scope> scope)
+{
+    for (const auto &index : scope->lookup)
+        evaluate_scope_lookup_value(index.second);
+}
+
+void Evaluator::evaluate_scope_lookup_value(Scope::LookupValue value)
+{
+    if (IS_PTR(value, Scope::OverloadedIdentity))
+    {
+        auto overloaded_identity = AS_PTR(value, Scope::OverloadedIdentity);
+        for (auto overload : overloaded_identity->overloads)
+            evaluate_scope_lookup_value(overload);
+    }
+
+    else if (IS_PTR(value, Procedure))
+    {
+        auto proc = AS_PTR(value, Procedure);
+        TRACE_FUNCTION_DETAIL("Evaluator", proc->identity);
+        evaluate_code_block(proc->body);
+    }
+
+    else if (IS_PTR(value, FunctionProperty))
+    {
+        auto funct = AS_PTR(value, FunctionProperty);
+        TRACE_FUNCTION_DETAIL("Evaluator", funct->identity);
+        tabulate_function_property(funct);
+        if (funct->body.has_value())
+            evaluate_code_block(funct->body.value());
+    }
+}
+
+void Evaluator::evaluate_code_block(ptr<CodeBlock> code_block)
+{
+    for (const auto &stmt : code_block->statements)
+        evaluate_statement(stmt);
+}
+
+// Walks the statements looking for constant declarations. Constants are evaluated in the order
+// they are declared, so a constant can be used in the value of the constants that come after it.
+void Evaluator::evaluate_statement(const Statement &stmt)
+{
+    switch (stmt.index())
+    {
+    case INDEX_OF_PTR(Statement, IfStatement):
+    {
+        auto if_statement = AS_PTR(stmt, IfStatement);
+        for (const auto &rule : if_statement->rules)
+            evaluate_code_block(rule.code_block);
+        if (if_statement->else_block.has_value())
+            evaluate_code_block(if_statement->else_block.value());
+        break;
+    }
+
+    case INDEX_OF_PTR(Statement, ForStatement):
+        evaluate_code_block(AS_PTR(stmt, ForStatement)->body);
+        break;
+
+    case INDEX_OF_PTR(Statement, LoopStatement):
+        evaluate_code_block(AS_PTR(stmt, LoopStatement)->body);
+        break;
+
+    case INDEX_OF_PTR(Statement, CodeBlock):
+        evaluate_code_block(AS_PTR(stmt, CodeBlock));
+        break;
+
+    case INDEX_OF_PTR(Statement, VariableDeclaration):
+    {
+        auto declaration = AS_PTR(stmt, VariableDeclaration);
+        if (declaration->variable->is_constant && declaration->value.has_value())
+        {
+            auto value = evaluate_expression(declaration->value.value());
+            if (value.has_value())
+                declaration->variable->constant_value = value.value();
+        }
+        break;
+    }
+
+    default:
+        break;
+    }
+}
+
+// FUNCTION PROPERTIES //
+
+// Function properties can use each other, so they are tabulated on demand. A property that
+// (directly or indirectly) uses itself is not treated as constant.
+bool Evaluator::tabulate_function_property(ptr<FunctionProperty> funct)
+{
+    auto it = table_states.find(funct.get());
+    if (it != table_states.end())
+        return it->second == TableState::Evaluated;
+
+    table_states[funct.get()] = TableState::InProgress;
+    auto not_constant = [&]()
+    {
+        table_states[funct.get()] = TableState::NotConstant;
+        return false;
+    };
+
+    // Only bodies that consist of a single expression are supported for now
+    if (funct->parameters.size() != 1 || !funct->body.has_value())
+        return not_constant();
+
+    auto body = funct->body.value();
+    if (body->statements.size() != 1 || !IS(body->statements[0], Expression))
+        return not_constant();
+
+    auto parameter = funct->parameters[0];
+    auto domain = enumerate_pattern(parameter->pattern);
+    if (!domain.has_value() || domain.value().size() == 0)
+        return not_constant();
+
+    // The arguments of any property that is currently being tabulated remain bound while this
+    // one is evaluated, as the body of this property cannot refer to the parameters of another.
+    vector<Expression> results;
+    for (const auto &argument : domain.value())
+    {
+        arguments[parameter.get()] = argument;
+        auto result = evaluate_expression(AS(body->statements[0], Expression));
+        if (!result.has_value())
+        {
+            arguments.erase(parameter.get());
+            return not_constant();
+        }
+        results.push_back(result.value());
+    }
+    arguments.erase(parameter.get());
+
+    funct->constant_domain = move(domain.value());
+    funct->constant_results = move(results);
+    table_states[funct.get()] = TableState::Evaluated;
+    return true;
+}
+
+optional<vector<Expression>> Evaluator::enumerate_pattern(const Pattern &pattern)
+{
+    switch (pattern.index())
+    {
+    case INDEX_OF_PTR(Pattern, PatternLiteral):
+        return enumerate_pattern(AS_PTR(pattern, PatternLiteral)->pattern);
+
+    case INDEX_OF_PTR(Pattern, PrimitiveValue):
+        return vector<Expression>{AS_PTR(pattern, PrimitiveValue)};
+
+    case INDEX_OF_PTR(Pattern, EnumValue):
+        return vector<Expression>{AS_PTR(pattern, EnumValue)};
+
+    case INDEX_OF_PTR(Pattern, EnumType):
+    {
+        vector<Expression> values;
+        for (const auto &value : AS_PTR(pattern, EnumType)->values)
+            values.push_back(value);
+        return values;
+    }
+
+    case INDEX_OF_PTR(Pattern, UnionPattern):
+    {
+        vector<Expression> values;
+        for (const auto &sub_pattern : AS_PTR(pattern, UnionPattern)->patterns)
+        {
+            auto sub_values = enumerate_pattern(sub_pattern);
+            if (!sub_values.has_value())
+                return {};
+            values.insert(values.end(), sub_values.value().begin(), sub_values.value().end());
+            if (values.size() > MAX_DOMAIN_SIZE)
+                return {};
+        }
+        return values;
+    }
+
+    default:
+        return {};
+    }
+}
+
+// EXPRESSIONS //
+// Each of these methods returns the value of the expression (as a PrimitiveValue, EnumValue,
+// or a ListValue of values), or nullopt if the value cannot be determined at compile time.
+
+static ptr<PrimitiveValue> create_primitive_value(variant<double, int, bool, string> value)
+{
+    auto primitive_value = CREATE(PrimitiveValue);
+    primitive_value->value = value;
+    if (IS(value, double))
+        primitive_value->type = Intrinsic::type_num;
+    else if (IS(value, int))
+        primitive_value->type = Intrinsic::type_int;
+    else if (IS(value, bool))
+        primitive_value->type = Intrinsic::type_bool;
+    else
+        primitive_value->type = Intrinsic::type_str;
+    return primitive_value;
+}
+
+static bool is_none(const ptr<PrimitiveValue> &value)
+{
+    return value->type == Intrinsic::type_none;
+}
+
+static optional<ptr<PrimitiveValue>> as_primitive(const Expression &value)
+{
+    if (!IS_PTR(value, PrimitiveValue) || is_none(AS_PTR(value, PrimitiveValue)))
+        return {};
+    return AS_PTR(value, PrimitiveValue);
+}
+
+static optional<bool> as_bool(const Expression &value)
+{
+    auto primitive = as_primitive(value);
+    if (!primitive.has_value() || !IS(primitive.value()->value, bool))
+        return {};
+    return AS(primitive.value()->value, bool);
+}
+
+optional<bool> are_constants_equal(const Expression &a, const Expression &b)
+{
+    if (IS_PTR(a, EnumValue) || IS_PTR(b, EnumValue))
+        return IS_PTR(a, EnumValue) && IS_PTR(b, EnumValue) && AS_PTR(a, EnumValue) == AS_PTR(b, EnumValue);
+
+    if (IS_PTR(a, PrimitiveValue) && IS_PTR(b, PrimitiveValue))
+    {
+        auto lhs = AS_PTR(a, PrimitiveValue);
+        auto rhs = AS_PTR(b, PrimitiveValue);
+
+        if (is_none(lhs) || is_none(rhs))
+            return is_none(lhs) && is_none(rhs);
+
+        bool lhs_number = IS(lhs->value, int) || IS(lhs->value, double);
+        bool rhs_number = IS(rhs->value, int) || IS(rhs->value, double);
+        if (lhs_number && rhs_number)
+        {
+            double l = IS(lhs->value, int) ? AS(lhs->value, int) : AS(lhs->value, double);
+            double r = IS(rhs->value, int) ? AS(rhs->value, int) : AS(rhs->value, double);
+            return l == r;
+        }
+
+        return lhs->value == rhs->value;
+    }
+
+    if (IS_PTR(a, ListValue) && IS_PTR(b, ListValue))
+    {
+        const auto &lhs = AS_PTR(a, ListValue)->values;
+        const auto &rhs = AS_PTR(b, ListValue)->values;
+        if (lhs.size() != rhs.size())
+            return false;
+
+        for (size_t i = 0; i < lhs.size(); i++)
+        {
+            auto equal = are_constants_equal(lhs[i], rhs[i]);
+            if (!equal.has_value() || !equal.value())
+                return equal;
+        }
+        return true;
+    }
+
+    return {};
+}
+
+optional<Expression> Evaluator::evaluate_expression(const Expression &expression)
+{
+    switch (expression.index())
+    {
+    case INDEX_OF_PTR(Expression, ExpressionLiteral):
+        return evaluate_expression(AS_PTR(expression, ExpressionLiteral)->expr);
+
+    case INDEX_OF_PTR(Expression, PrimitiveValue):
+    case INDEX_OF_PTR(Expression, EnumValue):
+        return expression;
+
+    case INDEX_OF_PTR(Expression, ListValue):
+    {
+        auto list = CREATE(ListValue);
+        for (const auto &value : AS_PTR(expression, ListValue)->values)
+        {
+            auto evaluated = evaluate_expression(value);
+            if (!evaluated.has_value())
+                return {};
+            list->values.push_back(evaluated.value());
+        }
+        return list;
+    }
+
+    case INDEX_OF_PTR(Expression, Variable):
+    {
+        auto variable = AS_PTR(expression, Variable);
+        auto it = arguments.find(variable.get());
+        if (it != arguments.end())
+            return it->second;
+        return variable->constant_value;
+    }
+
+    case INDEX_OF_PTR(Expression, Unary):
+        return evaluate_unary(AS_PTR(expression, Unary));
+
+    case INDEX_OF_PTR(Expression, Binary):
+        return evaluate_binary(AS_PTR(expression, Binary));
+
+    case INDEX_OF_PTR(Expression, InstanceList):
+    {
+        auto instance_list = AS_PTR(expression, InstanceList);
+        if (instance_list->values.size() != 1)
+            return {};
+        return evaluate_expression(instance_list->values[0]);
+    }
+
+    // Lists are indexed from 1
+    case INDEX_OF_PTR(Expression, IndexWithExpression):
+    {
+        auto index_with_expression = AS_PTR(expression, IndexWithExpression);
+        auto subject = evaluate_expression(index_with_expression->subject);
+        auto index = evaluate_expression(index_with_expression->index);
+        if (!subject.has_value() || !index.has_value() || !IS_PTR(subject.value(), ListValue))
+            return {};
+
+        auto primitive = as_primitive(index.value());
+        if (!primitive.has_value() || !IS(primitive.value()->value, int))
+            return {};
+
+        const auto &values = AS_PTR(subject.value(), ListValue)->values;
+        int i = AS(primitive.value()->value, int);
+        if (i < 1 || (size_t)i > values.size())
+            return {};
+        return values[i - 1];
+    }
+
+    case INDEX_OF_PTR(Expression, PropertyAccess):
+        return evaluate_property_access(AS_PTR(expression, PropertyAccess));
+
+    case INDEX_OF_PTR(Expression, IfExpression):
+        return evaluate_if_expression(AS_PTR(expression, IfExpression));
+
+    case INDEX_OF_PTR(Expression, MatchExpression):
+        return evaluate_match(AS_PTR(expression, MatchExpression));
+
+    default:
+        return {};
+    }
+}
+
+optional<Expression> Evaluator::evaluate_unary(ptr<Unary> unary)
+{
+    auto value = evaluate_expression(unary->value);
+    if (!value.has_value())
+        return {};
+
+    auto primitive = as_primitive(value.value());
+    if (!primitive.has_value())
+        return {};
+
+    const auto &operand = primitive.value()->value;
+
+    if (unary->op == "not" && IS(operand, bool))
+        return create_primitive_value(!AS(operand, bool));
+
+    if (unary->op == "-" && IS(operand, int))
+        return create_primitive_value(-AS(operand, int));
+
+    if (unary->op == "-" && IS(operand, double))
+        return create_primitive_value(-AS(operand, double));
+
+    if (unary->op == "+" && (IS(operand, int) || IS(operand, double)))
+        return value;
+
+    return {};
+}
+
+// NOTE: Arithmetic follows the semantics of the generated C code, so integer division truncates.
+//       Operations that would be undefined behaviour in C are not evaluated.
+optional<Expression> Evaluator::evaluate_binary(ptr<Binary> binary)
+{
+    const auto &op = binary->op;
+
+    // `and` and `or` only evaluate their right hand side if they need to
+    if (op == "and" || op == "or")
+    {
+        auto lhs = evaluate_expression(binary->lhs);
+        auto lhs_bool = lhs.has_value() ? as_bool(lhs.value()) : nullopt;
+        if (!lhs_bool.has_value())
+            return {};
+
+        if (lhs_bool.value() == (op == "or"))
+            return lhs;
+
+        auto rhs = evaluate_expression(binary->rhs);
+        if (!rhs.has_value() || !as_bool(rhs.value()).has_value())
+            return {};
+        return rhs;
+    }
+
+    auto lhs = evaluate_expression(binary->lhs);
+    if (!lhs.has_value())
+        return {};
+    auto rhs = evaluate_expression(binary->rhs);
+    if (!rhs.has_value())
+        return {};
+
+    if (op == "==" || op == "!=")
+    {
+        auto equal = are_constants_equal(lhs.value(), rhs.value());
+        if (!equal.has_value())
+            return {};
+        return create_primitive_value(equal.value() == (op == "=="));
+    }
+
+    auto lhs_primitive = as_primitive(lhs.value());
+    auto rhs_primitive = as_primitive(rhs.value());
+    if (!lhs_primitive.has_value() || !rhs_primitive.has_value())
+        return {};
+
+    const auto &a = lhs_primitive.value()->value;
+    const auto &b = rhs_primitive.value()->value;
+
+    if (IS(a, int) && IS(b, int))
+    {
+        long long x = AS(a, int);
+        long long y = AS(b, int);
+        long long result;
+
+        if (op == "+")
+            result = x + y;
+        else if (op == "-")
+            result = x - y;
+        else if (op == "*")
+            result = x * y;
+        else if (op == "/" && y != 0)
+            result = x / y;
+        else if (op == "<")
+            return create_primitive_value(x < y);
+        else if (op == "<=")
+            return create_primitive_value(x <= y);
+        else if (op == ">")
+            return create_primitive_value(x > y);
+        else if (op == ">=")
+            return create_primitive_value(x >= y);
+        else
+            return {};
+
+        if (result < numeric_limits<int>::min() || result > numeric_limits<int>::max())
+            return {};
+        return create_primitive_value((int)result);
+    }
+
+    bool a_number = IS(a, int) || IS(a, double);
+    bool b_number = IS(b, int) || IS(b, double);
+    if (a_number && b_number)
+    {
+        double x = IS(a, int) ? AS(a, int) : AS(a, double);
+        double y = IS(b, int) ? AS(b, int) : AS(b, double);
+
+        if (op == "+")
+            return create_primitive_value(x + y);
+        if (op == "-")
+            return create_primitive_value(x - y);
+        if (op == "*")
+            return create_primitive_value(x * y);
+        if (op == "/" && y != 0)
+            return create_primitive_value(x / y);
+        if (op == "<")
+            return create_primitive_value(x < y);
+        if (op == "<=")
+            return create_primitive_value(x <= y);
+        if (op == ">")
+            return create_primitive_value(x > y);
+        if (op == ">=")
+            return create_primitive_value(x >= y);
+    }
+
+    return {};
+}
+
+optional<Expression> Evaluator::evaluate_property_access(ptr<PropertyAccess> property_access)
+{
+    if (!IS_PTR(property_access->property, FunctionProperty))
+        return {};
+
+    auto funct = AS_PTR(property_access->property, FunctionProperty);
+    if (!tabulate_function_property(funct))
+        return {};
+
+    auto argument = evaluate_expression(property_access->subject);
+    if (!argument.has_value())
+        return {};
+
+    for (size_t i = 0; i < funct->constant_domain.size(); i++)
+    {
+        auto equal = are_constants_equal(funct->constant_domain[i], argument.value());
+        if (!equal.has_value())
+            return {};
+        if (equal.value())
+            return funct->constant_results[i];
+    }
+
+    return {};
+}
+
+optional<Expression> Evaluator::evaluate_if_expression(ptr<IfExpression> if_expression)
+{
+    for (const auto &rule : if_expression->rules)
+    {
+        auto condition = evaluate_expression(rule.condition);
+        auto condition_bool = condition.has_value() ? as_bool(condition.value()) : nullopt;
+        if (!condition_bool.has_value())
+            return {};
+
+        if (condition_bool.value())
+            return evaluate_expression(rule.result);
+    }
+
+    return {};
+}
+
+optional<Expression> Evaluator::evaluate_match(ptr<MatchExpression> match)
+{
+    auto subject = evaluate_expression(match->subject);
+    if (!subject.has_value())
+        return {};
+
+    for (const auto &rule : match->rules)
+    {
+        auto matches = does_value_match_pattern(subject.value(), rule.pattern);
+        if (!matches.has_value())
+            return {};
+
+        if (matches.value())
+            return evaluate_expression(rule.result);
+    }
+
+    return {};
+}
+
+// Returns nullopt if it cannot be determined at compile time whether the value matches
+optional<bool> Evaluator::does_value_match_pattern(const Expression &value, const Pattern &pattern)
+{
+    switch (pattern.index())
+    {
+    case INDEX_OF_PTR(Pattern, PatternLiteral):
+        return does_value_match_pattern(value, AS_PTR(pattern, PatternLiteral)->pattern);
+
+    case INDEX_OF_PTR(Pattern, AnyPattern):
+        return true;
+
+    case INDEX_OF_PTR(Pattern, UnionPattern):
+    {
+        for (const auto &sub_pattern : AS_PTR(pattern, UnionPattern)->patterns)
+        {
+            auto matches = does_value_match_pattern(value, sub_pattern);
+            if (!matches.has_value() || matches.value())
+                return matches;
+        }
+        return false;
+    }
+
+    case INDEX_OF_PTR(Pattern, PrimitiveValue):
+        return are_constants_equal(value, AS_PTR(pattern, PrimitiveValue));
+
+    case INDEX_OF_PTR(Pattern, EnumValue):
+        return are_constants_equal(value, AS_PTR(pattern, EnumValue));
+
+    case INDEX_OF_PTR(Pattern, EnumType):
+        return IS_PTR(value, EnumValue) && AS_PTR(value, EnumValue)->type == AS_PTR(pattern, EnumType);
+
+    default:
+        return {};
+    }
+}
@@ -0,0 +1,71 @@
+/*
+evaluator.h
+
+Evaluates parts of the program that are known at compile time, after the Checker has run.
+
+Constant declarations (`x :: value`) whose value can be evaluated are given a `constant_value`.
+
+Function properties with a single parameter whose pattern has a finite number of values (such
+as an enum), and whose body only depends on that parameter, are evaluated for every possible
+argument. The results are stored on the property as a table, which the Converter turns into a
+static lookup array rather than a function that is called at runtime.
+
+Anything that cannot be evaluated (such as state, choices, or expressions the evaluator does
+not understand) is left alone, and is compiled as it would have been otherwise.
+*/
+
+#pragma once
+#ifndef EVALUATOR_H
+#define EVALUATOR_H
+
+#include "apm.h"
+#include "utilty.h"
+#include <optional>
+#include <unordered_map>
+#include <vector>
+using namespace std;
+
+class Evaluator
+{
+public:
+    void evaluate(ptr<Program> program);
+
+private:
+    // Larger domains are left to be computed at runtime
+    static constexpr size_t MAX_DOMAIN_SIZE = 1024;
+
+    enum class TableState
+    {
+        InProgress,
+        Evaluated,
+        NotConstant,
+    };
+
+    unordered_map<FunctionProperty *, TableState> table_states;
+    unordered_map<Variable *, Expression> arguments;
+
+    // PROGRAM STRUCTURE //
+    void evaluate_scope(ptr<Scope> scope);
+    void evaluate_scope_lookup_value(Scope::LookupValue value);
+    void evaluate_code_block(ptr<CodeBlock> code_block);
+    void evaluate_statement(const Statement &statement);
+
+    // FUNCTION PROPERTIES //
+    bool tabulate_function_property(ptr<FunctionProperty> funct);
+    optional<vector<Expression>> enumerate_pattern(const Pattern &pattern);
+
+    // EXPRESSIONS //
+    optional<Expression> evaluate_expression(const Expression &expression);
+    optional<Expression> evaluate_unary(ptr<Unary> unary);
+    optional<Expression> evaluate_binary(ptr<Binary> binary);
+    optional<Expression> evaluate_property_access(ptr<PropertyAccess> property_access);
+    optional<Expression> evaluate_if_expression(ptr<IfExpression> if_expression);
+    optional<Expression> evaluate_match(ptr<MatchExpression> match);
+
+    optional<bool> does_value_match_pattern(const Expression &value, const Pattern &pattern);
+};
+
+// Whether two evaluated values are equal, or nullopt if they cannot be compared
+[[nodiscard]] optional<bool> are_constants_equal(const Expression &a, const Expression &b);
+
+#endif
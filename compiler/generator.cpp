@@ -1,71 +1,540 @@
 #include "json.h"
 #include "errors.h"
 #include "generator.h"
+#include "trace.h"
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
 
-string Generator::generate(C_Program representation)
+Generator::Generator(size_t thread_count)
 {
-    ir = representation;
-    generate_program(representation);
-    return source;
+    if (thread_count > 1)
+        pool = make_unique<ThreadPool>(thread_count);
 }
 
-void Generator::write(string token)
+string Generator::generate(const C_Program &representation)
 {
-    source += token + " ";
+    TRACE_FUNCTION("Generator");
+
+    ir = &representation;
+    output = nullptr;
+    buffer.clear();
+    flushed_mid_line = false;
+
+    // The generated source is usually around ten bytes per IR node
+    buffer.reserve(16 * (representation.statements.size() + representation.expressions.size()) + 256);
+
+    generate_program();
+    return move(buffer);
+}
+
+void Generator::generate(const C_Program &representation, ostream &output)
+{
+    TRACE_FUNCTION("Generator");
+
+    ir = &representation;
+    this->output = &output;
+    buffer.clear();
+    flushed_mid_line = false;
+    buffer.reserve(FLUSH_SIZE + 1024);
+
+    generate_program();
+    flush();
+    this->output = nullptr;
+}
+
+void Generator::write(string_view token)
+{
+    buffer.append(token);
+    buffer.push_back(' ');
+
+    if (output && buffer.size() >= FLUSH_SIZE)
+        flush();
+}
+
+// Preprocessor directives must be on a line of their own, whatever was written before them
+void Generator::write_directive(string_view directive)
+{
+    bool at_line_start = buffer.empty() ? !flushed_mid_line : buffer.back() == '\n';
+    if (!at_line_start)
+        buffer.push_back('\n');
+    buffer.append(directive);
+    buffer.push_back('\n');
+
+    if (output && buffer.size() >= FLUSH_SIZE)
+        flush();
+}
+
+void Generator::write(int value)
+{
+    char digits[16];
+    auto result = to_chars(digits, digits + sizeof digits, value);
+    write(string_view(digits, result.ptr - digits));
+}
+
+// NOTE: Doubles are written in the same format as `to_string(double)`
+void Generator::write(double value)
+{
+    char digits[512];
+    int length = snprintf(digits, sizeof digits, "%f", value);
+    write(string_view(digits, length));
+}
+
+// Appends source code that has already been generated, such as by another Generator
+void Generator::append(string_view source)
+{
+    if (output && buffer.size() + source.size() >= FLUSH_SIZE)
+    {
+        flush();
+        output->write(source.data(), source.size());
+        if (!source.empty())
+            flushed_mid_line = source.back() != '\n';
+        return;
+    }
+
+    buffer.append(source);
+}
+
+void Generator::flush()
+{
+    if (!output)
+        return;
+
+    output->write(buffer.data(), buffer.size());
+    if (!buffer.empty())
+        flushed_mid_line = buffer.back() != '\n';
+    buffer.clear();
+}
+
+void Generator::generate_program()
+{
+    TRACE_FUNCTION("Generator");
+
+    generate_preamble();
+    generate_tables();
+    generate_state();
+    generate_batch_state();
+    generate_forward_declarations();
+
+    // Function declarations
+    if (!pool || ir->functions.size() < 2)
+    {
+        for (const auto &funct : ir->functions)
+        {
+            generate_function_declaration(funct);
+        }
+        return;
+    }
+
+    // Functions are split into contiguous groups, so that concatenating the groups in order
+    // gives the same output as generating every function in turn. There are several groups
+    // per thread so that threads that finish early can pick up the remaining work.
+    size_t group_count = min(ir->functions.size(), pool->thread_count() * 4);
+    vector<vector<const C_Function *>> groups(group_count);
+    for (size_t i = 0; i < ir->functions.size(); i++)
+        groups[i * group_count / ir->functions.size()].push_back(&ir->functions[i]);
+
+    for (const auto &source : generate_function_groups(groups))
+        append(source);
 }
 
-void Generator::generate_program(C_Program program)
+void Generator::generate_preamble()
 {
     // Includes
-    write("#include <cstddef>\n");
-    write("#include <stdbool.h>\n");
-    write("#include <string>\n");
+    write_directive("#include <cstddef>");
+    write_directive("#include <stdbool.h>");
+    write_directive("#include <string>");
+
+    // Gambit runtime
+    write_directive("#include \"gambit.h\"");
+}
+
+void Generator::generate_tables()
+{
+    for (const auto &table : ir->tables)
+    {
+        write("static const");
+        switch (ir->table_values.at(table.first_value).kind)
+        {
+        case C_Expression::DOUBLE_LITERAL:
+            write("double");
+            break;
+        case C_Expression::INT_LITERAL:
+            write("int");
+            break;
+        case C_Expression::BOOL_LITERAL:
+            write("bool");
+            break;
+        case C_Expression::STRING_LITERAL:
+            write("char *");
+            break;
+        default:
+            throw CompilerError("Could not generate table of C_Expression " + to_string((int)ir->table_values[table.first_value].kind));
+        }
+
+        write(ir->strings[table.identity]);
+        if (table.row_length > 0)
+        {
+            write("[");
+            write((int)(table.value_count / table.row_length));
+            write("][");
+            write((int)table.row_length);
+            write("]");
+        }
+        else
+        {
+            write("[");
+            write((int)table.value_count);
+            write("]");
+        }
+
+        write("= {");
+        for (C_Index i = 0; i < table.value_count; i++)
+        {
+            if (i > 0)
+                write(",");
+            if (table.row_length > 0 && i % table.row_length == 0)
+                write("{");
+            generate_literal(ir->table_values[table.first_value + i]);
+            if (table.row_length > 0 && (i + 1) % table.row_length == 0)
+                write("}");
+        }
+        write("};");
+    }
+}
+
+// The storage for every entity type and state property of one game. The current state is
+// thread local, so that several games can be played (or searched) at once on different threads.
+// The state is a single block with no pointers, so that it can be cloned with memcpy. Every write
+// to it goes through the runtime's journal, so that a search can also undo a move instead.
+void Generator::generate_state()
+{
+    auto capacity_of = [&](C_Index entity)
+    { return "GAMBIT_CAPACITY_" + ir->strings[ir->entities[entity].identity]; };
+    auto sparse_capacity_of = [&](const C_StateProperty &property)
+    { return "GAMBIT_SPARSE_CAPACITY_" + ir->strings[property.identity]; };
+
+    for (C_Index i = 0; i < ir->entities.size(); i++)
+    {
+        write_directive("#ifndef " + capacity_of(i));
+        write_directive("#define " + capacity_of(i) + " GAMBIT_ENTITY_CAPACITY");
+        write_directive("#endif");
+    }
+
+    // Sparse maps are sized for every combination of the entities in their key, up to
+    // GAMBIT_SPARSE_CAPACITY (see sparse.h)
+    for (const auto &property : ir->state_properties)
+    {
+        if (property.storage != C_StateProperty::SPARSE_MAP)
+            continue;
+
+        string combinations = "( uint64_t ) 1";
+        for (C_Index i = 0; i < property.parameter_count; i++)
+            combinations += " * " + capacity_of(ir->state_parameters[property.first_parameter + i]);
+
+        write_directive("#ifndef " + sparse_capacity_of(property));
+        write_directive("#define " + sparse_capacity_of(property) + " gambit_sparse_capacity ( " + combinations + " )");
+        write_directive("#endif");
+    }
+
+    write("struct GambitState {");
+
+    for (C_Index i = 0; i < ir->entities.size(); i++)
+    {
+        write("GambitEntityTable <");
+        write(capacity_of(i));
+        write(">");
+        write(ir->strings[ir->entities[i].identity]);
+        write(";");
+    }
+
+    for (const auto &property : ir->state_properties)
+    {
+        if (property.storage == C_StateProperty::COLUMN)
+        {
+            write("GambitColumn <");
+            write(ir->strings[property.type]);
+            write(",");
+            write(capacity_of(ir->state_parameters[property.first_parameter]));
+            write(">");
+        }
+        else
+        {
+            write("GambitSparseMap <");
+            write(ir->strings[property.type]);
+            write(",");
+            write((int)property.parameter_count);
+            write(",");
+            write(sparse_capacity_of(property));
+            write(">");
+        }
+        write(ir->strings[property.identity]);
+        write(";");
+    }
+
+    write("GambitOutcome outcome ;");
+    write("};");
+    write("static_assert ( std :: is_trivially_copyable < GambitState > :: value , \"GambitState must be cloneable with memcpy\" ) ;");
+    write("inline thread_local GambitState * gambit_state = nullptr ;");
+
+    // The state is hashed member by member, so that each member is hashed by what it holds
+    // rather than by its bytes (see hash.h)
+    write("inline void gambit_hash ( GambitHasher & hasher , const GambitState & state ) {");
+    for (const auto &entity : ir->entities)
+    {
+        write("gambit_hash ( hasher , state .");
+        write(ir->strings[entity.identity]);
+        write(") ;");
+    }
+    for (const auto &property : ir->state_properties)
+    {
+        write("gambit_hash ( hasher , state .");
+        write(ir->strings[property.identity]);
+        write(") ;");
+    }
+    write("gambit_hash ( hasher , state . outcome ) ; }");
+
+    // Creating an entity gives its columns their initial values. Columns without one are still
+    // reset, as the entity may be reusing the index of one that was destroyed. Sparse maps do not
+    // need to be reset, as their keys include the generation of each entity.
+    for (C_Index i = 0; i < ir->entities.size(); i++)
+    {
+        const auto &entity_identity = ir->strings[ir->entities[i].identity];
+        write("inline GambitEntity gambit_create_" + entity_identity + "( ) {");
+        write("GambitEntity entity = gambit_create ( gambit_state ->");
+        write(entity_identity);
+        write(") ;");
+
+        for (const auto &property : ir->state_properties)
+        {
+            if (property.storage != C_StateProperty::COLUMN || ir->state_parameters[property.first_parameter] != i)
+                continue;
+
+            write("gambit_write ( gambit_state ->");
+            write(ir->strings[property.identity]);
+            write("[ entity ] ,");
+            if (property.initial_value.kind == C_Expression::INVALID)
+                write("{ }");
+            else
+                generate_literal(property.initial_value);
+            write(") ;");
+        }
+
+        write("return entity ; }");
+    }
+}
+
+// The same members as the GambitState, for many instances of the game at once (see batch.h).
+// Columns are stored across the instances, so that a step of every instance walks each column in
+// order. Everything else is stored once per instance. It is a template, so that programs that do
+// not play batches of games do not pay for it.
+void Generator::generate_batch_state()
+{
+    auto capacity_of = [&](C_Index entity)
+    { return "GAMBIT_CAPACITY_" + ir->strings[ir->entities[entity].identity]; };
+    auto sparse_capacity_of = [&](const C_StateProperty &property)
+    { return "GAMBIT_SPARSE_CAPACITY_" + ir->strings[property.identity]; };
+
+    write("template < uint32_t Lanes > struct GambitBatchState {");
+
+    for (C_Index i = 0; i < ir->entities.size(); i++)
+    {
+        write("GambitEntityTable <");
+        write(capacity_of(i));
+        write(">");
+        write(ir->strings[ir->entities[i].identity]);
+        write("[ Lanes ] ;");
+    }
+
+    for (const auto &property : ir->state_properties)
+    {
+        if (property.storage == C_StateProperty::COLUMN)
+        {
+            write("GambitBatchColumn <");
+            write(ir->strings[property.type]);
+            write(",");
+            write(capacity_of(ir->state_parameters[property.first_parameter]));
+            write(", Lanes >");
+            write(ir->strings[property.identity]);
+        }
+        else
+        {
+            write("GambitSparseMap <");
+            write(ir->strings[property.type]);
+            write(",");
+            write((int)property.parameter_count);
+            write(",");
+            write(sparse_capacity_of(property));
+            write(">");
+            write(ir->strings[property.identity]);
+            write("[ Lanes ]");
+        }
+        write(";");
+    }
+
+    write("GambitBatchOutcome < Lanes > outcome ;");
+    write("};");
+
+    // Every member is moved by the overload of gambit_batch_load or gambit_batch_store for its type
+    vector<string_view> members;
+    for (const auto &entity : ir->entities)
+        members.push_back(ir->strings[entity.identity]);
+    for (const auto &property : ir->state_properties)
+        members.push_back(ir->strings[property.identity]);
+    members.push_back("outcome");
+
+    write("template < uint32_t Lanes > inline void gambit_batch_load ( GambitBatchState < Lanes > & batch , uint32_t lane , const GambitState & state ) {");
+    for (auto member : members)
+    {
+        write("gambit_batch_load ( batch .");
+        write(member);
+        write(", lane , state .");
+        write(member);
+        write(") ;");
+    }
+    write("}");
 
-    // Gambit types
-    write("#define GambitEntity int\n");
+    write("template < uint32_t Lanes > inline void gambit_batch_store ( GambitState & state , const GambitBatchState < Lanes > & batch , uint32_t lane ) {");
+    for (auto member : members)
+    {
+        write("gambit_batch_store ( state .");
+        write(member);
+        write(", batch .");
+        write(member);
+        write(", lane ) ;");
+    }
+    write("}");
+}
 
-    // Function forward declarations
-    for (auto funct : program.functions)
+void Generator::generate_forward_declarations()
+{
+    for (const auto &funct : ir->functions)
     {
         generate_function_signature(funct);
         write(";");
     }
+}
 
-    // Function declarations
-    for (auto funct : program.functions)
+// Each group is generated by its own Generator, which shares the read-only IR but has its own
+// buffer, so that groups can be generated on separate threads.
+vector<string> Generator::generate_function_groups(const vector<vector<const C_Function *>> &groups)
+{
+    TRACE_FUNCTION("Generator");
+
+    vector<string> sources(groups.size());
+    auto generate_group = [&](size_t i)
+    {
+        Generator group_generator;
+        group_generator.ir = ir;
+        for (auto funct : groups[i])
+            group_generator.generate_function_declaration(*funct);
+        sources[i] = move(group_generator.buffer);
+    };
+
+    if (pool)
+        pool->run(groups.size(), generate_group);
+    else
+        for (size_t i = 0; i < groups.size(); i++)
+            generate_group(i);
+
+    return sources;
+}
+
+// FNV-1a
+static uint64_t hash_string(string_view str)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : str)
+    {
+        hash ^= (unsigned char)c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Each function is assigned to a shard by the hash of its identity, so that adding, removing,
+// or changing a function only changes the contents of the one shard it belongs to. Shards are
+// then named by the hash of their contents, so a shard whose functions have not changed is
+// written to a byte-identical file with the same name, and can be reused by a compiler cache.
+GeneratedShards Generator::generate_shards(const C_Program &representation, size_t shard_count, string header_name)
+{
+    TRACE_FUNCTION("Generator");
+
+    if (shard_count == 0)
+        throw CompilerError("Cannot generate source code into zero shards.");
+
+    ir = &representation;
+    output = nullptr;
+
+    GeneratedShards shards;
+
+    buffer.clear();
+    flushed_mid_line = false;
+    write_directive("#pragma once");
+    generate_preamble();
+    generate_tables();
+    generate_state();
+    generate_batch_state();
+    generate_forward_declarations();
+    shards.header.file_name = header_name;
+    shards.header.source = move(buffer);
+
+    vector<vector<const C_Function *>> shard_functions(shard_count);
+    for (const auto &funct : ir->functions)
+        shard_functions[hash_string(ir->strings[funct.identity]) % shard_count].push_back(&funct);
+
+    shard_functions.erase(remove_if(shard_functions.begin(), shard_functions.end(), [](const auto &functions)
+                                    { return functions.size() == 0; }),
+                          shard_functions.end());
+
+    for (auto &body : generate_function_groups(shard_functions))
     {
-        generate_function_declaration(funct);
+        string source = "#include \"" + header_name + "\"\n " + body;
+
+        char file_name[32];
+        snprintf(file_name, sizeof file_name, "gambit_%016llx.c", (unsigned long long)hash_string(source));
+        shards.sources.push_back({file_name, move(source)});
     }
+
+    return shards;
 }
-void Generator::generate_function_signature(C_Function funct)
+
+void Generator::generate_function_signature(const C_Function &funct)
 {
     write("void"); // TODO: Return type
-    write(funct.identity);
+    write(ir->strings[funct.identity]);
     write("()"); // TODO: Parameters
 }
 
-void Generator::generate_function_declaration(C_Function funct)
+void Generator::generate_function_declaration(const C_Function &funct)
 {
+    TRACE_FUNCTION_DETAIL("Generator", ir->strings[funct.identity]);
+
+    // Every function has been declared by now, so the entry point can come first. It is generated
+    // along with the function it calls, so that it ends up in exactly one shard.
+    if (ir->entry_point < ir->functions.size() && &funct == &ir->functions[ir->entry_point])
+        generate_entry_point(funct);
+
     generate_function_signature(funct);
 
-    auto block = ir.statements[funct.body];
+    const auto &block = ir->statements[funct.body];
     if (block.statement_count == 0)
     {
         write("{}");
         return;
     }
 
-    size_t first_stmt = funct.body + 1;
-    size_t last_stmt = funct.body + block.statement_count;
+    C_Index first_stmt = funct.body + 1;
+    C_Index last_stmt = funct.body + block.statement_count;
 
-    vector<size_t> close_block_after;
+    vector<C_Index> close_block_after;
     // FIXME: This will cause a segmentation fault if ever `last_stmt` is 0
     close_block_after.push_back(last_stmt);
 
     write("{");
-    for (size_t i = first_stmt; i <= last_stmt; i++)
+    for (C_Index i = first_stmt; i <= last_stmt; i++)
     {
-        C_Statement stmt = ir.statements[i];
+        const auto &stmt = ir->statements[i];
         switch (stmt.kind)
         {
         case C_Statement::INVALID:
@@ -114,6 +583,21 @@ void Generator::generate_function_declaration(C_Function funct)
             break;
         }
 
+        // TODO: Stop running the game once it has ended
+        case C_Statement::WINS_STATEMENT:
+        {
+            write("gambit_wins ( * gambit_state ,");
+            generate_expression(stmt.expression);
+            write(") ;");
+            break;
+        }
+
+        case C_Statement::DRAW_STATEMENT:
+        {
+            write("gambit_draw ( * gambit_state ) ;");
+            break;
+        }
+
         case C_Statement::VARIABLE_DECLARATION:
         {
             // TODO: Implement
@@ -121,9 +605,48 @@ void Generator::generate_function_declaration(C_Function funct)
             break;
         }
 
+        case C_Statement::SWITCH_STATEMENT:
+        {
+            write("switch (");
+            generate_expression(stmt.expression);
+            write(")");
+            break;
+        }
+
+        case C_Statement::CASE_LABEL:
+        {
+            write("case");
+            write(to_string(stmt.case_value));
+            write(":");
+            break;
+        }
+
+        case C_Statement::DEFAULT_LABEL:
+        {
+            write("default:");
+            break;
+        }
+
+        case C_Statement::BREAK_STATEMENT:
+        {
+            write("break;");
+            break;
+        }
+
         case C_Statement::CODE_BLOCK:
         {
-            if (stmt.statement_count != 1)
+            // The body of an if, else, loop or switch can go without braces when it is a single
+            // statement. Any other block, such as the body of a branch that the optimiser lifted
+            // into the enclosing block, is a scope of its own, and so always keeps its braces.
+            auto parent = i > first_stmt ? ir->statements[i - 1].kind : C_Statement::CODE_BLOCK;
+            bool is_body = parent == C_Statement::IF_STATEMENT ||
+                           parent == C_Statement::ELSE_IF_STATEMENT ||
+                           parent == C_Statement::ELSE_STATEMENT ||
+                           parent == C_Statement::FOR_LOOP ||
+                           parent == C_Statement::WHILE_LOOP ||
+                           parent == C_Statement::SWITCH_STATEMENT;
+
+            if (!is_body || stmt.statement_count != 1)
             {
                 write("{");
                 close_block_after.push_back(i + stmt.statement_count);
@@ -142,7 +665,8 @@ void Generator::generate_function_declaration(C_Function funct)
             throw CompilerError("Could not generate C_Statement");
         }
 
-        if (close_block_after.back() == i)
+        // Several blocks may end on the same statement
+        while (!close_block_after.empty() && close_block_after.back() == i)
         {
             close_block_after.pop_back();
             write("}");
@@ -150,9 +674,21 @@ void Generator::generate_function_declaration(C_Function funct)
     }
 }
 
-void Generator::generate_expression(size_t expression_index)
+// Programs are run through the runtime's entry point, which plays the program once, or many times
+// over with `--selfplay N` (see selfplay.h)
+void Generator::generate_entry_point(const C_Function &funct)
+{
+    write("int main ( int argc , char * argv [ ] ) {");
+    write("return gambit_main < GambitState > ( argc , argv , [ ] ( GambitState * state ) { gambit_state = state ;");
+    write(ir->strings[funct.identity]);
+    write("( ) ; } ) ; }");
+}
+
+void Generator::generate_expression(C_Index expression_index)
 {
-    auto &expr = ir.expressions.at(expression_index);
+    TRACE_FUNCTION("Generator");
+
+    const auto &expr = ir->expressions.at(expression_index);
 
     switch (expr.kind)
     {
@@ -165,24 +701,11 @@ void Generator::generate_expression(size_t expression_index)
     }
 
     case C_Expression::DOUBLE_LITERAL:
-    {
-        write(to_string(expr.double_value));
-        break;
-    }
     case C_Expression::INT_LITERAL:
-    {
-        write(to_string(expr.int_value));
-        break;
-    }
     case C_Expression::BOOL_LITERAL:
-    {
-        write(expr.bool_value ? "true" : "false");
-        break;
-    }
     case C_Expression::STRING_LITERAL:
     {
-        // TODO: Use a dedicated string serialisation function, rather than using the JSON one
-        write(to_json(expr.string_value));
+        generate_literal(expr);
         break;
     }
     case C_Expression::BINARY_ADD:
@@ -242,8 +765,111 @@ void Generator::generate_expression(size_t expression_index)
         write("]");
         break;
     }
+    case C_Expression::TABLE_REFERENCE:
+    {
+        write(ir->strings[ir->tables.at(expr.table).identity]);
+        break;
+    }
+    case C_Expression::STATE_PROPERTY:
+    {
+        write("gambit_state ->");
+        write(ir->strings[ir->state_properties.at(expr.state_property).identity]);
+        break;
+    }
+    case C_Expression::STATE_LOOKUP:
+    {
+        const auto &property = ir->state_properties.at(ir->expressions.at(expr.lhs).state_property);
+        generate_expression(expr.lhs);
+        write(". get (");
+        generate_expression(expr.rhs);
+        write(",");
+        if (property.initial_value.kind == C_Expression::INVALID)
+            write("{ }");
+        else
+            generate_literal(property.initial_value);
+        write(")");
+        break;
+    }
+    case C_Expression::ENTITY_KEY:
+    {
+        write("gambit_key (");
+        generate_expression(expr.lhs);
+        write(",");
+        generate_expression(expr.rhs);
+        write(")");
+        break;
+    }
+    case C_Expression::STATE_WRITE:
+    {
+        // Values in sparse maps are written with the key, rather than read with `get`
+        const auto &target = ir->expressions.at(expr.lhs);
+        if (target.kind == C_Expression::STATE_LOOKUP)
+        {
+            write("gambit_set (");
+            generate_expression(target.lhs);
+            write(",");
+            generate_expression(target.rhs);
+        }
+        else
+        {
+            write("gambit_write (");
+            generate_expression(expr.lhs);
+        }
+        write(",");
+        generate_expression(expr.rhs);
+        write(")");
+        break;
+    }
+    case C_Expression::STATE_INSERT:
+    {
+        write("gambit_insert (");
+        generate_expression(expr.lhs);
+        write(",");
+        generate_expression(expr.rhs);
+        write(")");
+        break;
+    }
+    case C_Expression::MATCH_LOOKUP:
+    {
+        write("gambit_match_lookup (");
+        generate_expression(expr.lhs);
+        write(",");
+        generate_expression(expr.rhs);
+        write(")");
+        break;
+    }
+    case C_Expression::CHOOSE:
+    {
+        write("gambit_choose (");
+        generate_expression(expr.lhs);
+        write(",");
+        generate_expression(expr.rhs);
+        write(", gambit_moves )");
+        break;
+    }
 
     default:
-        throw CompilerError("Could not generate C_Expression " + to_string(expr.kind));
+        throw CompilerError("Could not generate C_Expression " + to_string((int)expr.kind));
     }
-}
\ No newline at end of file
+}
+void Generator::generate_literal(const C_Expression &literal)
+{
+    switch (literal.kind)
+    {
+    case C_Expression::DOUBLE_LITERAL:
+        write(literal.double_value);
+        break;
+    case C_Expression::INT_LITERAL:
+        write(literal.int_value);
+        break;
+    case C_Expression::BOOL_LITERAL:
+        write(literal.bool_value ? "true" : "false");
+        break;
+    case C_Expression::STRING_LITERAL:
+        // TODO: Use a dedicated string serialisation function, rather than using the JSON one
+        write(to_json(ir->strings[literal.string_value]));
+        break;
+    default:
+        throw CompilerError("Could not generate C_Expression " + to_string((int)literal.kind) + " as a literal");
+    }
+}
@@ -3,25 +3,69 @@
 #define GENERATOR_H
 
 #include "ir.h"
+#include "thread-pool.h"
+#include <memory>
+#include <ostream>
 #include <string>
+#include <string_view>
+#include <vector>
 using namespace std;
 
+struct GeneratedFile
+{
+    string file_name;
+    string source;
+};
+
+// Source code split across several files. The header contains the includes and forward
+// declarations of every function, and is included by each of the sources.
+struct GeneratedShards
+{
+    GeneratedFile header;
+    vector<GeneratedFile> sources;
+};
+
 class Generator
 {
 public:
-    string generate(C_Program representation);
+    // Function bodies are generated in parallel when given more than one thread. The output
+    // is the same regardless of the number of threads.
+    Generator(size_t thread_count = 1);
+
+    string generate(const C_Program &representation);
+    void generate(const C_Program &representation, ostream &output);
+    GeneratedShards generate_shards(const C_Program &representation, size_t shard_count, string header_name = "generated.h");
 
 private:
-    string source;
-    C_Program ir;
+    // Generated source code is written to the buffer, which is flushed to the output stream
+    // (if there is one) whenever it grows beyond FLUSH_SIZE.
+    static constexpr size_t FLUSH_SIZE = 1 << 16;
+    string buffer;
+    ostream *output = nullptr;
+    bool flushed_mid_line = false; // Whether the last character flushed to the output ended a line
+    const C_Program *ir = nullptr;
+    unique_ptr<ThreadPool> pool;
 
-    void write(string token);
+    void write(string_view token);
+    void write_directive(string_view directive);
+    void append(string_view source);
+    void write(int value);
+    void write(double value);
+    void flush();
 
-    void generate_program(C_Program program);
-    void generate_function_signature(C_Function funct);
-    void generate_function_declaration(C_Function funct);
+    void generate_program();
+    void generate_preamble();
+    void generate_tables();
+    void generate_state();
+    void generate_batch_state();
+    void generate_forward_declarations();
+    vector<string> generate_function_groups(const vector<vector<const C_Function *>> &groups);
+    void generate_function_signature(const C_Function &funct);
+    void generate_function_declaration(const C_Function &funct);
+    void generate_entry_point(const C_Function &funct);
 
-    void generate_expression(size_t expression_index);
+    void generate_expression(C_Index expression_index);
+    void generate_literal(const C_Expression &literal);
 };
 
 #endif
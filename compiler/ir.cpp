@@ -1 +1,17 @@
-#include "ir.h"
\ No newline at end of file
+#include "errors.h"
+#include "ir.h"
+
+C_Index intern_string(C_Program &program, const string &str)
+{
+    auto it = program.string_indexes.find(str);
+    if (it != program.string_indexes.end())
+        return it->second;
+
+    if (program.strings.size() >= C_INDEX_MAX)
+        throw CompilerError("IR string pool has exceeded the maximum number of strings.");
+
+    C_Index index = (C_Index)program.strings.size();
+    program.strings.push_back(str);
+    program.string_indexes.emplace(str, index);
+    return index;
+}
\ No newline at end of file
@@ -4,21 +4,38 @@ ir.h
 Defines the nodes of the Intermediate Representation as well as a range of utility methods.
 This should model a C program, so that we can convert to the Abstract Program Model to the IR,
 then from the IR to source code.
+
+Nodes refer to each other by 32-bit index into the vectors of C_Program, and strings (such as
+identities and string literals) are interned into a pool and referred to by index. This keeps
+every node small and trivially copyable, so the vectors can be grown and copied with memcpy.
 */
 
 #pragma once
 #ifndef IR_H
 #define IR_H
 
+#include <cstdint>
+#include <limits>
 #include <string>
+#include <type_traits>
+#include <unordered_map>
 #include <vector>
 using namespace std;
 
+// An index into one of the vectors of C_Program
+using C_Index = uint32_t;
+constexpr C_Index C_INDEX_MAX = numeric_limits<C_Index>::max();
+
 // FORWARD DECLARATIONS
 
 // Program
 struct C_Program;
 struct C_Function;
+struct C_Table;
+
+// Entities and state
+struct C_Entity;
+struct C_StateProperty;
 
 // Statements
 struct C_Statement;
@@ -31,21 +48,45 @@ struct C_Expression;
 struct C_Program
 {
     vector<C_Function> functions;
+    C_Index entry_point = C_INDEX_MAX; // The index of the function for `main` in `functions`, if there is one
     vector<C_Statement> statements;
     vector<C_Expression> expressions;
+
+    // Static lookup tables, whose values are literal expressions stored in `table_values`
+    vector<C_Table> tables;
+    vector<C_Expression> table_values;
+
+    // Entity types and the storage of their state properties
+    vector<C_Entity> entities;
+    vector<C_StateProperty> state_properties;
+    vector<C_Index> state_parameters; // The entity of each parameter of each state property
+
+    // String pool
+    vector<string> strings;
+    unordered_map<string, C_Index> string_indexes;
 };
 
 struct C_Function
 {
-    string identity;
-    size_t body;
+    C_Index identity; // Index into the string pool
+    C_Index body;
+};
+
+// A static array of `value_count` literals, starting at `first_value` in the table values of the
+// program. Tables with a `row_length` are two dimensional, and are stored one row after another.
+struct C_Table
+{
+    C_Index identity; // Index into the string pool
+    C_Index first_value;
+    C_Index value_count;
+    C_Index row_length; // 0 if the table is one dimensional
 };
 
 // STATEMENTS
 
 struct C_Statement
 {
-    enum Kind
+    enum Kind : uint8_t
     {
         INVALID,
 
@@ -57,6 +98,16 @@ struct C_Statement
         RETURN_STATEMENT,
         VARIABLE_DECLARATION,
 
+        // Ends the game. The expression of a WINS_STATEMENT is the player that won.
+        WINS_STATEMENT,
+        DRAW_STATEMENT,
+
+        // The body of a switch is a code block, in which each case starts with a label
+        SWITCH_STATEMENT,
+        CASE_LABEL,
+        DEFAULT_LABEL,
+        BREAK_STATEMENT,
+
         CODE_BLOCK,
         EXPRESSION_STATEMENT
     };
@@ -66,11 +117,15 @@ struct C_Statement
     {
         struct
         {
-            size_t statement_count;
+            C_Index statement_count;
         };
         struct
         {
-            size_t expression;
+            C_Index expression;
+        };
+        struct
+        {
+            int case_value;
         };
     };
 };
@@ -79,7 +134,7 @@ struct C_Statement
 
 struct C_Expression
 {
-    enum Kind
+    enum Kind : uint8_t
     {
         INVALID,
 
@@ -97,6 +152,24 @@ struct C_Expression
         BINARY_OR,
 
         SUB_SCRIPT,
+
+        TABLE_REFERENCE,
+        STATE_PROPERTY,
+        STATE_LOOKUP,
+        ENTITY_KEY,
+
+        // Writes to the game state go through the runtime, so that they can be journaled. The lhs
+        // of both is an access to a state property, as in the comment on C_StateProperty.
+        STATE_WRITE,  // Assigns the rhs to the property
+        STATE_INSERT, // Inserts the rhs into the list stored in the property
+
+        // The player (lhs) chooses one of the items of a list (rhs). Each item that can be chosen
+        // is written into a fixed buffer by the runtime's move generators (see moves.h).
+        CHOOSE,
+
+        // Looks up the index (rhs) in the table of a match (lhs), whose last value is the result
+        // of its `else`, which is given for any index outside of the other values
+        MATCH_LOOKUP,
     };
 
     Kind kind;
@@ -104,8 +177,8 @@ struct C_Expression
     {
         struct
         {
-            size_t lhs;
-            size_t rhs;
+            C_Index lhs;
+            C_Index rhs;
         };
         struct
         {
@@ -119,9 +192,62 @@ struct C_Expression
         {
             bool bool_value;
         };
+        struct
+        {
+            C_Index string_value; // Index into the string pool
+        };
+        struct
+        {
+            C_Index table; // Index into the tables of the program
+        };
+        struct
+        {
+            C_Index state_property; // Index into the state properties of the program
+        };
+    };
+};
+
+// ENTITIES AND STATE
+
+struct C_Entity
+{
+    C_Index identity; // Index into the string pool
+};
+
+// A state property whose parameters are all entities. Properties with a single parameter are
+// stored as a column with one value per entity, which is indexed with the entity, as in
+// SUB_SCRIPT(STATE_PROPERTY, entity). Properties with several parameters are stored in a sparse
+// map, which is looked up with a key made from each of the entities, as in
+// STATE_LOOKUP(STATE_PROPERTY, ENTITY_KEY(ENTITY_KEY(a, b), c)). Entries that are not in the map
+// have the property's initial value.
+struct C_StateProperty
+{
+    enum Storage : uint8_t
+    {
+        COLUMN,
+        SPARSE_MAP,
     };
 
-    string string_value; // TODO: Ideally this would go in the union, but that takes some effort to do!
+    Storage storage;
+    C_Index identity;        // Index into the string pool
+    C_Index type;            // Index into the string pool, the C type of the property's values
+    C_Index first_parameter; // Index into the state parameters of the program
+    C_Index parameter_count;
+
+    // A literal, or INVALID if the property has no initial value
+    C_Expression initial_value;
 };
 
+static_assert(is_trivially_copyable_v<C_Function>, "IR nodes should be trivially copyable");
+static_assert(is_trivially_copyable_v<C_Table>, "IR nodes should be trivially copyable");
+static_assert(is_trivially_copyable_v<C_Statement>, "IR nodes should be trivially copyable");
+static_assert(is_trivially_copyable_v<C_Expression>, "IR nodes should be trivially copyable");
+static_assert(is_trivially_copyable_v<C_Entity>, "IR nodes should be trivially copyable");
+static_assert(is_trivially_copyable_v<C_StateProperty>, "IR nodes should be trivially copyable");
+
+// IR METHODS
+
+// Returns the index of the string in the program's string pool, adding it if necessary
+[[nodiscard]] C_Index intern_string(C_Program &program, const string &str);
+
 #endif
\ No newline at end of file
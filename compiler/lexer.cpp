@@ -1,9 +1,12 @@
 #include "errors.h"
 #include "lexer.h"
 #include "token.h"
+#include "trace.h"
 
 void Lexer::tokenise(Source &source)
 {
+    TRACE_FUNCTION_DETAIL("Lexer", source.file_path);
+
     size_t line = 1;
     size_t column = 1;
     size_t position = 0;
@@ -2,18 +2,26 @@
 #include "checker.h"
 #include "converter.h"
 #include "errors.h"
+#include "evaluator.h"
 #include "generator.h"
 #include "json.h"
 #include "lexer.h"
+#include "optimiser.h"
 #include "parser.h"
 #include "resolver.h"
 #include "source.h"
+#include "thread-pool.h"
 #include "token.h"
+#include "trace.h"
 #include "utilty.h"
+#include <algorithm>
 #include <exception>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <sstream>
 #include <string>
+#include <unordered_set>
 using namespace std;
 
 // Output to JSON
@@ -36,13 +44,14 @@ void output_program(ptr<Program> program, string file_name)
 
 // Output to C
 
-void output_c_source(string source, string file_name)
+void output_c_source(const C_Program &representation, size_t thread_count, string file_name)
 {
     std::ofstream output;
     output.open("local/" + file_name + ".c");
     if (output.is_open())
     {
-        output << source;
+        Generator generator(thread_count);
+        generator.generate(representation, output);
         cout << "Saved C source code to local/" + file_name + ".c" << endl;
         output.close();
     }
@@ -52,6 +61,62 @@ void output_c_source(string source, string file_name)
     }
 }
 
+void output_c_shards(const C_Program &representation, size_t shard_count, size_t thread_count, string dir_name)
+{
+    Generator generator(thread_count);
+    auto shards = generator.generate_shards(representation, shard_count);
+
+    auto dir = "local/" + dir_name;
+    std::error_code error;
+    filesystem::create_directories(dir, error);
+    if (error)
+    {
+        cout << "Error attempting to create " + dir << endl;
+        return;
+    }
+
+    // Shards are content-addressed, so any shard left over from a previous compilation that
+    // has not been generated again is out of date
+    unordered_set<string> file_names;
+    for (const auto &shard : shards.sources)
+        file_names.insert(shard.file_name);
+
+    for (const auto &entry : filesystem::directory_iterator(dir))
+    {
+        auto file_name = entry.path().filename().string();
+        if (file_name.rfind("gambit_", 0) == 0 && entry.path().extension() == ".c" && file_names.count(file_name) == 0)
+            filesystem::remove(entry.path(), error);
+    }
+
+    // Files that already exist have the same contents, and are left untouched so that
+    // their modification time does not change
+    auto save = [&](const GeneratedFile &file, bool overwrite)
+    {
+        auto file_path = dir + "/" + file.file_name;
+        if (!overwrite && filesystem::exists(file_path))
+            return;
+
+        std::ofstream output;
+        output.open(file_path, ios::binary);
+        if (output.is_open())
+            output << file.source;
+        else
+            cout << "Error attempting to save C source code to " + file_path << endl;
+    };
+
+    // The header is not content-addressed, so is only rewritten if it has changed
+    std::ifstream existing_header(dir + "/" + shards.header.file_name, ios::binary);
+    stringstream existing_source;
+    existing_source << existing_header.rdbuf();
+    existing_header.close();
+    save(shards.header, existing_source.str() != shards.header.source);
+
+    for (const auto &shard : shards.sources)
+        save(shard, false);
+
+    cout << "Saved C source code to " + dir + " (" + to_string(shards.sources.size()) + " files)" << endl;
+}
+
 // Main
 
 int main(int argc, char *argv[])
@@ -59,9 +124,23 @@ int main(int argc, char *argv[])
     // FIXME: Allow for compilation of multiple source files.
 
     // FIXME: Remove this default value! I only have it for now for ease of testing
-    string source_path = (argc == 2)
-                             ? (string)argv[1] + ".gambit"
-                             : "local/main.gambit";
+    string source_path = "local/main.gambit";
+    size_t shard_count = 0;
+    size_t thread_count = ThreadPool::default_thread_count();
+    bool optimise = true;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "-shards" && i + 1 < argc)
+            shard_count = stoul(argv[++i]);
+        else if (arg == "-threads" && i + 1 < argc)
+            thread_count = max<size_t>(stoul(argv[++i]), 1);
+        else if (arg == "-no-optimise")
+            optimise = false;
+        else
+            source_path = arg + ".gambit";
+    }
 
     Source source(source_path);
 
@@ -105,15 +184,29 @@ int main(int argc, char *argv[])
         }
         else
         {
+            cout << "\nEVALUATOR" << endl;
+            Evaluator evaluator;
+            evaluator.evaluate(program);
+            output_program(program, "evaluator_output");
+
             cout << "\nCONVERTER" << endl;
             Converter converter;
             auto representation = converter.convert(program);
             // TODO: Output as JSON
 
+            if (optimise)
+            {
+                cout << "\nOPTIMISER" << endl;
+                Optimiser optimiser;
+                for (const auto &report : optimiser.optimise(representation))
+                    cout << report.name << ": removed " << report.statements_removed << " statements and " << report.expressions_removed << " expressions" << endl;
+            }
+
             cout << "\nGENERATOR" << endl;
-            Generator generator;
-            auto source = generator.generate(representation);
-            output_c_source(source, "generated");
+            if (shard_count > 0)
+                output_c_shards(representation, shard_count, thread_count, "generated");
+            else
+                output_c_source(representation, thread_count, "generated");
         }
 
         cout << "Compilation complete" << endl;
@@ -125,5 +218,7 @@ int main(int argc, char *argv[])
         cout << error.what() << endl;
     }
 
+    TRACE_SAVE("local/trace.json");
+
     return 0;
 }
\ No newline at end of file
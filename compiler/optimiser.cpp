@@ -0,0 +1,628 @@
+#include "errors.h"
+#include "optimiser.h"
+#include "trace.h"
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <optional>
+
+vector<PassReport> Optimiser::optimise(C_Program &representation)
+{
+    TRACE_FUNCTION("Optimiser");
+
+    ir = &representation;
+
+    // Folding constants can turn the conditions of branches into literals, and pruning branches
+    // can lift a return statement up into the enclosing block, so each pass creates more work
+    // for the passes that come after it.
+    vector<PassReport> reports;
+    reports.push_back(run_pass("constant folding", &Optimiser::fold_constants));
+    reports.push_back(run_pass("branch pruning", &Optimiser::prune_constant_branches));
+    reports.push_back(run_pass("unreachable code", &Optimiser::remove_unreachable_statements));
+
+    ir = nullptr;
+    return reports;
+}
+
+PassReport Optimiser::run_pass(string name, void (Optimiser::*pass)())
+{
+    TRACE_SCOPE_DETAIL("Optimiser", "run_pass", name);
+
+    size_t statements_before = ir->statements.size();
+    size_t expressions_before = ir->expressions.size();
+
+    (this->*pass)();
+
+    PassReport report;
+    report.name = name;
+    report.statements_removed = statements_before - ir->statements.size();
+    report.expressions_removed = expressions_before - ir->expressions.size();
+    return report;
+}
+
+// IR STRUCTURE //
+
+// The number of statements taken up by a statement and everything nested within it
+static C_Index statement_size(const C_Program &program, C_Index stmt)
+{
+    const auto &statement = program.statements.at(stmt);
+    switch (statement.kind)
+    {
+    case C_Statement::CODE_BLOCK:
+        return 1 + statement.statement_count;
+
+    case C_Statement::IF_STATEMENT:
+    case C_Statement::ELSE_IF_STATEMENT:
+    case C_Statement::ELSE_STATEMENT:
+    case C_Statement::FOR_LOOP:
+    case C_Statement::WHILE_LOOP:
+    case C_Statement::SWITCH_STATEMENT:
+        return 1 + statement_size(program, stmt + 1);
+
+    default:
+        return 1;
+    }
+}
+
+static bool has_expression(C_Statement::Kind kind)
+{
+    return kind == C_Statement::IF_STATEMENT ||
+           kind == C_Statement::ELSE_IF_STATEMENT ||
+           kind == C_Statement::RETURN_STATEMENT ||
+           kind == C_Statement::WINS_STATEMENT ||
+           kind == C_Statement::EXPRESSION_STATEMENT ||
+           kind == C_Statement::SWITCH_STATEMENT;
+}
+
+static bool has_body(C_Statement::Kind kind)
+{
+    return kind == C_Statement::IF_STATEMENT ||
+           kind == C_Statement::ELSE_IF_STATEMENT ||
+           kind == C_Statement::ELSE_STATEMENT ||
+           kind == C_Statement::FOR_LOOP ||
+           kind == C_Statement::WHILE_LOOP ||
+           kind == C_Statement::SWITCH_STATEMENT;
+}
+
+static bool is_label(C_Statement::Kind kind)
+{
+    return kind == C_Statement::CASE_LABEL ||
+           kind == C_Statement::DEFAULT_LABEL;
+}
+
+static bool has_operands(C_Expression::Kind kind)
+{
+    switch (kind)
+    {
+    case C_Expression::BINARY_ADD:
+    case C_Expression::BINARY_SUB:
+    case C_Expression::BINARY_MUL:
+    case C_Expression::BINARY_DIV:
+    case C_Expression::BINARY_EQUAL:
+    case C_Expression::BINARY_AND:
+    case C_Expression::BINARY_OR:
+    case C_Expression::SUB_SCRIPT:
+    case C_Expression::STATE_LOOKUP:
+    case C_Expression::ENTITY_KEY:
+    case C_Expression::STATE_WRITE:
+    case C_Expression::STATE_INSERT:
+    case C_Expression::CHOOSE:
+    case C_Expression::MATCH_LOOKUP:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+// Whether control can never reach the statement after this one
+static bool always_returns(const C_Program &program, C_Index stmt)
+{
+    const auto &statement = program.statements.at(stmt);
+
+    if (statement.kind == C_Statement::RETURN_STATEMENT)
+        return true;
+
+    if (statement.kind == C_Statement::CODE_BLOCK)
+    {
+        C_Index end = stmt + 1 + statement.statement_count;
+        for (C_Index child = stmt + 1; child < end; child += statement_size(program, child))
+        {
+            if (always_returns(program, child))
+                return true;
+        }
+    }
+
+    return false;
+}
+
+// The truth of a condition, if it is known at compile time
+static optional<bool> constant_condition(const C_Program &program, C_Index expr)
+{
+    const auto &expression = program.expressions.at(expr);
+    if (expression.kind == C_Expression::BOOL_LITERAL)
+        return expression.bool_value;
+    if (expression.kind == C_Expression::INT_LITERAL)
+        return expression.int_value != 0;
+    return {};
+}
+
+// REBUILDING //
+// Copies each function of a program into a new set of statement and expression arrays. Only
+// the nodes that are reached from a function are copied, so anything that a pass has
+// disconnected from the program is left behind.
+
+struct Rebuild
+{
+    const C_Program &source;
+    C_Program result;
+
+    bool prune_branches = false;
+    bool remove_unreachable = false;
+
+    // Expressions can be shared by several statements, so each one is only copied once
+    vector<C_Index> new_expression_index;
+
+    Rebuild(const C_Program &source)
+        : source(source),
+          new_expression_index(source.expressions.size(), C_INDEX_MAX)
+    {
+        result.entry_point = source.entry_point;
+        result.strings = source.strings;
+        result.string_indexes = source.string_indexes;
+        result.tables = source.tables;
+        result.table_values = source.table_values;
+        result.entities = source.entities;
+        result.state_properties = source.state_properties;
+        result.state_parameters = source.state_parameters;
+        result.statements.reserve(source.statements.size());
+        result.expressions.reserve(source.expressions.size());
+    }
+
+    C_Program run()
+    {
+        for (const auto &funct : source.functions)
+        {
+            C_Function copy = funct;
+            copy.body = copy_statement(funct.body);
+            result.functions.push_back(copy);
+        }
+
+        return move(result);
+    }
+
+    C_Index push_statement(C_Statement statement)
+    {
+        result.statements.push_back(statement);
+        return (C_Index)(result.statements.size() - 1);
+    }
+
+    C_Index copy_expression(C_Index expr)
+    {
+        if (expr >= source.expressions.size())
+            throw CompilerError("IR statement refers to expression " + to_string(expr) + ", which does not exist.");
+
+        if (new_expression_index[expr] != C_INDEX_MAX)
+            return new_expression_index[expr];
+
+        C_Expression expression = source.expressions[expr];
+        if (has_operands(expression.kind))
+        {
+            expression.lhs = copy_expression(expression.lhs);
+            expression.rhs = copy_expression(expression.rhs);
+        }
+
+        result.expressions.push_back(expression);
+        return new_expression_index[expr] = (C_Index)(result.expressions.size() - 1);
+    }
+
+    C_Index copy_statement(C_Index stmt)
+    {
+        C_Statement statement = source.statements.at(stmt);
+
+        if (statement.kind == C_Statement::CODE_BLOCK)
+            return copy_code_block(stmt);
+
+        if (has_expression(statement.kind))
+            statement.expression = copy_expression(statement.expression);
+
+        C_Index index = push_statement(statement);
+        if (has_body(statement.kind))
+            copy_statement(stmt + 1);
+
+        return index;
+    }
+
+    C_Index copy_code_block(C_Index block)
+    {
+        C_Index index = push_statement(source.statements.at(block));
+
+        C_Index end = block + 1 + source.statements[block].statement_count;
+        C_Index child = block + 1;
+        bool is_unreachable = false;
+        while (child < end)
+        {
+            // The next label in the body of a switch can be reached, even if the statement
+            // before it cannot
+            if (is_unreachable && !is_label(source.statements[child].kind))
+            {
+                child += statement_size(source, child);
+                continue;
+            }
+            is_unreachable = false;
+
+            C_Index copied = C_INDEX_MAX;
+            if (prune_branches && source.statements[child].kind == C_Statement::IF_STATEMENT)
+            {
+                copied = copy_if_chain(child, end);
+                child = end_of_if_chain(child, end);
+            }
+            else
+            {
+                copied = copy_statement(child);
+                child += statement_size(source, child);
+            }
+
+            if (remove_unreachable && copied != C_INDEX_MAX && always_returns(result, copied))
+                is_unreachable = true;
+        }
+
+        result.statements[index].statement_count = (C_Index)(result.statements.size() - (index + 1));
+        return index;
+    }
+
+    // The statement after the last else-if or else statement following an if statement
+    C_Index end_of_if_chain(C_Index stmt, C_Index end)
+    {
+        do
+        {
+            bool is_else = source.statements[stmt].kind == C_Statement::ELSE_STATEMENT;
+            stmt += statement_size(source, stmt);
+            if (is_else)
+                break;
+        } while (stmt < end &&
+                 (source.statements[stmt].kind == C_Statement::ELSE_IF_STATEMENT ||
+                  source.statements[stmt].kind == C_Statement::ELSE_STATEMENT));
+
+        return stmt;
+    }
+
+    // Returns the index of the first statement that was copied, or C_INDEX_MAX if every branch
+    // was removed
+    C_Index copy_if_chain(C_Index stmt, C_Index end)
+    {
+        struct Branch
+        {
+            optional<C_Index> condition;
+            C_Index body;
+        };
+
+        vector<Branch> branches;
+        C_Index chain_end = end_of_if_chain(stmt, end);
+        for (C_Index branch = stmt; branch < chain_end; branch += statement_size(source, branch))
+        {
+            const auto &statement = source.statements[branch];
+            if (statement.kind == C_Statement::ELSE_STATEMENT)
+            {
+                branches.push_back({{}, branch + 1});
+                break;
+            }
+
+            auto truth = constant_condition(source, statement.expression);
+            if (!truth.has_value())
+            {
+                branches.push_back({statement.expression, branch + 1});
+            }
+            else if (truth.value())
+            {
+                // Later branches can never be taken
+                branches.push_back({{}, branch + 1});
+                break;
+            }
+        }
+
+        if (branches.size() == 0)
+            return C_INDEX_MAX;
+
+        // The first branch is always taken, so its body takes the place of the whole chain
+        if (!branches[0].condition.has_value())
+            return copy_statement(branches[0].body);
+
+        C_Index index = C_INDEX_MAX;
+        for (size_t i = 0; i < branches.size(); i++)
+        {
+            C_Statement statement = {};
+            if (!branches[i].condition.has_value())
+            {
+                statement.kind = C_Statement::ELSE_STATEMENT;
+            }
+            else
+            {
+                statement.kind = i == 0 ? C_Statement::IF_STATEMENT : C_Statement::ELSE_IF_STATEMENT;
+                statement.expression = copy_expression(branches[i].condition.value());
+            }
+
+            C_Index copied = push_statement(statement);
+            if (i == 0)
+                index = copied;
+
+            copy_statement(branches[i].body);
+        }
+
+        return index;
+    }
+};
+
+// PASSES //
+
+// Doubles are written to the generated code with a fixed number of decimal places, so a folded
+// double is only used if it will be written without losing precision.
+static bool written_exactly(double value)
+{
+    if (!isfinite(value))
+        return false;
+
+    char digits[512];
+    snprintf(digits, sizeof digits, "%f", value);
+    return strtod(digits, nullptr) == value;
+}
+
+static bool is_number(const C_Expression &expression)
+{
+    return expression.kind == C_Expression::INT_LITERAL || expression.kind == C_Expression::DOUBLE_LITERAL;
+}
+
+static double number_value(const C_Expression &expression)
+{
+    return expression.kind == C_Expression::INT_LITERAL ? expression.int_value : expression.double_value;
+}
+
+// Folds the operation in the same way that it would be evaluated in the generated C code.
+// Operations that would be undefined behaviour in C (such as integer overflow, or division by
+// zero) are left for the C compiler to deal with.
+static optional<C_Expression> fold_operation(C_Expression::Kind kind, const C_Expression &lhs, const C_Expression &rhs)
+{
+    C_Expression result = {};
+
+    if (lhs.kind == C_Expression::INT_LITERAL && rhs.kind == C_Expression::INT_LITERAL)
+    {
+        int64_t a = lhs.int_value;
+        int64_t b = rhs.int_value;
+        int64_t value;
+
+        switch (kind)
+        {
+        case C_Expression::BINARY_ADD:
+            value = a + b;
+            break;
+        case C_Expression::BINARY_SUB:
+            value = a - b;
+            break;
+        case C_Expression::BINARY_MUL:
+            value = a * b;
+            break;
+        case C_Expression::BINARY_DIV:
+            if (b == 0)
+                return {};
+            value = a / b;
+            break;
+        case C_Expression::BINARY_EQUAL:
+            result.kind = C_Expression::BOOL_LITERAL;
+            result.bool_value = a == b;
+            return result;
+        default:
+            return {};
+        }
+
+        if (value < numeric_limits<int>::min() || value > numeric_limits<int>::max())
+            return {};
+
+        result.kind = C_Expression::INT_LITERAL;
+        result.int_value = (int)value;
+        return result;
+    }
+
+    if (is_number(lhs) && is_number(rhs))
+    {
+        double a = number_value(lhs);
+        double b = number_value(rhs);
+        double value;
+
+        switch (kind)
+        {
+        case C_Expression::BINARY_ADD:
+            value = a + b;
+            break;
+        case C_Expression::BINARY_SUB:
+            value = a - b;
+            break;
+        case C_Expression::BINARY_MUL:
+            value = a * b;
+            break;
+        case C_Expression::BINARY_DIV:
+            value = a / b;
+            break;
+        case C_Expression::BINARY_EQUAL:
+            result.kind = C_Expression::BOOL_LITERAL;
+            result.bool_value = a == b;
+            return result;
+        default:
+            return {};
+        }
+
+        if (!written_exactly(value))
+            return {};
+
+        result.kind = C_Expression::DOUBLE_LITERAL;
+        result.double_value = value;
+        return result;
+    }
+
+    if (lhs.kind == C_Expression::BOOL_LITERAL && rhs.kind == C_Expression::BOOL_LITERAL)
+    {
+        result.kind = C_Expression::BOOL_LITERAL;
+        switch (kind)
+        {
+        case C_Expression::BINARY_AND:
+            result.bool_value = lhs.bool_value && rhs.bool_value;
+            return result;
+        case C_Expression::BINARY_OR:
+            result.bool_value = lhs.bool_value || rhs.bool_value;
+            return result;
+        case C_Expression::BINARY_EQUAL:
+            result.bool_value = lhs.bool_value == rhs.bool_value;
+            return result;
+        default:
+            return {};
+        }
+    }
+
+    // NOTE: String literals are not folded, as `==` compares the address of strings in C.
+    return {};
+}
+
+// Operands always come before the operations that use them, so by working forwards through the
+// expressions every operand has already been folded by the time its operation is reached.
+void Optimiser::fold_constants()
+{
+    TRACE_FUNCTION("Optimiser");
+
+    bool folded_any = false;
+    auto &expressions = ir->expressions;
+    for (size_t i = 0; i < expressions.size(); i++)
+    {
+        const auto &expression = expressions[i];
+        if (!has_operands(expression.kind))
+            continue;
+
+        const auto &lhs = expressions.at(expression.lhs);
+        const auto &rhs = expressions.at(expression.rhs);
+
+        // Looking up a literal index in a one dimensional table
+        if (expression.kind == C_Expression::SUB_SCRIPT)
+        {
+            if (lhs.kind != C_Expression::TABLE_REFERENCE || rhs.kind != C_Expression::INT_LITERAL)
+                continue;
+
+            const auto &table = ir->tables.at(lhs.table);
+            if (table.row_length == 0 && rhs.int_value >= 0 && (C_Index)rhs.int_value < table.value_count)
+            {
+                expressions[i] = ir->table_values[table.first_value + rhs.int_value];
+                folded_any = true;
+            }
+            continue;
+        }
+
+        // Looking up a literal index in the table of a match, which falls back to its last value
+        if (expression.kind == C_Expression::MATCH_LOOKUP)
+        {
+            if (lhs.kind != C_Expression::TABLE_REFERENCE || rhs.kind != C_Expression::INT_LITERAL)
+                continue;
+
+            const auto &table = ir->tables.at(lhs.table);
+            if (table.row_length == 0)
+            {
+                C_Index last = table.value_count - 1;
+                C_Index index = rhs.int_value >= 0 && (C_Index)rhs.int_value < last ? (C_Index)rhs.int_value : last;
+                expressions[i] = ir->table_values[table.first_value + index];
+                folded_any = true;
+            }
+            continue;
+        }
+
+        if (auto folded = fold_operation(expression.kind, lhs, rhs))
+        {
+            expressions[i] = folded.value();
+            folded_any = true;
+            continue;
+        }
+
+        // `true and x` and `false or x` are just `x`
+        // NOTE: `false and x` and `true or x` are not folded, as that would skip evaluating `x`
+        bool is_and = expression.kind == C_Expression::BINARY_AND;
+        bool is_or = expression.kind == C_Expression::BINARY_OR;
+        if ((is_and && lhs.kind == C_Expression::BOOL_LITERAL && lhs.bool_value) ||
+            (is_or && lhs.kind == C_Expression::BOOL_LITERAL && !lhs.bool_value))
+        {
+            expressions[i] = rhs;
+            folded_any = true;
+        }
+        else if ((is_and && rhs.kind == C_Expression::BOOL_LITERAL && rhs.bool_value) ||
+                 (is_or && rhs.kind == C_Expression::BOOL_LITERAL && !rhs.bool_value))
+        {
+            expressions[i] = lhs;
+            folded_any = true;
+        }
+    }
+
+    // The operands of folded operations are no longer used
+    if (folded_any)
+        remove_unused_nodes();
+}
+
+// NOTE: Rebuilding the program is the expensive part of each pass, so the passes below first
+//       check whether there is anything for them to remove.
+
+void Optimiser::prune_constant_branches()
+{
+    TRACE_FUNCTION("Optimiser");
+
+    bool has_constant_branch = false;
+    for (const auto &statement : ir->statements)
+    {
+        if ((statement.kind == C_Statement::IF_STATEMENT || statement.kind == C_Statement::ELSE_IF_STATEMENT) &&
+            constant_condition(*ir, statement.expression).has_value())
+        {
+            has_constant_branch = true;
+            break;
+        }
+    }
+
+    if (!has_constant_branch)
+        return;
+
+    Rebuild rebuild(*ir);
+    rebuild.prune_branches = true;
+    *ir = rebuild.run();
+}
+
+void Optimiser::remove_unreachable_statements()
+{
+    TRACE_FUNCTION("Optimiser");
+
+    // Look for a block where a statement other than the last one always returns
+    bool has_unreachable_statement = false;
+    for (C_Index block = 0; block < ir->statements.size() && !has_unreachable_statement; block++)
+    {
+        if (ir->statements[block].kind != C_Statement::CODE_BLOCK)
+            continue;
+
+        C_Index end = block + 1 + ir->statements[block].statement_count;
+        for (C_Index child = block + 1; child < end; child += statement_size(*ir, child))
+        {
+            C_Index next = child + statement_size(*ir, child);
+            if (next < end && !is_label(ir->statements[next].kind) && always_returns(*ir, child))
+            {
+                has_unreachable_statement = true;
+                break;
+            }
+        }
+    }
+
+    if (!has_unreachable_statement)
+        return;
+
+    Rebuild rebuild(*ir);
+    rebuild.remove_unreachable = true;
+    *ir = rebuild.run();
+}
+
+void Optimiser::remove_unused_nodes()
+{
+    TRACE_FUNCTION("Optimiser");
+
+    Rebuild rebuild(*ir);
+    *ir = rebuild.run();
+}
@@ -0,0 +1,59 @@
+/*
+optimiser.h
+
+Optimisation passes over the Intermediate Representation, which are run after the Converter
+and before the Generator. The passes are run in order by `Optimiser::optimise`, and each one
+reports how many statements and expressions it removed from the program.
+
+Passes that remove nodes do so by rebuilding the statement and expression arrays, copying
+across only the nodes that are still used by a function. The rebuilt arrays keep the order that
+the Converter produces: each statement is followed by the statements nested inside of it, and
+each expression comes after its operands. The passes rely on this order, as does the Generator.
+*/
+
+#pragma once
+#ifndef OPTIMISER_H
+#define OPTIMISER_H
+
+#include "ir.h"
+#include <string>
+#include <vector>
+using namespace std;
+
+struct PassReport
+{
+    string name;
+    size_t statements_removed = 0;
+    size_t expressions_removed = 0;
+
+    size_t nodes_removed() const { return statements_removed + expressions_removed; }
+};
+
+class Optimiser
+{
+public:
+    vector<PassReport> optimise(C_Program &representation);
+
+private:
+    C_Program *ir = nullptr;
+
+    PassReport run_pass(string name, void (Optimiser::*pass)());
+
+    // PASSES //
+
+    // Replaces binary operations on literals with the literal result
+    void fold_constants();
+
+    // Removes if/else-if branches with a constant false condition, and any branches that come
+    // after one with a constant true condition
+    void prune_constant_branches();
+
+    // Removes statements that come after a return statement in the same block, up to the next
+    // label if the block is the body of a switch
+    void remove_unreachable_statements();
+
+    // Removes any statements and expressions that are no longer used by a function
+    void remove_unused_nodes();
+};
+
+#endif
@@ -2,9 +2,12 @@
 #include "source.h"
 #include "intrinsic.h"
 #include "parser.h"
+#include "trace.h"
 
 ptr<Program> Parser::parse(Source &source)
 {
+    TRACE_FUNCTION("Parser");
+
     this->source = &source;
     current_token_index = 0;
     current_block_nesting = 0;
@@ -307,6 +310,8 @@ void Parser::gambit_error(string msg, initializer_list<Span> spans)
 
 void Parser::parse_program()
 {
+    TRACE_FUNCTION("Parser");
+
     program = CREATE(Program);
     program->global_scope = CREATE(Scope);
 
@@ -361,6 +366,8 @@ bool Parser::peek_code_block(bool singleton_allowed)
 
 ptr<CodeBlock> Parser::parse_code_block(ptr<Scope> scope)
 {
+    TRACE_FUNCTION("Parser");
+
     auto code_block = CREATE(CodeBlock);
     code_block->scope = CREATE(Scope);
     code_block->scope->parent = scope;
@@ -413,6 +420,8 @@ bool Parser::peek_enum_definition()
 
 void Parser::parse_enum_definition(ptr<Scope> scope)
 {
+    TRACE_FUNCTION("Parser");
+
     auto enum_type = CREATE(EnumType);
     auto union_pattern = CREATE(UnionPattern);
 
@@ -476,6 +485,8 @@ bool Parser::peek_entity_definition()
 
 void Parser::parse_entity_definition(ptr<Scope> scope)
 {
+    TRACE_FUNCTION("Parser");
+
     auto entity = CREATE(EntityType);
 
     start_span();
@@ -501,6 +512,8 @@ bool Parser::peek_state_property_definition()
 
 void Parser::parse_state_property_definition(ptr<Scope> scope)
 {
+    TRACE_FUNCTION("Parser");
+
     auto state = CREATE(StateProperty);
     state->scope = CREATE(Scope);
     state->scope->parent = scope;
@@ -556,6 +569,8 @@ bool Parser::peek_function_property_definition()
 
 void Parser::parse_function_property_definition(ptr<Scope> scope)
 {
+    TRACE_FUNCTION("Parser");
+
     auto funct = CREATE(FunctionProperty);
     funct->scope = CREATE(Scope);
     funct->scope->parent = scope;
@@ -611,6 +626,8 @@ bool Parser::peek_procedure_definition()
 
 void Parser::parse_procedure_definition(ptr<Scope> scope)
 {
+    TRACE_FUNCTION("Parser");
+
     if (!confirm(Token::Identity))
         return;
 
@@ -668,6 +685,8 @@ bool Parser::peek_statement()
 
 optional<Statement> Parser::parse_statement(ptr<Scope> scope, bool require_newline)
 {
+    TRACE_FUNCTION("Parser");
+
     Statement stmt;
     start_span();
 
@@ -936,6 +955,8 @@ bool Parser::peek_expression()
 
 Expression Parser::parse_expression(Precedence caller_precedence)
 {
+    TRACE_FUNCTION("Parser");
+
     // Prefix expressions
     Expression lhs;
 
@@ -2,10 +2,13 @@
 #include "intrinsic.h"
 #include "resolver.h"
 #include "source.h"
+#include "trace.h"
 #include <optional>
 
 void Resolver::resolve(Source &source, ptr<Program> program)
 {
+    TRACE_FUNCTION("Resolver");
+
     this->source = &source;
     resolve_program(program);
 }
@@ -14,11 +17,15 @@ void Resolver::resolve(Source &source, ptr<Program> program)
 
 void Resolver::resolve_program(ptr<Program> program)
 {
+    TRACE_FUNCTION("Resolver");
+
     resolve_scope(program->global_scope);
 }
 
 void Resolver::resolve_scope(ptr<Scope> scope)
 {
+    TRACE_FUNCTION("Resolver");
+
     for (auto index : scope->lookup)
     {
         auto value = index.second;
@@ -43,6 +50,7 @@ void Resolver::resolve_scope_lookup_value_property_signatures_pass(Scope::Lookup
     if (IS_PTR(value, StateProperty))
     {
         auto state = AS_PTR(value, StateProperty);
+        TRACE_FUNCTION_DETAIL("Resolver", state->identity);
         state->pattern = resolve_pattern(state->pattern, scope);
         resolve_scope(state->scope); // This will resolve the parameters
     }
@@ -50,6 +58,7 @@ void Resolver::resolve_scope_lookup_value_property_signatures_pass(Scope::Lookup
     else if (IS_PTR(value, FunctionProperty))
     {
         auto funct = AS_PTR(value, FunctionProperty);
+        TRACE_FUNCTION_DETAIL("Resolver", funct->identity);
         funct->pattern = resolve_pattern(funct->pattern, scope);
         resolve_scope(funct->scope); // This will resolve the parameters
     }
@@ -74,6 +83,7 @@ void Resolver::resolve_scope_lookup_value_final_pass(Scope::LookupValue value, p
     else if (IS_PTR(value, StateProperty))
     {
         auto state = AS_PTR(value, StateProperty);
+        TRACE_FUNCTION_DETAIL("Resolver", state->identity);
         if (state->initial_value.has_value())
             state->initial_value = resolve_expression(state->initial_value.value(), state->scope, state->pattern);
     }
@@ -81,6 +91,7 @@ void Resolver::resolve_scope_lookup_value_final_pass(Scope::LookupValue value, p
     else if (IS_PTR(value, FunctionProperty))
     {
         auto funct = AS_PTR(value, FunctionProperty);
+        TRACE_FUNCTION_DETAIL("Resolver", funct->identity);
         if (funct->body.has_value())
             resolve_code_block(funct->body.value(), funct->pattern);
 
@@ -90,6 +101,7 @@ void Resolver::resolve_scope_lookup_value_final_pass(Scope::LookupValue value, p
     else if (IS_PTR(value, Procedure))
     {
         auto funct = AS_PTR(value, Procedure);
+        TRACE_FUNCTION_DETAIL("Resolver", funct->identity);
         resolve_code_block(funct->body);
 
         // FIXME: If the body is a singleton, resolve the statement as if it were a return expression
@@ -105,6 +117,8 @@ void Resolver::resolve_scope_lookup_value_final_pass(Scope::LookupValue value, p
 
 void Resolver::resolve_code_block(ptr<CodeBlock> code_block, optional<Pattern> pattern_hint)
 {
+    TRACE_FUNCTION("Resolver");
+
     resolve_scope(code_block->scope);
 
     if (code_block->singleton_block)
@@ -131,38 +145,51 @@ void Resolver::resolve_code_block(ptr<CodeBlock> code_block, optional<Pattern> p
 
 Statement Resolver::resolve_statement(Statement stmt, ptr<Scope> scope, optional<Pattern> pattern_hint)
 {
-    if (IS(stmt, Expression))
+    TRACE_FUNCTION("Resolver");
+
+    switch (stmt.index())
+    {
+    case INDEX_OF(Statement, Expression):
         return resolve_expression(AS(stmt, Expression), scope, pattern_hint);
 
-    else if (IS_PTR(stmt, CodeBlock))
+    case INDEX_OF_PTR(Statement, CodeBlock):
         resolve_code_block(AS_PTR(stmt, CodeBlock), pattern_hint);
+        break;
 
-    else if (IS_PTR(stmt, IfStatement))
+    case INDEX_OF_PTR(Statement, IfStatement):
         resolve_if_statement(AS_PTR(stmt, IfStatement), scope, pattern_hint);
+        break;
 
-    else if (IS_PTR(stmt, ForStatement))
+    case INDEX_OF_PTR(Statement, ForStatement):
         resolve_for_statement(AS_PTR(stmt, ForStatement), scope, pattern_hint);
+        break;
 
-    else if (IS_PTR(stmt, LoopStatement))
+    case INDEX_OF_PTR(Statement, LoopStatement):
         resolve_loop_statement(AS_PTR(stmt, LoopStatement), scope, pattern_hint);
+        break;
 
-    else if (IS_PTR(stmt, ReturnStatement))
+    case INDEX_OF_PTR(Statement, ReturnStatement):
         resolve_return_statement(AS_PTR(stmt, ReturnStatement), scope, {}); // TODO: The pattern hint here should be the return type of the function
+        break;
 
-    else if (IS_PTR(stmt, WinsStatement))
+    case INDEX_OF_PTR(Statement, WinsStatement):
         resolve_wins_statement(AS_PTR(stmt, WinsStatement), scope);
+        break;
 
-    else if (IS_PTR(stmt, DrawStatement))
-        ; // skip
+    case INDEX_OF_PTR(Statement, DrawStatement):
+        break; // skip
 
-    else if (IS_PTR(stmt, AssignmentStatement))
+    case INDEX_OF_PTR(Statement, AssignmentStatement):
         resolve_assignment_statement(AS_PTR(stmt, AssignmentStatement), scope);
+        break;
 
-    else if (IS_PTR(stmt, VariableDeclaration))
+    case INDEX_OF_PTR(Statement, VariableDeclaration):
         resolve_variable_declaration(AS_PTR(stmt, VariableDeclaration), scope);
+        break;
 
-    else
+    default:
         throw CompilerError("Cannot resolve Statement variant.", get_span(stmt));
+    }
 
     return stmt;
 }
@@ -228,38 +255,52 @@ void Resolver::resolve_variable_declaration(ptr<VariableDeclaration> stmt, ptr<S
 
 Expression Resolver::resolve_expression(Expression expression, ptr<Scope> scope, optional<Pattern> pattern_hint)
 {
-    if (IS(expression, UnresolvedLiteral))
+    TRACE_FUNCTION("Resolver");
+
+    switch (expression.index())
+    {
+    case INDEX_OF(Expression, UnresolvedLiteral):
         return resolve_literal_as_expression(AS(expression, UnresolvedLiteral), scope, pattern_hint);
 
-    else if (IS_PTR(expression, ListValue))
+    case INDEX_OF_PTR(Expression, ListValue):
         resolve_list_value(AS_PTR(expression, ListValue), scope, pattern_hint);
+        break;
 
-    else if (IS_PTR(expression, InstanceList))
+    case INDEX_OF_PTR(Expression, InstanceList):
         resolve_instance_list(AS_PTR(expression, InstanceList), scope, pattern_hint);
+        break;
 
-    else if (IS_PTR(expression, Unary))
+    case INDEX_OF_PTR(Expression, Unary):
         resolve_unary(AS_PTR(expression, Unary), scope, pattern_hint);
+        break;
 
-    else if (IS_PTR(expression, Binary))
+    case INDEX_OF_PTR(Expression, Binary):
         resolve_binary(AS_PTR(expression, Binary), scope, pattern_hint);
+        break;
 
-    else if (IS_PTR(expression, IndexWithExpression))
+    case INDEX_OF_PTR(Expression, IndexWithExpression):
         resolve_index_with_expression(AS_PTR(expression, IndexWithExpression), scope, pattern_hint);
+        break;
 
-    else if (IS_PTR(expression, IndexWithIdentity))
+    case INDEX_OF_PTR(Expression, IndexWithIdentity):
         return resolve_index_with_identity(AS_PTR(expression, IndexWithIdentity), scope, pattern_hint);
 
-    else if (IS_PTR(expression, Call))
+    case INDEX_OF_PTR(Expression, Call):
         resolve_call(AS_PTR(expression, Call), scope, pattern_hint);
+        break;
 
-    else if (IS_PTR(expression, ChooseExpression))
+    case INDEX_OF_PTR(Expression, ChooseExpression):
         resolve_choose_expression(AS_PTR(expression, ChooseExpression), scope, pattern_hint);
+        break;
 
-    else if (IS_PTR(expression, IfExpression))
+    case INDEX_OF_PTR(Expression, IfExpression):
         resolve_if_expression(AS_PTR(expression, IfExpression), scope, pattern_hint);
+        break;
 
-    else if (IS_PTR(expression, MatchExpression))
+    case INDEX_OF_PTR(Expression, MatchExpression):
         resolve_match(AS_PTR(expression, MatchExpression), scope, pattern_hint);
+        break;
+    }
 
     return expression;
 }
@@ -396,6 +437,8 @@ void Resolver::resolve_if_expression(ptr<IfExpression> if_expression, ptr<Scope>
 
 void Resolver::resolve_match(ptr<MatchExpression> match, ptr<Scope> scope, optional<Pattern> pattern_hint)
 {
+    TRACE_FUNCTION("Resolver");
+
     match->subject = resolve_expression(match->subject, scope);
     auto subject_pattern = determine_expression_pattern(match->subject);
 
@@ -416,6 +459,8 @@ void Resolver::resolve_index_with_expression(ptr<IndexWithExpression> index_with
 //       all overloads that could match, and throw an error unless there is exactly one match.
 Expression Resolver::resolve_index_with_identity(ptr<IndexWithIdentity> index_with_identity, ptr<Scope> scope, optional<Pattern> pattern_hint)
 {
+    TRACE_FUNCTION_DETAIL("Resolver", index_with_identity->index->identity);
+
     // EnumValue
     // FIXME: At the moment we are doing a slight hack to work around the fact that an Expression
     //        node cannot be an EnumType, and thus resolve_expression will not resolve identities
@@ -546,6 +591,8 @@ void Resolver::resolve_binary(ptr<Binary> binary, ptr<Scope> scope, optional<Pat
 
 Pattern Resolver::resolve_pattern(Pattern pattern, ptr<Scope> scope, optional<Pattern> pattern_hint)
 {
+    TRACE_FUNCTION("Resolver");
+
     // Literals
     if (IS(pattern, UnresolvedLiteral))
         return resolve_literal_as_pattern(AS(pattern, UnresolvedLiteral), scope, pattern_hint);
@@ -681,9 +728,8 @@ ptr<PatternLiteral> Resolver::resolve_literal_as_pattern(UnresolvedLiteral unres
             auto inner_literal = AS(inner_expr, UnresolvedLiteral);
             list_type->list_of = resolve_literal_as_pattern(inner_literal, scope, pattern_hint);
 
-            // TODO: Resolve the 'fixed size' (once the resolver is done, there should be no UnresolvedLiterals)
             if (list_literal->values.size() == 2)
-                list_type->fixed_size = list_literal->values[1];
+                list_type->fixed_size = resolve_expression(list_literal->values[1], scope, Intrinsic::type_int);
 
             pattern_literal->pattern = list_type;
         }
@@ -0,0 +1,104 @@
+#include "thread-pool.h"
+
+ThreadPool::ThreadPool(size_t thread_count)
+{
+    for (size_t i = 1; i < thread_count; i++)
+        workers.emplace_back(&ThreadPool::work, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    batch_started.notify_all();
+
+    for (auto &worker : workers)
+        worker.join();
+}
+
+size_t ThreadPool::default_thread_count()
+{
+    // `hardware_concurrency` is allowed to return 0 if it cannot tell
+    size_t count = thread::hardware_concurrency();
+    return count > 0 ? count : 1;
+}
+
+void ThreadPool::run(size_t task_count, const function<void(size_t)> &task)
+{
+    if (task_count == 0)
+        return;
+
+    unique_lock<mutex> guard(lock);
+    this->task = &task;
+    this->task_count = task_count;
+    next_task = 0;
+    error = nullptr;
+    batch++;
+    batch_started.notify_all();
+
+    run_tasks(guard);
+
+    // Workers may still be part way through the last few tasks
+    batch_finished.wait(guard, [&]()
+                        { return active_workers == 0; });
+
+    this->task = nullptr;
+    auto batch_error = error;
+    error = nullptr;
+    guard.unlock();
+
+    if (batch_error)
+        rethrow_exception(batch_error);
+}
+
+void ThreadPool::work()
+{
+    size_t last_batch = 0;
+    unique_lock<mutex> guard(lock);
+
+    while (true)
+    {
+        batch_started.wait(guard, [&]()
+                           { return stopping || batch != last_batch; });
+        if (stopping)
+            return;
+
+        last_batch = batch;
+        active_workers++;
+        run_tasks(guard);
+        active_workers--;
+
+        if (active_workers == 0)
+            batch_finished.notify_all();
+    }
+}
+
+// Takes tasks from the current batch until there are none left. The lock is only held while
+// taking the next task, not while running it.
+void ThreadPool::run_tasks(unique_lock<mutex> &guard)
+{
+    while (next_task < task_count)
+    {
+        size_t index = next_task++;
+        guard.unlock();
+
+        exception_ptr task_error;
+        try
+        {
+            (*task)(index);
+        }
+        catch (...)
+        {
+            task_error = current_exception();
+        }
+
+        guard.lock();
+        if (task_error && !error)
+        {
+            error = task_error;
+            next_task = task_count;
+        }
+    }
+}
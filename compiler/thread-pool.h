@@ -0,0 +1,63 @@
+/*
+thread-pool.h
+
+A fixed set of worker threads that run batches of independent tasks. `run` hands out the task
+indexes 0 to task_count - 1 to the workers (and the calling thread) one at a time, and returns
+once every task has finished. Tasks are free to read shared data, but should only write to
+data that belongs to their own index.
+
+If any task throws, the remaining tasks are skipped and the first exception is rethrown from
+`run` on the calling thread, so a CompilerError raised by a worker is reported as usual.
+*/
+
+#pragma once
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+using namespace std;
+
+class ThreadPool
+{
+public:
+    // The calling thread also runs tasks, so a pool of N threads only starts N - 1 workers
+    ThreadPool(size_t thread_count);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    size_t thread_count() const { return workers.size() + 1; }
+
+    void run(size_t task_count, const function<void(size_t)> &task);
+
+    // The number of threads to use when none is specified
+    static size_t default_thread_count();
+
+private:
+    vector<thread> workers;
+
+    mutex lock;
+    condition_variable batch_started;
+    condition_variable batch_finished;
+
+    // Current batch
+    const function<void(size_t)> *task = nullptr;
+    size_t task_count = 0;
+    size_t next_task = 0;
+    size_t active_workers = 0;
+    size_t batch = 0;
+    exception_ptr error;
+    bool stopping = false;
+
+    void work();
+    void run_tasks(unique_lock<mutex> &guard);
+};
+
+#endif
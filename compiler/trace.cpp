@@ -0,0 +1,96 @@
+#include "trace.h"
+
+#ifdef GAMBIT_TRACE
+
+#include "json.h"
+#include <fstream>
+#include <iostream>
+#include <mutex>
+
+namespace Trace
+{
+    vector<Event> events;
+    static mutex events_lock;
+    static int thread_count = 0;
+
+    // All timestamps are measured relative to when the trace started,
+    // which is the first time a ScopedTimer is constructed.
+    static chrono::steady_clock::time_point trace_start()
+    {
+        static chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        return start;
+    }
+
+    static double microseconds_between(chrono::steady_clock::time_point start, chrono::steady_clock::time_point end)
+    {
+        return chrono::duration<double, micro>(end - start).count();
+    }
+
+    ScopedTimer::ScopedTimer(const char *category, const char *name, string detail)
+        : category(category),
+          name(name),
+          detail(detail)
+    {
+        trace_start();
+        start = chrono::steady_clock::now();
+    }
+
+    ScopedTimer::~ScopedTimer()
+    {
+        auto end = chrono::steady_clock::now();
+
+        lock_guard<mutex> guard(events_lock);
+        thread_local int thread = ++thread_count;
+        events.push_back({category,
+                          name,
+                          detail,
+                          microseconds_between(trace_start(), start),
+                          microseconds_between(start, end),
+                          thread});
+    }
+
+    void save(string file_path)
+    {
+        // Events are serialised using the Chrome "Trace Event Format", as a series of
+        // complete events (`"ph": "X"`) that each have a start time and a duration.
+        JsonContainer json;
+        json.object();
+        json.add("displayTimeUnit", string("ms"));
+        json.array("traceEvents");
+        for (const auto &event : events)
+        {
+            json.object();
+            json.add("name", string(event.name));
+            json.add("cat", string(event.category));
+            json.add("ph", string("X"));
+            json.add("ts", event.start);
+            json.add("dur", event.duration);
+            json.add("pid", 1);
+            json.add("tid", event.thread);
+            if (event.detail != "")
+            {
+                json.object("args");
+                json.add("detail", event.detail);
+                json.close();
+            }
+            json.close();
+        }
+        json.close();
+        json.close();
+
+        std::ofstream output;
+        output.open(file_path);
+        if (output.is_open())
+        {
+            output << (string)json;
+            cout << "Saved trace to " + file_path << endl;
+            output.close();
+        }
+        else
+        {
+            cout << "Error attempting to save trace to " + file_path << endl;
+        }
+    }
+}
+
+#endif
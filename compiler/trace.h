@@ -0,0 +1,77 @@
+/*
+trace.h
+
+Scoped timers used to profile the compiler. When the compiler is built with `GAMBIT_TRACE`
+defined, every `TRACE_*` macro records a Chrome trace event, and `TRACE_SAVE` writes them
+out as a trace file that can be opened in chrome://tracing or https://ui.perfetto.dev.
+Timers may be used from several threads at once, and each thread is shown on its own track.
+
+Without `GAMBIT_TRACE` the macros expand to nothing, and so their arguments are never
+evaluated. This means it is fine to pass in details that are expensive to compute.
+*/
+
+#pragma once
+#ifndef TRACE_H
+#define TRACE_H
+
+#ifdef GAMBIT_TRACE
+
+#include <chrono>
+#include <string>
+#include <vector>
+using namespace std;
+
+namespace Trace
+{
+    struct Event
+    {
+        const char *category;
+        const char *name;
+        string detail;
+        double start;    // Microseconds since the first event was recorded
+        double duration; // Microseconds
+        int thread;      // Numbered in the order threads first record an event
+    };
+
+    extern vector<Event> events;
+
+    class ScopedTimer
+    {
+    public:
+        ScopedTimer(const char *category, const char *name, string detail = "");
+        ~ScopedTimer();
+
+    private:
+        const char *category;
+        const char *name;
+        string detail;
+        chrono::steady_clock::time_point start;
+    };
+
+    void save(string file_path);
+}
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#define TRACE_SCOPE(category, name) Trace::ScopedTimer TRACE_CONCAT(_trace_timer_, __LINE__)(category, name)
+#define TRACE_SCOPE_DETAIL(category, name, detail) Trace::ScopedTimer TRACE_CONCAT(_trace_timer_, __LINE__)(category, name, detail)
+
+#define TRACE_FUNCTION(category) TRACE_SCOPE(category, __func__)
+#define TRACE_FUNCTION_DETAIL(category, detail) TRACE_SCOPE_DETAIL(category, __func__, detail)
+
+#define TRACE_SAVE(file_path) Trace::save(file_path)
+
+#else
+
+#define TRACE_SCOPE(category, name)
+#define TRACE_SCOPE_DETAIL(category, name, detail)
+
+#define TRACE_FUNCTION(category)
+#define TRACE_FUNCTION_DETAIL(category, detail)
+
+#define TRACE_SAVE(file_path)
+
+#endif
+
+#endif
@@ -0,0 +1,104 @@
+/*
+visitor.h
+
+Dispatch on the active alternative of a variant (Expression, Pattern, Statement, etc) by its
+index, rather than by testing each alternative in turn with IS/IS_PTR. An if-chain of IS_PTR
+tests costs one comparison per alternative that comes before the match, which adds up on the
+larger variants such as Expression. Both of the methods below cost a single indirect jump.
+
+INDEX_OF and INDEX_OF_PTR give the index of an alternative as a constant expression, so they
+can be used as the labels of a `switch` on `variant.index()`. The indexes are dense, so the
+compiler turns these switches into jump tables.
+
+    switch (expr.index())
+    {
+    case INDEX_OF_PTR(Expression, Unary):
+        return resolve_unary(AS_PTR(expr, Unary));
+    ...
+    }
+
+visit_node calls a visitor with the active alternative through a table of function pointers
+built at compile time. This is useful when most alternatives are handled in the same way,
+such as with a generic lambda. The `overloaded` helper can be used to combine several lambdas
+into a single visitor.
+*/
+
+#pragma once
+#ifndef VISITOR_H
+#define VISITOR_H
+
+#include "utilty.h"
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <variant>
+using namespace std;
+
+// Index of alternative
+
+template <typename T, typename Variant>
+struct variant_index;
+
+template <typename T, typename... Ts>
+struct variant_index<T, variant<Ts...>>
+{
+private:
+    static constexpr size_t find()
+    {
+        constexpr bool matches[] = {is_same_v<T, Ts>...};
+        for (size_t i = 0; i < sizeof...(Ts); i++)
+            if (matches[i])
+                return i;
+        return sizeof...(Ts);
+    }
+
+public:
+    static constexpr size_t value = find();
+    static_assert(value < sizeof...(Ts), "Type is not an alternative of the variant");
+};
+
+template <typename T, typename Variant>
+constexpr size_t variant_index_v = variant_index<T, remove_cv_t<remove_reference_t<Variant>>>::value;
+
+#define INDEX_OF(Variant, T) (variant_index_v<T, Variant>)
+#define INDEX_OF_PTR(Variant, T) (variant_index_v<ptr<T>, Variant>)
+
+// Visitors
+
+template <typename... Ts>
+struct overloaded : Ts...
+{
+    using Ts::operator()...;
+};
+
+template <typename... Ts>
+overloaded(Ts...) -> overloaded<Ts...>;
+
+template <size_t I, typename Result, typename Visitor, typename Variant>
+Result visit_alternative(Visitor &visitor, Variant &value)
+{
+    return visitor(*get_if<I>(&value));
+}
+
+template <typename Visitor, typename Variant, size_t... I>
+decltype(auto) visit_node(Variant &value, Visitor &visitor, index_sequence<I...>)
+{
+    using Result = invoke_result_t<Visitor &, decltype(*get_if<0>(&value))>;
+    using Entry = Result (*)(Visitor &, Variant &);
+    static constexpr Entry table[] = {&visit_alternative<I, Result, Visitor, Variant>...};
+
+    if (value.valueless_by_exception())
+        throw bad_variant_access();
+
+    return table[value.index()](visitor, value);
+}
+
+// Every alternative must be handled by the visitor, and each must return the same type.
+template <typename Variant, typename Visitor>
+decltype(auto) visit_node(Variant &value, Visitor &&visitor)
+{
+    constexpr size_t size = variant_size_v<remove_cv_t<Variant>>;
+    return visit_node(value, visitor, make_index_sequence<size>());
+}
+
+#endif
@@ -0,0 +1,120 @@
+/*
+affinity.h
+
+Pins search threads to CPUs, spreading them evenly across the NUMA nodes of the machine. Threads
+that are pinned stay on one node, so the memory they allocate and use is local to them, and is
+never passed between the caches of different sockets.
+
+The NUMA nodes are read from /sys on Linux, and from the Windows API on Windows. Elsewhere, and
+when the nodes cannot be read, every CPU is treated as belonging to a single node.
+*/
+
+#pragma once
+#ifndef GAMBIT_AFFINITY_H
+#define GAMBIT_AFFINITY_H
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <cstdio>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// The CPUs in each NUMA node
+inline std::vector<std::vector<uint32_t>> gambit_numa_nodes()
+{
+    std::vector<std::vector<uint32_t>> nodes;
+
+#if defined(_WIN32)
+    ULONG highest_node = 0;
+    if (GetNumaHighestNodeNumber(&highest_node))
+    {
+        for (ULONG node = 0; node <= highest_node; node++)
+        {
+            ULONGLONG mask = 0;
+            if (!GetNumaNodeProcessorMask((UCHAR)node, &mask) || mask == 0)
+                continue;
+
+            std::vector<uint32_t> cpus;
+            for (uint32_t cpu = 0; cpu < 64; cpu++)
+            {
+                if (mask & (1ull << cpu))
+                    cpus.push_back(cpu);
+            }
+            nodes.push_back(cpus);
+        }
+    }
+#elif defined(__linux__)
+    // Each node lists its CPUs as ranges, such as "0-15,32-47"
+    for (uint32_t node = 0;; node++)
+    {
+        char path[64];
+        std::snprintf(path, sizeof path, "/sys/devices/system/node/node%u/cpulist", node);
+        FILE *file = std::fopen(path, "r");
+        if (!file)
+            break;
+
+        std::vector<uint32_t> cpus;
+        unsigned first, last;
+        while (std::fscanf(file, "%u", &first) == 1)
+        {
+            last = first;
+            if (std::fscanf(file, "-%u", &last) != 1)
+                last = first;
+            for (uint32_t cpu = first; cpu <= last; cpu++)
+                cpus.push_back(cpu);
+            if (std::fgetc(file) != ',')
+                break;
+        }
+        std::fclose(file);
+
+        if (!cpus.empty())
+            nodes.push_back(cpus);
+    }
+#endif
+
+    if (nodes.empty())
+    {
+        std::vector<uint32_t> cpus;
+        for (uint32_t cpu = 0; cpu < std::max(std::thread::hardware_concurrency(), 1u); cpu++)
+            cpus.push_back(cpu);
+        nodes.push_back(cpus);
+    }
+
+    return nodes;
+}
+
+// The CPU for a thread, taking each node in turn so that threads are spread evenly across them
+inline uint32_t gambit_cpu_for_thread(const std::vector<std::vector<uint32_t>> &nodes, uint32_t thread_index)
+{
+    const auto &cpus = nodes[thread_index % nodes.size()];
+    return cpus[(thread_index / nodes.size()) % cpus.size()];
+}
+
+// Pins the calling thread to the CPU. Returns false if threads cannot be pinned on this platform.
+inline bool gambit_pin_thread(uint32_t cpu)
+{
+#if defined(_WIN32)
+    if (cpu >= 64)
+        return false;
+    return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) != 0;
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+#endif
@@ -0,0 +1,203 @@
+/*
+batch.h
+
+Many instances of the same game, played in lockstep for mass self-play. A batch stores the state
+of every instance (or lane) together as a structure of arrays: each column of the state becomes
+a GambitBatchColumn, in which the value of an entity in every lane is stored side by side. A step
+of the batch reads and writes the same property of every lane in turn, walking one array from
+start to end, so that the compiler can vectorise it. Entity tables, sparse maps, and anything else
+that is not a column are kept as one copy per lane.
+
+Generated programs declare a `GambitBatchState<Lanes>` with the same members as their
+GambitState, along with `gambit_batch_load` and `gambit_batch_store`, which move a single state
+into or out of one lane. Games that are played out in batches describe a step of every lane, as
+below, and are played with `gambit_batch_playouts`.
+
+    template <uint32_t Lanes> Batch                                The batch state of the game
+    step(Batch<Lanes> &, GambitBatchRandom<Lanes> &)               Makes a random move in every lane that has not ended
+
+Batches are only ever played forwards, so their writes are not journaled.
+*/
+
+#pragma once
+#ifndef GAMBIT_BATCH_H
+#define GAMBIT_BATCH_H
+
+#include "column.h"
+#include "entity.h"
+#include "random.h"
+#include "state.h"
+#include <cstdint>
+
+template <typename T, uint32_t Capacity, uint32_t Lanes>
+struct GambitBatchColumn
+{
+    T values[Capacity][Lanes];
+
+    // The value of the entity in every lane
+    T *operator[](GambitEntity entity) { return values[entity_index(entity)]; }
+    const T *operator[](GambitEntity entity) const { return values[entity_index(entity)]; }
+};
+
+template <uint32_t Lanes>
+struct GambitBatchOutcome
+{
+    bool ended[Lanes];
+    int8_t winner[Lanes];
+};
+
+// MOVING STATES INTO AND OUT OF LANES //
+
+template <typename T, uint32_t Lanes>
+inline void gambit_batch_load(T (&batch)[Lanes], uint32_t lane, const T &value) { batch[lane] = value; }
+
+template <typename T, uint32_t Lanes>
+inline void gambit_batch_store(T &value, const T (&batch)[Lanes], uint32_t lane) { value = batch[lane]; }
+
+template <typename T, uint32_t Capacity, uint32_t Lanes>
+inline void gambit_batch_load(GambitBatchColumn<T, Capacity, Lanes> &batch, uint32_t lane, const GambitColumn<T, Capacity> &column)
+{
+    for (uint32_t i = 0; i < Capacity; i++)
+        batch.values[i][lane] = column.values[i];
+}
+
+template <typename T, uint32_t Capacity, uint32_t Lanes>
+inline void gambit_batch_store(GambitColumn<T, Capacity> &column, const GambitBatchColumn<T, Capacity, Lanes> &batch, uint32_t lane)
+{
+    for (uint32_t i = 0; i < Capacity; i++)
+        column.values[i] = batch.values[i][lane];
+}
+
+template <uint32_t Lanes>
+inline void gambit_batch_load(GambitBatchOutcome<Lanes> &batch, uint32_t lane, const GambitOutcome &outcome)
+{
+    batch.ended[lane] = outcome.ended;
+    batch.winner[lane] = outcome.winner;
+}
+
+template <uint32_t Lanes>
+inline void gambit_batch_store(GambitOutcome &outcome, const GambitBatchOutcome<Lanes> &batch, uint32_t lane)
+{
+    outcome.ended = batch.ended[lane];
+    outcome.winner = batch.winner[lane];
+}
+
+// RANDOM NUMBERS //
+
+// A xoshiro256** generator for every lane, with each lane drawing from a stream of its own (see
+// random.h). The words of the generators are stored as a structure of arrays, so that drawing a
+// number for every lane at once can be vectorised.
+template <uint32_t Lanes>
+class GambitBatchRandom
+{
+public:
+    explicit GambitBatchRandom(uint64_t seed = 0)
+    {
+        GambitRandom stream(seed);
+        for (uint32_t lane = 0; lane < Lanes; lane++)
+        {
+            for (int i = 0; i < 4; i++)
+                state[i][lane] = stream.state[i];
+            stream.jump();
+        }
+    }
+
+    // A number from 0 to bounds[lane] - 1 for every lane, without bias, as GambitRandom::below
+    // does. A bound of 0 gives 0, so that lanes which have nothing to choose from can be included.
+    void below(const uint32_t *bounds, uint32_t *results)
+    {
+        uint32_t low[Lanes];
+        for (uint32_t lane = 0; lane < Lanes; lane++)
+        {
+            uint64_t product = (uint64_t)(uint32_t)(next(lane) >> 32) * bounds[lane];
+            results[lane] = (uint32_t)(product >> 32);
+            low[lane] = (uint32_t)product;
+        }
+
+        // Numbers that would be biased are rare, so they are drawn again one lane at a time
+        for (uint32_t lane = 0; lane < Lanes; lane++)
+        {
+            uint32_t bound = bounds[lane];
+            if (low[lane] >= bound)
+                continue;
+
+            uint32_t threshold = (uint32_t)(-bound) % bound;
+            while (low[lane] < threshold)
+            {
+                uint64_t product = (uint64_t)(uint32_t)(next(lane) >> 32) * bound;
+                results[lane] = (uint32_t)(product >> 32);
+                low[lane] = (uint32_t)product;
+            }
+        }
+    }
+
+private:
+    uint64_t state[4][Lanes];
+
+    uint64_t next(uint32_t lane)
+    {
+        uint64_t s0 = state[0][lane], s1 = state[1][lane], s2 = state[2][lane], s3 = state[3][lane];
+        uint64_t result = rotate(s1 * 5, 7) * 9;
+        uint64_t t = s1 << 17;
+        s2 ^= s0;
+        s3 ^= s1;
+        s1 ^= s2;
+        s0 ^= s3;
+        s2 ^= t;
+        s3 = rotate(s3, 45);
+        state[0][lane] = s0, state[1][lane] = s1, state[2][lane] = s2, state[3][lane] = s3;
+        return result;
+    }
+
+    static uint64_t rotate(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+};
+
+// PLAYOUTS //
+
+// Plays `games` games at random from the start state, with every lane of the batch playing one
+// game at a time. A lane starts its next game as soon as its last one ends, so that no lane sits
+// idle until there are no more games to start. `on_end(batch, lane)` is called as each game ends,
+// before the lane is reused.
+template <typename Game, uint32_t Lanes, typename OnEnd>
+inline void gambit_batch_playouts(typename Game::template Batch<Lanes> &batch, const typename Game::State &start, uint64_t games, GambitBatchRandom<Lanes> &random, OnEnd on_end)
+{
+    uint64_t started = 0;
+    uint64_t ended = 0;
+    bool active[Lanes];
+
+    // Lanes without a game are left as ended, so that steps skip them
+    for (uint32_t lane = 0; lane < Lanes; lane++)
+    {
+        active[lane] = started < games;
+        if (active[lane])
+        {
+            gambit_batch_load(batch, lane, start);
+            started++;
+        }
+        else
+            batch.outcome.ended[lane] = true;
+    }
+
+    while (ended < games)
+    {
+        Game::step(batch, random);
+
+        for (uint32_t lane = 0; lane < Lanes; lane++)
+        {
+            if (!active[lane] || !batch.outcome.ended[lane])
+                continue;
+
+            on_end(batch, lane);
+            ended++;
+
+            active[lane] = started < games;
+            if (active[lane])
+            {
+                gambit_batch_load(batch, lane, start);
+                started++;
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,32 @@
+/*
+column.h
+
+State properties with a single entity parameter are stored as a column: a dense array with one
+value for each index in the entity table, so that reading a property is a single load. Scanning
+a property across every entity of a type walks one array from start to end.
+*/
+
+#pragma once
+#ifndef GAMBIT_COLUMN_H
+#define GAMBIT_COLUMN_H
+
+#include "entity.h"
+#include <cstdint>
+
+template <typename T, uint32_t Capacity = GAMBIT_ENTITY_CAPACITY>
+struct GambitColumn
+{
+    T values[Capacity];
+
+    T &operator[](GambitEntity entity) { return values[entity_index(entity)]; }
+    const T &operator[](GambitEntity entity) const { return values[entity_index(entity)]; }
+
+    // Sets the value for every index, such as to the property's initial value
+    void fill(const T &value)
+    {
+        for (uint32_t i = 0; i < Capacity; i++)
+            values[i] = value;
+    }
+};
+
+#endif
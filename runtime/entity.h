@@ -0,0 +1,105 @@
+/*
+entity.h
+
+Entities are referred to by generational ids. The low bits of an id are the entity's index in
+the table of its entity type, which is also its index into every state property column of that
+type. The high bits are the generation of that index, which is increased each time an entity is
+destroyed, so that ids of destroyed entities can be told apart from the entity that reuses their
+index. The id 0 is never given to an entity, and is used to represent `none`.
+
+Entity tables have a fixed capacity and contain no pointers, so that they can be stored directly
+inside of the game state and copied along with it.
+*/
+
+#pragma once
+#ifndef GAMBIT_ENTITY_H
+#define GAMBIT_ENTITY_H
+
+#include <cstdint>
+
+// The maximum number of entities of each type that can exist at once
+#ifndef GAMBIT_ENTITY_CAPACITY
+#define GAMBIT_ENTITY_CAPACITY 256
+#endif
+
+constexpr uint32_t GAMBIT_INDEX_BITS = 24;
+constexpr uint32_t GAMBIT_INDEX_MASK = (1u << GAMBIT_INDEX_BITS) - 1;
+constexpr uint32_t GAMBIT_GENERATION_MASK = 0xFF;
+
+static_assert(GAMBIT_ENTITY_CAPACITY <= GAMBIT_INDEX_MASK + 1, "Entity indexes must fit in the index bits of an id");
+
+struct GambitEntity
+{
+    uint32_t id;
+
+    bool operator==(GambitEntity other) const { return id == other.id; }
+    bool operator!=(GambitEntity other) const { return id != other.id; }
+    explicit operator bool() const { return id != 0; }
+};
+
+constexpr GambitEntity GAMBIT_NO_ENTITY = {0};
+
+inline uint32_t entity_index(GambitEntity entity) { return entity.id & GAMBIT_INDEX_MASK; }
+inline uint32_t entity_generation(GambitEntity entity) { return entity.id >> GAMBIT_INDEX_BITS; }
+
+inline GambitEntity make_entity(uint32_t index, uint32_t generation)
+{
+    return {(generation << GAMBIT_INDEX_BITS) | index};
+}
+
+// A zero-initialised table is empty and ready to use
+template <uint32_t Capacity = GAMBIT_ENTITY_CAPACITY>
+struct GambitEntityTable
+{
+    uint32_t count;      // Number of indexes that have ever been used
+    uint32_t free_count; // Number of destroyed indexes waiting to be reused
+    uint8_t generations[Capacity];
+    bool alive[Capacity];
+    uint32_t free_indexes[Capacity];
+
+    static constexpr uint32_t capacity() { return Capacity; }
+
+    // Returns GAMBIT_NO_ENTITY if the table is full
+    GambitEntity create()
+    {
+        uint32_t index;
+        if (free_count > 0)
+            index = free_indexes[--free_count];
+        else if (count < Capacity)
+            index = count++;
+        else
+            return GAMBIT_NO_ENTITY;
+
+        // Generation 0 is skipped so that index 0 never gives the id 0
+        if (generations[index] == 0)
+            generations[index] = 1;
+
+        alive[index] = true;
+        return make_entity(index, generations[index]);
+    }
+
+    void destroy(GambitEntity entity)
+    {
+        if (!is_alive(entity))
+            return;
+
+        uint32_t index = entity_index(entity);
+        alive[index] = false;
+        generations[index] = (uint8_t)(generations[index] + 1);
+        if (generations[index] == 0)
+            generations[index] = 1;
+
+        free_indexes[free_count++] = index;
+    }
+
+    bool is_alive(GambitEntity entity) const
+    {
+        uint32_t index = entity_index(entity);
+        return entity.id != 0 && index < count && alive[index] && generations[index] == entity_generation(entity);
+    }
+
+    // The id of the entity currently at an index, which must be alive
+    GambitEntity at(uint32_t index) const { return make_entity(index, generations[index]); }
+};
+
+#endif
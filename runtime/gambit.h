@@ -0,0 +1,49 @@
+/*
+gambit.h
+
+The runtime library that generated games are compiled against. Generated programs include this
+header, and declare a `GambitState` struct that holds the storage for every entity type and
+state property in the game.
+
+The capacity of each entity type can be set when compiling a generated program by defining
+GAMBIT_CAPACITY_<Entity>, such as `-DGAMBIT_CAPACITY_Player=2`. Smaller capacities give a
+smaller state, which is quicker to clone. Types without one use GAMBIT_ENTITY_CAPACITY. The
+sparse map of each property with several entity parameters is sized from the capacities of those
+entities in the same way, and can be set with GAMBIT_SPARSE_CAPACITY_<property> (see sparse.h).
+
+The runtime also contains a Monte-Carlo tree search player (see mcts.h), which searches any
+game that describes its decisions in the way mcts.h expects. Each `choose` is lowered to a call
+to `gambit_choose`, which generates its moves without allocating (see moves.h). Games are played
+out at random by setting `gambit_policy` to `gambit_random_policy`, with a seedable generator
+from random.h that `shuffle` also uses. Games with hidden information are searched with ismcts.h,
+which only uses what hidden.h declares that the searching player can see. For mass self-play,
+batch.h plays many instances of a game at once in lockstep, from a `GambitBatchState` that
+stores each column of the state across every instance. Programs with a `main` can be run with
+`--selfplay N` to play N games between random players (see selfplay.h).
+
+The runtime is header only, so that the compiler does not have to know where a prebuilt copy of
+it lives. Compile generated programs with the runtime directory on the include path:
+
+    g++ -O2 --std=c++17 -I runtime local/generated.c
+*/
+
+#pragma once
+#ifndef GAMBIT_H
+#define GAMBIT_H
+
+#include "batch.h"
+#include "column.h"
+#include "entity.h"
+#include "hidden.h"
+#include "ismcts.h"
+#include "journal.h"
+#include "list.h"
+#include "match.h"
+#include "mcts.h"
+#include "moves.h"
+#include "random.h"
+#include "selfplay.h"
+#include "sparse.h"
+#include "state.h"
+
+#endif
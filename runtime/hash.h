@@ -0,0 +1,203 @@
+/*
+hash.h
+
+An incremental Zobrist hash of the game state, so that a search can recognise a state it has
+already seen, even if it was reached through a different order of moves.
+
+The hash covers what the state holds, rather than every byte of it, as much of the state depends
+on the order that things happened in:
+
+- Entity tables only contribute which indexes are alive, and not the counts and free list used
+  to hand indexes out.
+- Lists contribute their length and the items within it, and not the items left over beyond it.
+- Each entry of a sparse map contributes a key made from its key and value, wherever in the map
+  it was placed, and the map's count contributes nothing.
+
+Anything else is hashed as its bytes: each non-zero byte contributes a key chosen by its offset in
+the state and its value, so values should not contain padding. Keys are made by mixing the offset
+and value, rather than being looked up in a table of random numbers, as a table would need 256
+keys for every byte of the state. Zero bytes contribute nothing, so a zero-initialised state has
+a hash of 0, and the hash is all of the keys XORed together.
+
+Entity ids include a generation, and columns keep the values of entities that were destroyed, so
+states in which entities were destroyed (or their indexes reused) in a different order can still
+have different hashes.
+
+The state is hashed by `gambit_hash`, which is overloaded for each of the types above. Generated
+programs overload it for their GambitState to hash each member in turn, and games written by hand
+should do the same. A state without an overload is hashed as its bytes.
+
+While `gambit_hasher` is set, every write made through the functions in journal.h XORs out the
+keys of what it is about to change, and XORs in the keys of its new contents. Rolling back the
+journal does not, as searches only ever roll back to a state whose hash they already know. Games
+that are never searched with transpositions can be compiled with GAMBIT_NO_HASH, which removes
+the check.
+*/
+
+#pragma once
+#ifndef GAMBIT_HASH_H
+#define GAMBIT_HASH_H
+
+#include "column.h"
+#include "entity.h"
+#include "list.h"
+#include "sparse.h"
+#include <cstddef>
+#include <cstdint>
+
+inline uint64_t gambit_hash_key(uint64_t offset, uint8_t byte)
+{
+    uint64_t key = ((offset << 8) | byte) * 0x9E3779B97F4A7C15ull;
+    key ^= key >> 32;
+    key *= 0xD6E8FEB86659FD93ull;
+    key ^= key >> 32;
+    return key;
+}
+
+class GambitHasher
+{
+public:
+    uint64_t value = 0;
+
+    // Hashes the whole state from scratch, and then follows writes to it
+    template <typename State>
+    void reset(const State &state)
+    {
+        base = reinterpret_cast<const unsigned char *>(&state);
+        size = sizeof(State);
+        value = 0;
+        gambit_hash(*this, state);
+    }
+
+    // XORs the keys of the bytes at the address into the hash. Doing this once before a write
+    // and once after it replaces the keys of the old bytes with the keys of the new ones.
+    void update(const void *address, size_t length)
+    {
+        const unsigned char *bytes = static_cast<const unsigned char *>(address);
+        if (bytes < base || bytes + length > base + size)
+            return;
+
+        size_t offset = (size_t)(bytes - base);
+        for (size_t i = 0; i < length; i++)
+        {
+            if (bytes[i] != 0)
+                value ^= gambit_hash_key(offset + i, bytes[i]);
+        }
+    }
+
+    // XORs the key of an entry of a sparse map into the hash, which is made from the offset of the
+    // map and the bytes of the entry's key and value, but not from where the entry is in the map
+    void update_entry(const void *map, const void *key, size_t key_length, const void *entry_value, size_t value_length)
+    {
+        const unsigned char *address = static_cast<const unsigned char *>(map);
+        if (address < base || address >= base + size)
+            return;
+
+        uint64_t entry = (uint64_t)(address - base);
+        const unsigned char *key_bytes = static_cast<const unsigned char *>(key);
+        for (size_t i = 0; i < key_length; i++)
+            entry = gambit_hash_key(entry, key_bytes[i]);
+        const unsigned char *value_bytes = static_cast<const unsigned char *>(entry_value);
+        for (size_t i = 0; i < value_length; i++)
+            entry = gambit_hash_key(entry, value_bytes[i]);
+
+        value ^= entry;
+    }
+
+private:
+    const unsigned char *base = nullptr;
+    size_t size = 0;
+};
+
+// WHAT IS HASHED //
+
+// Values without an overload of their own are hashed as their bytes
+template <typename T>
+inline void gambit_hash(GambitHasher &hasher, const T &value)
+{
+    hasher.update(&value, sizeof(T));
+}
+
+template <typename T, uint32_t Capacity>
+inline void gambit_hash(GambitHasher &hasher, const GambitColumn<T, Capacity> &column)
+{
+    for (uint32_t i = 0; i < Capacity; i++)
+        gambit_hash(hasher, column.values[i]);
+}
+
+template <typename T, uint32_t Capacity>
+inline void gambit_hash(GambitHasher &hasher, const GambitList<T, Capacity> &list)
+{
+    gambit_hash(hasher, list.length);
+    for (uint32_t i = 0; i < list.length; i++)
+        gambit_hash(hasher, list.items[i]);
+}
+
+template <uint32_t Capacity>
+inline void gambit_hash(GambitHasher &hasher, const GambitEntityTable<Capacity> &table)
+{
+    hasher.update(table.alive, sizeof(table.alive));
+}
+
+template <typename T, uint32_t N, uint32_t Capacity>
+inline void gambit_hash_entry(GambitHasher &hasher, const GambitSparseMap<T, N, Capacity> &map, uint32_t slot)
+{
+    hasher.update_entry(&map, &map.keys[slot], sizeof(GambitKey<N>), &map.values[slot], sizeof(T));
+}
+
+template <typename T, uint32_t N, uint32_t Capacity>
+inline void gambit_hash(GambitHasher &hasher, const GambitSparseMap<T, N, Capacity> &map)
+{
+    for (uint32_t slot = 0; slot < Capacity; slot++)
+    {
+        if (map.keys[slot].ids[0] != 0)
+            gambit_hash_entry(hasher, map, slot);
+    }
+}
+
+// FOLLOWING WRITES //
+
+inline thread_local GambitHasher *gambit_hasher = nullptr;
+
+// Makes the hasher the one that follows writes on this thread, until it is destroyed
+class GambitHashScope
+{
+public:
+    explicit GambitHashScope(GambitHasher &hasher)
+        : previous(gambit_hasher) { gambit_hasher = &hasher; }
+    ~GambitHashScope() { gambit_hasher = previous; }
+
+    GambitHashScope(const GambitHashScope &) = delete;
+    GambitHashScope &operator=(const GambitHashScope &) = delete;
+
+private:
+    GambitHasher *previous;
+};
+
+inline void gambit_hash_update(const void *address, size_t length)
+{
+#ifndef GAMBIT_NO_HASH
+    if (gambit_hasher)
+        gambit_hasher->update(address, length);
+#endif
+}
+
+template <typename T>
+inline void gambit_hash_update(const T &target)
+{
+#ifndef GAMBIT_NO_HASH
+    if (gambit_hasher)
+        gambit_hash(*gambit_hasher, target);
+#endif
+}
+
+template <typename T, uint32_t N, uint32_t Capacity>
+inline void gambit_hash_update(const GambitSparseMap<T, N, Capacity> &map, uint32_t slot)
+{
+#ifndef GAMBIT_NO_HASH
+    if (gambit_hasher)
+        gambit_hash_entry(*gambit_hasher, map, slot);
+#endif
+}
+
+#endif
@@ -0,0 +1,80 @@
+/*
+hidden.h
+
+Games with hidden information declare which parts of the state a player cannot see, so that a
+search for that player (see ismcts.h) does not make use of them. Each game lists the slots of
+the state whose items are hidden from the player, such as the cards of a face down deck, and a
+determinisation deals the hidden items back out into those slots in a random order.
+
+Every order of the hidden items is consistent with what the player can see, as it can see how
+many items each list holds, and every item that is not hidden. Writes go through gambit_write,
+so a determinisation can be rolled back with the journal.
+*/
+
+#pragma once
+#ifndef GAMBIT_HIDDEN_H
+#define GAMBIT_HIDDEN_H
+
+#include "journal.h"
+#include "list.h"
+#include "random.h"
+#include <cstdint>
+
+template <typename T, uint32_t Capacity>
+class GambitHidden
+{
+public:
+    // The item in the slot cannot be seen. Slots past the capacity are left visible.
+    void hide(T &slot)
+    {
+        if (count < Capacity)
+            slots[count++] = &slot;
+    }
+
+    // None of the items of the list can be seen
+    template <uint32_t ListCapacity>
+    void hide_all(GambitList<T, ListCapacity> &list)
+    {
+        for (uint32_t i = 0; i < list.length; i++)
+            hide(list.items[i]);
+    }
+
+    // The items of the list that the predicate is true for cannot be seen
+    template <uint32_t ListCapacity, typename Predicate>
+    void hide_if(GambitList<T, ListCapacity> &list, Predicate predicate)
+    {
+        for (uint32_t i = 0; i < list.length; i++)
+        {
+            if (predicate(list.items[i]))
+                hide(list.items[i]);
+        }
+    }
+
+    // Deals the hidden items back out into their slots in a random order
+    void deal(GambitRandom &random)
+    {
+        for (uint32_t i = 0; i < count; i++)
+            items[i] = *slots[i];
+
+        for (uint32_t i = count; i > 1; i--)
+        {
+            uint32_t j = random.below(i);
+            T item = items[i - 1];
+            items[i - 1] = items[j];
+            items[j] = item;
+        }
+
+        for (uint32_t i = 0; i < count; i++)
+            gambit_write(*slots[i], items[i]);
+    }
+
+    void clear() { count = 0; }
+    uint32_t size() const { return count; }
+
+private:
+    T *slots[Capacity];
+    T items[Capacity];
+    uint32_t count = 0;
+};
+
+#endif
@@ -0,0 +1,263 @@
+/*
+ismcts.h
+
+An information set Monte-Carlo tree search player, for games where players cannot see all of
+the state. The search only uses what the searching player can see: at the start of each
+iteration, the hidden parts of the root state are dealt out at random (a determinisation, see
+hidden.h), and the iteration plays through that. Every determinisation shares one tree, in which
+each node stands for every state the searching player cannot tell apart.
+
+Games are given to the search in the same way as to mcts.h, with two more members:
+
+    Hidden                                     A GambitHidden with room for every hidden item
+    hide(State &, uint32_t, Hidden &)          Declares the slots of the state that a player cannot see
+
+Which moves can be made at a node can differ between determinisations, so the children of a node
+are added as their moves are first seen, and are kept in a linked list. Each child counts how
+many times it could have been chosen, and UCT uses that in place of the visits of the parent.
+
+The search runs on the calling thread. Determinisations are cloned from the root, or rolled back
+with the journal, in the same way as mcts.h gets back to the root.
+*/
+
+#pragma once
+#ifndef GAMBIT_ISMCTS_H
+#define GAMBIT_ISMCTS_H
+
+#include "hidden.h"
+#include "journal.h"
+#include "mcts.h"
+#include "random.h"
+#include "state.h"
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct GambitInformationNode
+{
+    uint32_t move;
+    uint32_t first_child; // UINT32_MAX if there are none
+    uint32_t next_sibling;
+    uint32_t visits;
+    uint32_t availability; // How many times this node could have been chosen from its parent
+    float value;           // The total outcome of each visit, for `player`
+    uint8_t player;        // The player that chose the move into this node
+};
+
+template <typename Game>
+class GambitISMCTS
+{
+    static_assert(Game::PLAYER_COUNT <= UINT8_MAX, "Players are stored in nodes with 8 bits");
+
+public:
+    using State = typename Game::State;
+
+    // Only the budget, exploration, maximum number of nodes and seed are used
+    explicit GambitISMCTS(GambitSearchOptions options = {})
+        : options(options), nodes(new GambitInformationNode[options.max_nodes]), random(options.seed), state(new State), hidden(new typename Game::Hidden) {}
+
+    // Searches for the player making the next decision, and returns the move that was explored
+    // the most of those that can be made from the root. The game must not have ended, and must
+    // have a legal move.
+    uint32_t search(const State &root)
+    {
+        auto start = std::chrono::steady_clock::now();
+        stats = {};
+        node_count = 0;
+        uint32_t root_node = create_node(0, (uint8_t)Game::current_player(root));
+        uint32_t observer = Game::current_player(root);
+
+        if (Game::undo == GambitUndo::JOURNAL)
+            gambit_clone(*state, root);
+
+        while (!budget_spent(start))
+        {
+            if (Game::undo == GambitUndo::JOURNAL)
+            {
+                GambitJournalScope scope(journal);
+                determinise(observer);
+                iterate(root_node);
+                journal.rollback(0);
+            }
+            else
+            {
+                gambit_clone(*state, root);
+                determinise(observer);
+                iterate(root_node);
+            }
+            stats.iterations++;
+        }
+
+        stats.nodes = node_count;
+        stats.threads = 1;
+        stats.root_visits = nodes[root_node].visits;
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return best_move(root, root_node);
+    }
+
+    const GambitSearchStats &last_stats() const { return stats; }
+
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+    static constexpr uint32_t MAX_DEPTH = 256;
+
+    GambitSearchOptions options;
+    GambitSearchStats stats;
+    std::unique_ptr<GambitInformationNode[]> nodes;
+    uint32_t node_count = 0;
+
+    GambitRandom random;
+    std::unique_ptr<State> state; // The determinisation that each iteration plays out in
+    std::unique_ptr<typename Game::Hidden> hidden;
+    GambitJournal journal;
+    uint32_t moves[Game::MAX_MOVES];
+    uint32_t untried[Game::MAX_MOVES];
+
+    // Indexed by move. A move is legal, or has a child, at the current node if its entry is the
+    // current stamp, so that they do not need to be cleared between nodes.
+    std::vector<uint32_t> legal;
+    std::vector<uint32_t> tried;
+    uint32_t stamp = 0;
+
+    bool budget_spent(std::chrono::steady_clock::time_point start) const
+    {
+        const auto &budget = options.budget;
+        if (budget.iterations > 0 && stats.iterations >= budget.iterations)
+            return true;
+
+        return budget.seconds > 0 && stats.iterations % 64 == 0 &&
+               std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() >= budget.seconds;
+    }
+
+    void determinise(uint32_t observer)
+    {
+        hidden->clear();
+        Game::hide(*state, observer, *hidden);
+        hidden->deal(random);
+    }
+
+    uint32_t create_node(uint32_t move, uint8_t player)
+    {
+        if (node_count >= options.max_nodes)
+            return NONE;
+
+        GambitInformationNode &node = nodes[node_count];
+        node.move = move;
+        node.first_child = NONE;
+        node.next_sibling = NONE;
+        node.visits = 0;
+        node.availability = 1;
+        node.value = 0;
+        node.player = player;
+        return node_count++;
+    }
+
+    void iterate(uint32_t root_node)
+    {
+        uint32_t path[MAX_DEPTH];
+        uint32_t depth = 0;
+        uint32_t node = root_node;
+        path[depth++] = node;
+
+        while (depth < MAX_DEPTH && !Game::is_terminal(*state))
+        {
+            uint32_t count = Game::legal_moves(*state, moves);
+            stamp++;
+            for (uint32_t i = 0; i < count; i++)
+            {
+                if (moves[i] >= legal.size())
+                {
+                    legal.resize(moves[i] + 1, 0);
+                    tried.resize(moves[i] + 1, 0);
+                }
+                legal[moves[i]] = stamp;
+            }
+
+            // The children that can be chosen in this determinisation
+            uint32_t best = NONE;
+            double best_score = -1;
+            for (uint32_t child = nodes[node].first_child; child != NONE; child = nodes[child].next_sibling)
+            {
+                GambitInformationNode &candidate = nodes[child];
+                if (candidate.move >= legal.size() || legal[candidate.move] != stamp)
+                    continue;
+
+                tried[candidate.move] = stamp;
+                candidate.availability++;
+                double mean = candidate.value / candidate.visits;
+                double score = mean + options.exploration * std::sqrt(std::log((double)candidate.availability) / candidate.visits);
+                if (score > best_score)
+                {
+                    best = child;
+                    best_score = score;
+                }
+            }
+
+            // Moves that have not been tried yet are always tried first, which ends the selection
+            uint32_t untried_count = 0;
+            for (uint32_t i = 0; i < count; i++)
+            {
+                if (tried[moves[i]] != stamp)
+                    untried[untried_count++] = moves[i];
+            }
+
+            if (untried_count > 0)
+            {
+                uint32_t move = untried[random.below(untried_count)];
+                uint32_t child = create_node(move, (uint8_t)Game::current_player(*state));
+                Game::apply(*state, move);
+                if (child != NONE)
+                {
+                    nodes[child].next_sibling = nodes[node].first_child;
+                    nodes[node].first_child = child;
+                    path[depth++] = child;
+                }
+                break;
+            }
+
+            if (best == NONE)
+                break;
+            Game::apply(*state, nodes[best].move);
+            node = best;
+            path[depth++] = node;
+        }
+
+        gambit_playout<Game>(*state, random, moves);
+
+        for (uint32_t i = 0; i < depth; i++)
+        {
+            GambitInformationNode &visited = nodes[path[i]];
+            visited.visits++;
+            visited.value += (float)Game::outcome(*state, visited.player);
+        }
+    }
+
+    // Moves that were only legal in some determinisations cannot be made from the real state
+    uint32_t best_move(const State &root, uint32_t root_node)
+    {
+        uint32_t count = Game::legal_moves(root, moves);
+        uint32_t best = count > 0 ? moves[0] : 0;
+        uint32_t best_visits = 0;
+        for (uint32_t child = nodes[root_node].first_child; child != NONE; child = nodes[child].next_sibling)
+        {
+            const GambitInformationNode &candidate = nodes[child];
+            if (candidate.visits <= best_visits)
+                continue;
+
+            for (uint32_t i = 0; i < count; i++)
+            {
+                if (moves[i] == candidate.move)
+                {
+                    best = candidate.move;
+                    best_visits = candidate.visits;
+                    break;
+                }
+            }
+        }
+        return best;
+    }
+};
+
+#endif
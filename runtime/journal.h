@@ -0,0 +1,290 @@
+/*
+journal.h
+
+A search explores a game by applying a move to a state, and then going back to the state it
+started from. Cloning the state before each move (see state.h) costs the size of the whole
+state, which for a card game with a large deck is far more than the handful of values a move
+changes. The journal instead records the old value of everything that is written to, so that the
+state can be rolled back to a checkpoint in time proportional to the number of writes.
+
+Generated programs write to the game state through the functions below. While `gambit_journal`
+is set, these record into it before each write. Otherwise, they are plain writes. Games that are
+only ever searched by cloning can be compiled with GAMBIT_NO_JOURNAL, which removes the check.
+
+The same functions keep the hash of the state up to date (see hash.h). Each write makes a
+`gambit_record` of the bytes it is about to change, and is surrounded by a `gambit_rehash` of the
+contents it changes, which takes them out of the hash before the write and puts them back after.
+*/
+
+#pragma once
+#ifndef GAMBIT_JOURNAL_H
+#define GAMBIT_JOURNAL_H
+
+#include "entity.h"
+#include "hash.h"
+#include "list.h"
+#include "sparse.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+// How a search gets back to a state after applying a move to it. Each game picks whichever
+// suits the size of its state.
+enum class GambitUndo
+{
+    CLONE,   // Apply moves to a clone of the state, and throw the clone away
+    JOURNAL, // Apply moves to the state itself, and roll back the journal
+};
+
+class GambitJournal
+{
+public:
+    using Checkpoint = size_t;
+
+    // Records the current value of the bytes at the address, which will be restored by rolling
+    // back to any checkpoint taken before now
+    void record(void *address, uint32_t size)
+    {
+        Entry entry;
+        entry.address = address;
+        entry.size = size;
+
+        // Most writes are a single value, which is stored in the entry itself
+        if (size <= sizeof(entry.value))
+        {
+            std::memcpy(&entry.value, address, size);
+        }
+        else
+        {
+            entry.value = bytes.size();
+            bytes.resize(bytes.size() + size);
+            std::memcpy(&bytes[entry.value], address, size);
+        }
+
+        entries.push_back(entry);
+    }
+
+    Checkpoint checkpoint() const { return entries.size(); }
+
+    // Undoes every write recorded since the checkpoint, most recent first
+    void rollback(Checkpoint checkpoint)
+    {
+        while (entries.size() > checkpoint)
+        {
+            const Entry &entry = entries.back();
+            if (entry.size <= sizeof(entry.value))
+            {
+                std::memcpy(entry.address, &entry.value, entry.size);
+            }
+            else
+            {
+                std::memcpy(entry.address, &bytes[entry.value], entry.size);
+                bytes.resize(entry.value);
+            }
+            entries.pop_back();
+        }
+    }
+
+    // Forgets every write, keeping the memory that has been allocated for recording them
+    void clear()
+    {
+        entries.clear();
+        bytes.clear();
+    }
+
+    size_t size() const { return entries.size(); }
+
+private:
+    struct Entry
+    {
+        void *address;
+        uint32_t size;
+        uint64_t value; // The old value, or the offset of it in `bytes` if it is too large
+    };
+
+    std::vector<Entry> entries;
+    std::vector<unsigned char> bytes;
+};
+
+inline thread_local GambitJournal *gambit_journal = nullptr;
+
+// Makes the journal the one that writes on this thread are recorded into, until it is destroyed
+class GambitJournalScope
+{
+public:
+    explicit GambitJournalScope(GambitJournal &journal)
+        : previous(gambit_journal) { gambit_journal = &journal; }
+    ~GambitJournalScope() { gambit_journal = previous; }
+
+    GambitJournalScope(const GambitJournalScope &) = delete;
+    GambitJournalScope &operator=(const GambitJournalScope &) = delete;
+
+private:
+    GambitJournal *previous;
+};
+
+// Called before the bytes at the address are written to
+inline void gambit_record(void *address, uint32_t size)
+{
+#ifndef GAMBIT_NO_JOURNAL
+    if (gambit_journal)
+        gambit_journal->record(address, size);
+#endif
+}
+
+template <typename T>
+inline void gambit_record(T &target)
+{
+    gambit_record(&target, sizeof(T));
+}
+
+// Called before and after a write to the target, with its contents the same as they are hashed
+template <typename T>
+inline void gambit_rehash(const T &target)
+{
+    gambit_hash_update(target);
+}
+
+// The value does not take part in deducing T, so that `gambit_write(x, { })` resets x
+template <typename T>
+inline void gambit_write(T &target, const std::common_type_t<T> &value)
+{
+    gambit_record(target);
+    gambit_rehash(target);
+    target = value;
+    gambit_rehash(target);
+}
+
+// Sets a value in a sparse map. Rolling back removes keys that were added, which keeps the probe
+// sequences of the map intact, as keys are always removed in the reverse of the order they were
+// added in. There is nowhere else to keep the value of a new key once the map is full, so the
+// program is aborted, rather than carrying on with a state that is missing a write.
+template <typename T, uint32_t N, uint32_t Capacity>
+inline void gambit_set(GambitSparseMap<T, N, Capacity> &map, const GambitKey<N> &key, const std::common_type_t<T> &value)
+{
+    uint32_t slot = map.find(key);
+    if (map.keys[slot].ids[0] == 0)
+    {
+        if (map.count >= map.capacity())
+        {
+            std::fprintf(stderr, "A sparse map of %u entries is full. Define a larger GAMBIT_SPARSE_CAPACITY_<property> for it.\n", map.capacity());
+            std::abort();
+        }
+        gambit_record(map.count);
+        gambit_record(map.keys[slot]);
+        map.keys[slot] = key;
+        map.count++;
+    }
+    else
+    {
+        gambit_hash_update(map, slot);
+    }
+
+    gambit_record(map.values[slot]);
+    map.values[slot] = value;
+    gambit_hash_update(map, slot);
+}
+
+// LISTS //
+
+// Returns false if the list is full
+template <typename T, uint32_t Capacity>
+inline bool gambit_insert(GambitList<T, Capacity> &list, const std::common_type_t<T> &item)
+{
+    if (list.length >= Capacity)
+        return false;
+
+    gambit_record(list.items[list.length]);
+    gambit_record(list.length);
+    gambit_rehash(list.length);
+    list.items[list.length++] = item;
+    gambit_rehash(list.items[list.length - 1]);
+    gambit_rehash(list.length);
+    return true;
+}
+
+// Removes and returns the last item, which must exist. The item itself is left in place, so
+// only the length needs to be restored.
+template <typename T, uint32_t Capacity>
+inline T gambit_pop(GambitList<T, Capacity> &list)
+{
+    gambit_record(list.length);
+    gambit_rehash(list.items[list.length - 1]);
+    gambit_rehash(list.length);
+    T item = list.pop();
+    gambit_rehash(list.length);
+    return item;
+}
+
+template <typename T, uint32_t Capacity>
+inline bool gambit_remove(GambitList<T, Capacity> &list, const std::common_type_t<T> &item)
+{
+    for (uint32_t i = 0; i < list.length; i++)
+    {
+        if (list.items[i] == item)
+        {
+            // Every item after the removed one is shifted down
+            gambit_record(&list.items[i], (uint32_t)((list.length - i) * sizeof(T)));
+            gambit_record(list.length);
+            for (uint32_t j = i; j < list.length; j++)
+                gambit_rehash(list.items[j]);
+            gambit_rehash(list.length);
+            list.remove(item);
+            for (uint32_t j = i; j < list.length; j++)
+                gambit_rehash(list.items[j]);
+            gambit_rehash(list.length);
+            return true;
+        }
+    }
+    return false;
+}
+
+// ENTITIES //
+
+// Only whether each index is alive is hashed, and not how indexes are handed out (see hash.h)
+template <uint32_t Capacity>
+inline GambitEntity gambit_create(GambitEntityTable<Capacity> &table)
+{
+    if (table.free_count > 0)
+    {
+        gambit_record(table.free_count);
+    }
+    else if (table.count < Capacity)
+    {
+        gambit_record(table.count);
+    }
+    else
+    {
+        return GAMBIT_NO_ENTITY;
+    }
+
+    // The entity will be at the next free index, or the next unused index if there are none
+    uint32_t index = table.free_count > 0 ? table.free_indexes[table.free_count - 1] : table.count;
+    gambit_record(table.generations[index]);
+    gambit_record(table.alive[index]);
+    gambit_rehash(table.alive[index]);
+    GambitEntity entity = table.create();
+    gambit_rehash(table.alive[index]);
+    return entity;
+}
+
+template <uint32_t Capacity>
+inline void gambit_destroy(GambitEntityTable<Capacity> &table, GambitEntity entity)
+{
+    if (!table.is_alive(entity))
+        return;
+
+    uint32_t index = entity_index(entity);
+    gambit_record(table.alive[index]);
+    gambit_record(table.generations[index]);
+    gambit_record(table.free_indexes[table.free_count]);
+    gambit_record(table.free_count);
+    gambit_rehash(table.alive[index]);
+    table.destroy(entity);
+    gambit_rehash(table.alive[index]);
+}
+
+#endif
@@ -0,0 +1,87 @@
+/*
+list.h
+
+Lists stored in the game state, such as `state [Card] (Player player).cards`. Each list has a
+fixed capacity and stores its items inline, so a column of lists is a pool with room for every
+entity's list, laid out one after another. This keeps the game state free of pointers, so that
+it can be copied with memcpy.
+
+Lists declared with a fixed size, such as `[Mark, 9]`, use that size as their capacity. Other
+lists use GAMBIT_LIST_CAPACITY.
+*/
+
+#pragma once
+#ifndef GAMBIT_LIST_H
+#define GAMBIT_LIST_H
+
+#include <cstdint>
+
+#ifndef GAMBIT_LIST_CAPACITY
+#define GAMBIT_LIST_CAPACITY 64
+#endif
+
+// A zero-initialised list is empty
+template <typename T, uint32_t Capacity = GAMBIT_LIST_CAPACITY>
+struct GambitList
+{
+    uint32_t length;
+    T items[Capacity];
+
+    static constexpr uint32_t capacity() { return Capacity; }
+    uint32_t size() const { return length; }
+    bool empty() const { return length == 0; }
+
+    T &operator[](uint32_t index) { return items[index]; }
+    const T &operator[](uint32_t index) const { return items[index]; }
+
+    T *begin() { return items; }
+    T *end() { return items + length; }
+    const T *begin() const { return items; }
+    const T *end() const { return items + length; }
+
+    // Returns false if the list is full
+    bool insert(const T &item)
+    {
+        if (length >= Capacity)
+            return false;
+        items[length++] = item;
+        return true;
+    }
+
+    // Removes and returns the last item, which must exist
+    T pop()
+    {
+        return items[--length];
+    }
+
+    // Removes the first occurrence of the item, keeping the order of the rest of the list.
+    // Returns false if the list did not contain the item.
+    bool remove(const T &item)
+    {
+        for (uint32_t i = 0; i < length; i++)
+        {
+            if (items[i] == item)
+            {
+                for (uint32_t j = i + 1; j < length; j++)
+                    items[j - 1] = items[j];
+                length--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool contains(const T &item) const
+    {
+        for (uint32_t i = 0; i < length; i++)
+        {
+            if (items[i] == item)
+                return true;
+        }
+        return false;
+    }
+
+    void clear() { length = 0; }
+};
+
+#endif
@@ -0,0 +1,23 @@
+/*
+match.h
+
+Matches whose results are all constant are generated as a static table of their results, indexed
+by the subject of the match. Enums are always within the table, so they index it directly. An
+integer can be any value, so the table of an integer match ends with the result of its `else`,
+which is given for any integer that none of its rules match.
+*/
+
+#pragma once
+#ifndef GAMBIT_MATCH_H
+#define GAMBIT_MATCH_H
+
+#include <cstddef>
+
+template <typename T, size_t Size>
+inline const T &gambit_match_lookup(const T (&table)[Size], long long index)
+{
+    static_assert(Size >= 2, "The table of an integer match has a value for at least one key, and for its else");
+    return index >= 0 && index < (long long)Size - 1 ? table[index] : table[Size - 1];
+}
+
+#endif
@@ -0,0 +1,750 @@
+/*
+mcts.h
+
+A Monte-Carlo tree search player that can be used with any game. Each node of the tree is a
+decision, made by a `choose` in the game, and each of its children is one of the moves that
+could be chosen. A game ends when it reaches a `wins` or `draw` statement.
+
+Games are given to the search as a type with the following static members:
+
+    State                                      The state of one game, which must be trivially copyable
+    PLAYER_COUNT                               The number of players
+    MAX_MOVES                                  The most moves there can be at any decision
+    undo                                       The GambitUndo used to get back to the root state
+    legal_moves(const State &, uint32_t *)     Writes each move that can be chosen, returning how many there are
+    apply(State &, uint32_t)                   Makes the move, and continues the game up to the next decision
+    is_terminal(const State &)                 Whether the game has ended
+    current_player(const State &)              The index of the player making the next decision
+    outcome(const State &, uint32_t)           How well the game went for a player, from 0 (loss) to 1 (win)
+
+A game that has not ended but has no legal moves, such as at a `choose` from an empty list, cannot
+go any further, so searches and playouts stop there, and score the state with `outcome` as it is.
+Games should score a state that has not ended as a draw.
+
+Each iteration of the search selects a path down the tree using UCT, expands the node at the end
+of it, and plays the rest of the game out with random moves. The outcome of the playout is added
+to each node on the path, from the point of view of the player that chose the move into it.
+
+Nodes are allocated from a pool that is created once, with the children of a node allocated
+together, so that a node only needs the index of its first child and how many there are. When
+the pool runs out, the tree stops growing but playouts continue from its leaves.
+
+Searches can run on several threads, which share one tree. The statistics of each node are
+updated atomically, and a node is expanded by whichever thread first claims it, without locking.
+Each thread adds a virtual loss to the nodes on its path until its playout finishes, so that the
+other threads are steered towards different parts of the tree.
+
+Alternatively, each thread can search a tree of its own from the same root, with the visits of
+the root's children added together at the end to choose the move. The threads share nothing while they
+search, so no cache lines are passed between them. Each thread is pinned to a CPU, spread across
+the machine's NUMA nodes, and its tree is first written to from that thread, so that its memory is
+allocated on the thread's own node.
+
+Between turns, `advance` is told each move that is made in the game, and moves the root of the
+tree down to the matching child. The statistics below it are kept for the next search, which
+starts warm rather than from an empty tree, and everything else is freed back to the pool at once.
+
+With a transposition table, the search recognises states that it reaches by more than one order
+of moves. The first node expanded for a state is stored in the table under the state's hash, and
+any later node for the same state shares its children rather than allocating its own, so that the
+statistics below a transposed state are gathered in one place. Each node keeps its own visits, as
+the value of a move can differ depending on where in the tree it is made from.
+*/
+
+#pragma once
+#ifndef GAMBIT_MCTS_H
+#define GAMBIT_MCTS_H
+
+#include "affinity.h"
+#include "hash.h"
+#include "journal.h"
+#include "random.h"
+#include "state.h"
+#include "transposition.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// The search stops when it reaches either limit. A limit of 0 is no limit.
+struct GambitSearchBudget
+{
+    uint64_t iterations = 10000;
+    double seconds = 0;
+};
+
+enum class GambitParallelism
+{
+    TREE, // Every thread searches one shared tree
+    ROOT, // Each thread searches its own tree, and the root statistics are merged at the end
+};
+
+struct GambitSearchOptions
+{
+    GambitSearchBudget budget;
+    double exploration = 1.41;
+    uint32_t max_nodes = 1 << 20; // Shared between the trees of every thread
+    uint64_t seed = 0; // Searches with one thread and an iteration budget are reproduced by their seed
+
+    uint32_t threads = 1;
+    GambitParallelism parallelism = GambitParallelism::TREE;
+    uint32_t virtual_loss = 1; // Only used when several threads share a tree
+
+    uint32_t transpositions = 0; // Entries in the transposition table of each tree, or 0 for none
+};
+
+enum GambitExpansion : uint8_t
+{
+    NOT_EXPANDED,
+    EXPANDING, // Another thread is allocating the children of the node
+    EXPANDED,
+    LEAF, // The pool was full when the node was expanded, so playouts start from it instead
+};
+
+// The children of a node are only read once its expansion has been seen as EXPANDED, which is
+// stored after they have been written
+struct GambitNode
+{
+    uint32_t first_child;
+    uint16_t child_count;
+    uint8_t player; // The player that chose the move into this node
+    std::atomic<uint8_t> expansion;
+    uint32_t move;
+    std::atomic<uint32_t> visits;
+    std::atomic<float> value; // The total outcome of each visit, for `player`
+};
+
+struct GambitSearchStats
+{
+    uint64_t iterations = 0;
+    uint32_t nodes = 0;
+    uint32_t threads = 0;
+    double seconds = 0;
+
+    uint64_t transposition_lookups = 0; // One for every node expanded
+    uint64_t transposition_hits = 0;
+    uint64_t nodes_shared = 0; // Children that transposed nodes shared, rather than allocating
+    uint32_t nodes_reused = 0; // Nodes kept from the previous search by `advance`
+    uint64_t root_visits = 0;  // Including the visits kept from previous searches
+
+    double playouts_per_second() const { return seconds > 0 ? iterations / seconds : 0; }
+    double transposition_hit_rate() const { return transposition_lookups > 0 ? (double)transposition_hits / transposition_lookups : 0; }
+
+    // Only counts the children that were shared directly, and not the subtrees below them
+    uint64_t bytes_saved() const { return nodes_shared * sizeof(GambitNode); }
+};
+
+// Every node that a search can use, allocated up front. Nodes are handed out in order, and are
+// all freed at once.
+class GambitNodePool
+{
+public:
+    explicit GambitNodePool(uint32_t capacity)
+        : nodes(new GambitNode[capacity]), capacity(capacity) {}
+
+    // Returns the index of the first of `count` consecutive nodes, or UINT32_MAX if there are
+    // not enough left
+    uint32_t allocate(uint32_t count)
+    {
+        uint32_t first = used.load(std::memory_order_relaxed);
+        do
+        {
+            if (capacity - first < count)
+                return UINT32_MAX;
+        } while (!used.compare_exchange_weak(first, first + count, std::memory_order_relaxed));
+
+        return first;
+    }
+
+    void clear() { used.store(0, std::memory_order_relaxed); }
+
+    // Frees every node after the first `count`
+    void shrink(uint32_t count) { used.store(std::min(count, size()), std::memory_order_relaxed); }
+    uint32_t size() const { return used.load(std::memory_order_relaxed); }
+
+    GambitNode &operator[](uint32_t index) { return nodes[index]; }
+    const GambitNode &operator[](uint32_t index) const { return nodes[index]; }
+
+private:
+    std::unique_ptr<GambitNode[]> nodes;
+    uint32_t capacity;
+    std::atomic<uint32_t> used{0};
+};
+
+// Plays the game out to the end with random moves, or until there are no legal moves. Moves are
+// generated into the buffer, which must have room for MAX_MOVES, and no prompts are ever built.
+template <typename Game>
+inline void gambit_playout(typename Game::State &state, GambitRandom &random, uint32_t *moves)
+{
+    while (!Game::is_terminal(state))
+    {
+        uint32_t count = Game::legal_moves(state, moves);
+        if (count == 0)
+            break;
+        Game::apply(state, moves[random.below(count)]);
+    }
+}
+
+template <typename Game>
+class GambitMCTS
+{
+    static_assert(Game::MAX_MOVES <= UINT16_MAX, "The children of a node are counted with 16 bits");
+    static_assert(Game::PLAYER_COUNT <= UINT8_MAX, "Players are stored in nodes with 8 bits");
+
+public:
+    using State = typename Game::State;
+
+    explicit GambitMCTS(GambitSearchOptions options = {})
+        : options(options)
+    {
+        this->options.threads = std::max(options.threads, 1u);
+        if (this->options.threads == 1)
+            this->options.parallelism = GambitParallelism::TREE;
+
+        if (this->options.parallelism == GambitParallelism::TREE)
+            shared_tree.reset(new Tree(options.max_nodes, options.transpositions));
+
+        for (uint32_t i = 0; i < this->options.threads; i++)
+            workers.emplace_back(new Worker(options.seed, i));
+    }
+
+    // Searches from the state, and returns the move that was explored the most. The game must
+    // not have ended, and must have a legal move.
+    uint32_t search(const State &root)
+    {
+        auto start = std::chrono::steady_clock::now();
+        stats = {};
+        iterations_started.store(0, std::memory_order_relaxed);
+        stopped.store(false, std::memory_order_relaxed);
+
+        if (options.parallelism == GambitParallelism::TREE)
+        {
+            prepare_tree(*shared_tree, root);
+            for (auto &worker : workers)
+                worker->tree = shared_tree.get();
+
+            // The calling thread is the first worker
+            std::vector<std::thread> threads;
+            for (size_t i = 1; i < workers.size(); i++)
+                threads.emplace_back([&, i]()
+                                     { run_worker(*workers[i], root, start); });
+            run_worker(*workers[0], root, start);
+            for (auto &thread : threads)
+                thread.join();
+        }
+        else
+        {
+            // Every worker runs on a thread of its own, so that the calling thread is not pinned
+            auto numa_nodes = gambit_numa_nodes();
+            std::vector<std::thread> threads;
+            for (size_t i = 0; i < workers.size(); i++)
+                threads.emplace_back([&, i]()
+                                     {
+                                         gambit_pin_thread(gambit_cpu_for_thread(numa_nodes, (uint32_t)i));
+                                         search_own_tree(*workers[i], root, start); });
+            for (auto &thread : threads)
+                thread.join();
+        }
+
+        for (const auto &worker : workers)
+        {
+            stats.iterations += worker->iterations;
+            stats.transposition_lookups += worker->transposition_lookups;
+            stats.transposition_hits += worker->transposition_hits;
+            stats.nodes_shared += worker->nodes_shared;
+        }
+        for (const auto &worker : workers)
+        {
+            // Threads that share a tree all point to it
+            if (shares_tree() && worker != workers[0])
+                break;
+            stats.nodes += worker->tree->pool.size();
+            stats.nodes_reused += worker->tree->reused;
+            stats.root_visits += worker->tree->pool[worker->tree->root].visits.load(std::memory_order_relaxed);
+        }
+        stats.threads = (uint32_t)workers.size();
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return best_move();
+    }
+
+    // Moves the root of each tree down to the child for a move that has just been made in the
+    // game, by any player, so that the next search starts from the statistics gathered below it.
+    // The rest of the tree is freed. The next search must be from the state the move led to.
+    void advance(uint32_t move)
+    {
+        if (shared_tree)
+            reroot(*shared_tree, move);
+        for (auto &worker : workers)
+        {
+            if (worker->own_tree)
+                reroot(*worker->own_tree, move);
+        }
+    }
+
+    const GambitSearchStats &last_stats() const { return stats; }
+
+private:
+    static constexpr uint32_t MAX_DEPTH = 256;
+
+    // A pool of nodes and the tree in it
+    struct Tree
+    {
+        Tree(uint32_t max_nodes, uint32_t transpositions)
+            : pool(max_nodes)
+        {
+            if (transpositions > 0)
+                table.reset(new GambitTranspositionTable(transpositions));
+        }
+
+        GambitNodePool pool;
+        std::unique_ptr<GambitTranspositionTable> table;
+        uint32_t root = 0;
+        bool kept = false;   // Whether `advance` kept the tree for the next search
+        uint32_t reused = 0; // How many nodes the current search started with
+    };
+
+    // Everything that a thread uses on its own
+    struct Worker
+    {
+        Worker(uint64_t seed, uint32_t index)
+            : index(index), random(seed, index), state(new State) {}
+
+        uint32_t index; // The position of the worker in `workers`
+
+        Tree *tree = nullptr;
+        std::unique_ptr<Tree> own_tree; // Only used by root parallel searches
+
+        GambitRandom random; // A stream of its own, so that no other thread affects it
+        std::unique_ptr<State> state; // The state that each iteration plays out in
+        GambitJournal journal;
+        GambitHasher hasher; // Only follows the state when there is a transposition table
+        uint64_t root_hash = 0;
+        uint64_t iterations = 0;
+        uint64_t transposition_lookups = 0;
+        uint64_t transposition_hits = 0;
+        uint64_t nodes_shared = 0;
+        uint32_t moves[Game::MAX_MOVES];
+    };
+
+    GambitSearchOptions options;
+    GambitSearchStats stats;
+    std::unique_ptr<Tree> shared_tree; // Only used by tree parallel searches
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<uint64_t> iterations_started{0};
+    std::atomic<bool> stopped{false};
+
+    bool shares_tree() const { return options.parallelism == GambitParallelism::TREE && options.threads > 1; }
+
+    // The tree is created by the thread that uses it, after it has been pinned
+    void search_own_tree(Worker &worker, const State &root, std::chrono::steady_clock::time_point start)
+    {
+        if (!worker.own_tree)
+            worker.own_tree.reset(new Tree(std::max(options.max_nodes / options.threads, 1u), options.transpositions));
+
+        worker.tree = worker.own_tree.get();
+        prepare_tree(*worker.tree, root);
+        run_worker(worker, root, start);
+    }
+
+    // Starts the tree again from the root, unless it was kept by `advance`
+    static void prepare_tree(Tree &tree, const State &root)
+    {
+        tree.reused = tree.kept ? tree.pool.size() : 0;
+        if (tree.kept)
+        {
+            tree.kept = false;
+            return;
+        }
+
+        tree.pool.clear();
+        if (tree.table)
+            tree.table->clear();
+        tree.root = tree.pool.allocate(1);
+        reset_node(tree.pool[tree.root], 0, (uint8_t)Game::current_player(root));
+    }
+
+    // Copies the subtree below the child for the move to the start of the pool, breadth first so
+    // that the children of each node stay together, and then frees every node after it. Children
+    // shared by transposed nodes are only copied once. The table holds the indexes that nodes
+    // had before they were moved, so it is cleared, and only finds transpositions of nodes that
+    // are expanded from now on.
+    static void reroot(Tree &tree, uint32_t move)
+    {
+        GambitNodePool &pool = tree.pool;
+        const GambitNode &root = pool[tree.root];
+
+        uint32_t new_root = UINT32_MAX;
+        if (root.expansion.load(std::memory_order_relaxed) == EXPANDED)
+        {
+            for (uint32_t child = root.first_child; child < root.first_child + root.child_count; child++)
+            {
+                if (pool[child].move == move)
+                    new_root = child;
+            }
+        }
+
+        // The move was never explored, so there is nothing to keep
+        tree.kept = new_root != UINT32_MAX;
+        if (!tree.kept)
+            return;
+
+        struct Copy
+        {
+            uint32_t first_child;
+            uint16_t child_count;
+            uint8_t player;
+            uint8_t expansion;
+            uint32_t move;
+            uint32_t visits;
+            float value;
+        };
+
+        auto copy = [&](uint32_t index)
+        {
+            const GambitNode &node = pool[index];
+            return Copy{
+                node.first_child,
+                node.child_count,
+                node.player,
+                node.expansion.load(std::memory_order_relaxed),
+                node.move,
+                node.visits.load(std::memory_order_relaxed),
+                node.value.load(std::memory_order_relaxed),
+            };
+        };
+
+        std::vector<Copy> copies;
+        std::unordered_map<uint32_t, uint32_t> moved_children; // Old first child to new first child
+        copies.push_back(copy(new_root));
+        for (size_t i = 0; i < copies.size(); i++)
+        {
+            if (copies[i].expansion != EXPANDED)
+                continue;
+
+            uint32_t old_first = copies[i].first_child;
+            auto moved = moved_children.find(old_first);
+            if (moved != moved_children.end())
+            {
+                copies[i].first_child = moved->second;
+                continue;
+            }
+
+            uint32_t new_first = (uint32_t)copies.size();
+            moved_children[old_first] = new_first;
+            copies[i].first_child = new_first;
+            for (uint32_t child = old_first; child < old_first + copies[i].child_count; child++)
+                copies.push_back(copy(child));
+        }
+
+        for (uint32_t i = 0; i < copies.size(); i++)
+        {
+            GambitNode &node = pool[i];
+            node.first_child = copies[i].first_child;
+            node.child_count = copies[i].child_count;
+            node.player = copies[i].player;
+            // Rerooting frees nodes, so leaves that the pool had no room for can be expanded again
+            node.expansion.store(copies[i].expansion == LEAF ? NOT_EXPANDED : copies[i].expansion, std::memory_order_relaxed);
+            node.move = copies[i].move;
+            node.visits.store(copies[i].visits, std::memory_order_relaxed);
+            node.value.store(copies[i].value, std::memory_order_relaxed);
+        }
+
+        pool.shrink((uint32_t)copies.size());
+        if (tree.table)
+            tree.table->clear();
+        tree.root = 0;
+    }
+
+    void run_worker(Worker &worker, const State &root, std::chrono::steady_clock::time_point start)
+    {
+        worker.iterations = 0;
+        worker.transposition_lookups = 0;
+        worker.transposition_hits = 0;
+        worker.nodes_shared = 0;
+
+        // The root is hashed once, and the hash is then updated by every write to the state
+        gambit_clone(*worker.state, root);
+        if (worker.tree->table)
+        {
+            worker.hasher.reset(*worker.state);
+            worker.root_hash = worker.hasher.value;
+            GambitHashScope scope(worker.hasher);
+            run_iterations(worker, root, start);
+        }
+        else
+        {
+            run_iterations(worker, root, start);
+        }
+    }
+
+    void run_iterations(Worker &worker, const State &root, std::chrono::steady_clock::time_point start)
+    {
+        while (!budget_spent(worker, start))
+        {
+            if (Game::undo == GambitUndo::JOURNAL)
+            {
+                GambitJournalScope scope(worker.journal);
+                iterate(worker);
+                worker.journal.rollback(0);
+                worker.hasher.value = worker.root_hash;
+            }
+            else
+            {
+                gambit_clone(*worker.state, root);
+                worker.hasher.value = worker.root_hash;
+                iterate(worker);
+            }
+            worker.iterations++;
+        }
+    }
+
+    bool budget_spent(const Worker &worker, std::chrono::steady_clock::time_point start)
+    {
+        if (stopped.load(std::memory_order_relaxed))
+            return true;
+
+        // Threads with trees of their own split the iterations between them up front, rather than
+        // counting them together
+        const auto &budget = options.budget;
+        if (budget.iterations > 0)
+        {
+            if (options.parallelism == GambitParallelism::ROOT)
+            {
+                uint64_t share = budget.iterations / options.threads + (worker.index < budget.iterations % options.threads ? 1 : 0);
+                if (worker.iterations >= share)
+                    return true;
+            }
+            else if (iterations_started.fetch_add(1, std::memory_order_relaxed) >= budget.iterations)
+            {
+                return true;
+            }
+        }
+
+        // Checking the clock is slower than an iteration of a small game, so it is only checked
+        // every so often
+        if (budget.seconds > 0 && worker.iterations % 64 == 0 &&
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() >= budget.seconds)
+        {
+            stopped.store(true, std::memory_order_relaxed);
+            return true;
+        }
+
+        return false;
+    }
+
+    static void reset_node(GambitNode &node, uint32_t move, uint8_t player)
+    {
+        node.first_child = 0;
+        node.child_count = 0;
+        node.player = player;
+        node.expansion.store(NOT_EXPANDED, std::memory_order_relaxed);
+        node.move = move;
+        node.visits.store(0, std::memory_order_relaxed);
+        node.value.store(0, std::memory_order_relaxed);
+    }
+
+    uint32_t virtual_loss() const { return shares_tree() ? options.virtual_loss : 0; }
+
+    // Moves down the tree to the node, applying its move to the worker's state
+    void descend(Worker &worker, uint32_t node)
+    {
+        GambitNodePool &pool = worker.tree->pool;
+        if (virtual_loss() > 0)
+            pool[node].visits.fetch_add(virtual_loss(), std::memory_order_relaxed);
+        Game::apply(*worker.state, pool[node].move);
+    }
+
+    void iterate(Worker &worker)
+    {
+        GambitNodePool &pool = worker.tree->pool;
+        uint32_t path[MAX_DEPTH];
+        uint32_t depth = 0;
+        uint32_t node = worker.tree->root;
+        path[depth++] = node;
+
+        // Selection
+        while (depth < MAX_DEPTH && pool[node].expansion.load(std::memory_order_acquire) == EXPANDED && pool[node].child_count > 0)
+        {
+            node = select_child(pool, node);
+            descend(worker, node);
+            path[depth++] = node;
+        }
+
+        // Expansion. If another thread is already expanding the node, the playout starts here. A
+        // node without any legal moves is expanded with no children, and is never descended into.
+        uint8_t not_expanded = NOT_EXPANDED;
+        if (depth < MAX_DEPTH && !Game::is_terminal(*worker.state) &&
+            pool[node].expansion.compare_exchange_strong(not_expanded, EXPANDING, std::memory_order_relaxed))
+        {
+            if (expand(worker, node) && pool[node].child_count > 0)
+            {
+                node = pool[node].first_child + worker.random.below(pool[node].child_count);
+                descend(worker, node);
+                path[depth++] = node;
+            }
+        }
+
+        // Playout. The hash is only needed down to the node the playout starts from, so it stops
+        // following the state until the playout's writes have been rolled back.
+        GambitHasher *hasher = gambit_hasher;
+        gambit_hasher = nullptr;
+        GambitJournal::Checkpoint playout_start = worker.journal.checkpoint();
+
+        gambit_playout<Game>(*worker.state, worker.random, worker.moves);
+
+        // Backpropagation, which also takes back the virtual loss added to every node but the root
+        for (uint32_t i = 0; i < depth; i++)
+        {
+            GambitNode &visited = pool[path[i]];
+            if (i > 0 && virtual_loss() > 0)
+            {
+                visited.visits.fetch_add(1, std::memory_order_relaxed);
+                visited.visits.fetch_sub(virtual_loss(), std::memory_order_relaxed);
+            }
+            else
+                add(visited.visits, 1u);
+            add(visited.value, (float)Game::outcome(*worker.state, visited.player));
+        }
+
+        if (hasher && Game::undo == GambitUndo::JOURNAL)
+            worker.journal.rollback(playout_start);
+        gambit_hasher = hasher;
+    }
+
+    // Atomic additions are several times slower than plain ones, so they are only used when
+    // other threads could be updating the same node
+    template <typename T>
+    void add(std::atomic<T> &target, T amount) const
+    {
+        if (!shares_tree())
+        {
+            target.store(target.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+            return;
+        }
+
+        T value = target.load(std::memory_order_relaxed);
+        while (!target.compare_exchange_weak(value, value + amount, std::memory_order_relaxed))
+            ;
+    }
+
+    // Must only be called by the thread that claimed the node for expansion. Returns false, and
+    // marks the node as a LEAF, if the pool is full, so that later visits do not try again.
+    bool expand(Worker &worker, uint32_t node)
+    {
+        GambitNodePool &pool = worker.tree->pool;
+
+        // A node that has already been expanded for the same state has the same moves, so its
+        // children can be shared
+        GambitTranspositionTable *table = worker.tree->table.get();
+        if (table)
+        {
+            worker.transposition_lookups++;
+            uint32_t transposed = table->find(worker.hasher.value);
+            if (transposed != GambitTranspositionTable::NONE && pool[transposed].expansion.load(std::memory_order_acquire) == EXPANDED)
+            {
+                worker.transposition_hits++;
+                worker.nodes_shared += pool[transposed].child_count;
+                pool[node].first_child = pool[transposed].first_child;
+                pool[node].child_count = pool[transposed].child_count;
+                pool[node].expansion.store(EXPANDED, std::memory_order_release);
+                return true;
+            }
+        }
+
+        uint32_t count = Game::legal_moves(*worker.state, worker.moves);
+        uint32_t first = pool.allocate(count);
+        if (first == UINT32_MAX)
+        {
+            pool[node].expansion.store(LEAF, std::memory_order_relaxed);
+            return false;
+        }
+
+        uint8_t player = (uint8_t)Game::current_player(*worker.state);
+        for (uint32_t i = 0; i < count; i++)
+            reset_node(pool[first + i], worker.moves[i], player);
+
+        pool[node].first_child = first;
+        pool[node].child_count = (uint16_t)count;
+        pool[node].expansion.store(EXPANDED, std::memory_order_release);
+        if (table)
+            table->insert(worker.hasher.value, node);
+        return true;
+    }
+
+    // Children that have not been visited yet are always tried first
+    uint32_t select_child(const GambitNodePool &pool, uint32_t node) const
+    {
+        const GambitNode &parent = pool[node];
+        // The parent may not have been visited yet, if another thread is still playing out from it
+        double log_visits = std::log((double)std::max(parent.visits.load(std::memory_order_relaxed), 1u));
+
+        uint32_t best = parent.first_child;
+        double best_score = -1;
+        for (uint32_t child = parent.first_child; child < parent.first_child + parent.child_count; child++)
+        {
+            const GambitNode &candidate = pool[child];
+            uint32_t visits = candidate.visits.load(std::memory_order_relaxed);
+            if (visits == 0)
+                return child;
+
+            double mean = candidate.value.load(std::memory_order_relaxed) / visits;
+            double score = mean + options.exploration * std::sqrt(log_visits / visits);
+            if (score > best_score)
+            {
+                best = child;
+                best_score = score;
+            }
+        }
+        return best;
+    }
+
+    // The visits of each of the root's children are added up across every tree. Every tree has
+    // the same root, so a move means the same thing in each of them.
+    uint32_t best_move() const
+    {
+        uint32_t moves[Game::MAX_MOVES];
+        uint64_t visits[Game::MAX_MOVES];
+        uint32_t move_count = 0;
+
+        for (const auto &worker : workers)
+        {
+            const GambitNodePool &pool = worker->tree->pool;
+            const GambitNode &root = pool[worker->tree->root];
+            if (root.expansion.load(std::memory_order_acquire) != EXPANDED)
+                continue;
+
+            for (uint32_t child = root.first_child; child < root.first_child + root.child_count; child++)
+            {
+                uint32_t i = 0;
+                while (i < move_count && moves[i] != pool[child].move)
+                    i++;
+                if (i == move_count)
+                {
+                    moves[move_count] = pool[child].move;
+                    visits[move_count] = 0;
+                    move_count++;
+                }
+                visits[i] += pool[child].visits.load(std::memory_order_relaxed);
+            }
+
+            // Threads that share a tree all have the same root
+            if (shares_tree())
+                break;
+        }
+
+        uint32_t best = 0;
+        for (uint32_t i = 1; i < move_count; i++)
+        {
+            if (visits[i] > visits[best])
+                best = i;
+        }
+        return move_count > 0 ? moves[best] : 0;
+    }
+};
+
+#endif
@@ -0,0 +1,92 @@
+/*
+moves.h
+
+Move generators, which write the moves that can be made at a `choose` into a buffer provided by
+the caller, and return how many there are. A move is the index of the chosen item in the list it
+is chosen from, even when only some of the items can be chosen, so making a move never has to
+find the options again. Nothing is allocated, and the lists of options are never built, which
+matters as playouts generate moves at every decision.
+
+Generated programs make decisions with `gambit_choose`, which asks the policy of the thread which
+of the moves to make. They generate the moves into `gambit_moves`, a buffer that each thread has
+one of, which has room for GAMBIT_MAX_MOVES. The ports of the sample games (see benchmark/) use the
+generators directly.
+*/
+
+#pragma once
+#ifndef GAMBIT_MOVES_H
+#define GAMBIT_MOVES_H
+
+#include "entity.h"
+#include "list.h"
+#include <cstdint>
+
+// Every item of the list
+template <typename T, uint32_t Capacity>
+inline uint32_t gambit_list_moves(const GambitList<T, Capacity> &list, uint32_t *moves)
+{
+    for (uint32_t i = 0; i < list.length; i++)
+        moves[i] = i;
+    return list.length;
+}
+
+// The items of the list that the predicate is true for, as in `list filter (item: ...)`
+template <typename T, uint32_t Capacity, typename Predicate>
+inline uint32_t gambit_filter_moves(const GambitList<T, Capacity> &list, Predicate predicate, uint32_t *moves)
+{
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < list.length; i++)
+    {
+        if (predicate(list.items[i]))
+            moves[count++] = i;
+    }
+    return count;
+}
+
+// The integers from first to last, as in `first..last`, up to `max_moves` of them. Each move is
+// the offset of its integer from the first.
+inline uint32_t gambit_range_moves(int first, int last, uint32_t *moves, uint32_t max_moves)
+{
+    uint32_t count = 0;
+    for (int64_t value = first; value <= last && count < max_moves; value++)
+    {
+        moves[count] = count;
+        count++;
+    }
+    return count;
+}
+
+// The moves of a `choose` in a generated program are written here. Lists with more items than
+// this cannot be chosen from, unless GAMBIT_MAX_MOVES is defined to be larger.
+#ifndef GAMBIT_MAX_MOVES
+#define GAMBIT_MAX_MOVES GAMBIT_LIST_CAPACITY
+#endif
+
+inline thread_local uint32_t gambit_moves[GAMBIT_MAX_MOVES];
+
+// Picks which of the moves a player makes, returning its position in `moves`
+struct GambitPolicy
+{
+    uint32_t (*choose)(void *context, uint32_t player, const uint32_t *moves, uint32_t count) = nullptr;
+    void *context = nullptr;
+};
+
+// Without a policy, players make the first move they can
+inline thread_local GambitPolicy gambit_policy;
+
+// Returns the item that the player chooses, or an empty item if the list is empty. The moves are
+// generated into the buffer, which must have room for every item of the list.
+template <typename T, uint32_t Capacity, uint32_t MaxMoves>
+inline T gambit_choose(GambitEntity player, const GambitList<T, Capacity> &list, uint32_t (&moves)[MaxMoves])
+{
+    static_assert(Capacity <= MaxMoves, "There must be room in the buffer for a move for every item of the list");
+
+    uint32_t count = gambit_list_moves(list, moves);
+    if (count == 0)
+        return {};
+
+    uint32_t chosen = gambit_policy.choose ? gambit_policy.choose(gambit_policy.context, entity_index(player), moves, count) : 0;
+    return list[moves[chosen]];
+}
+
+#endif
@@ -0,0 +1,138 @@
+/*
+random.h
+
+The random numbers used by searches and games, from a xoshiro256** generator. Its state is only
+32 bytes, and each number takes a handful of instructions, which matters as a playout draws one
+at every decision.
+
+Generators are seeded through splitmix64, so that any seed gives a well mixed state. A generator
+can be split into independent streams with the jump function of xoshiro256, which moves it 2^128
+numbers ahead, so each thread of a search draws from a stream of its own. The numbers a thread
+sees do not depend on any other thread, and the same seed always gives the same numbers, on any
+platform, unlike the distributions of <random>.
+*/
+
+#pragma once
+#ifndef GAMBIT_RANDOM_H
+#define GAMBIT_RANDOM_H
+
+#include "journal.h"
+#include "list.h"
+#include "moves.h"
+#include <cstdint>
+
+template <uint32_t Lanes>
+class GambitBatchRandom;
+
+class GambitRandom
+{
+public:
+    using result_type = uint64_t;
+
+    // Each stream of the same seed is independent of the others
+    explicit GambitRandom(uint64_t seed = 0, uint32_t stream = 0)
+    {
+        for (auto &word : state)
+        {
+            seed += 0x9E3779B97F4A7C15ull;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            word = z ^ (z >> 31);
+        }
+
+        for (uint32_t i = 0; i < stream; i++)
+            jump();
+    }
+
+    uint64_t operator()()
+    {
+        uint64_t result = rotate(state[1] * 5, 7) * 9;
+        uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotate(state[3], 45);
+        return result;
+    }
+
+    // A number from 0 to bound - 1, which must be at least 1. Taking the number modulo the bound
+    // would favour smaller numbers, so instead the top of a 64 bit product is used, and the few
+    // numbers that would be biased are drawn again (Lemire, 2019).
+    uint32_t below(uint32_t bound)
+    {
+        uint64_t product = (uint64_t)(uint32_t)((*this)() >> 32) * bound;
+        uint32_t low = (uint32_t)product;
+        if (low < bound)
+        {
+            uint32_t threshold = (uint32_t)(-bound) % bound;
+            while (low < threshold)
+            {
+                product = (uint64_t)(uint32_t)((*this)() >> 32) * bound;
+                low = (uint32_t)product;
+            }
+        }
+        return (uint32_t)(product >> 32);
+    }
+
+    // Moves the generator 2^128 numbers ahead
+    void jump()
+    {
+        static const uint64_t polynomial[] = {0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull, 0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull};
+
+        uint64_t jumped[4] = {0, 0, 0, 0};
+        for (uint64_t word : polynomial)
+        {
+            for (int bit = 0; bit < 64; bit++)
+            {
+                if (word & (1ull << bit))
+                {
+                    for (int i = 0; i < 4; i++)
+                        jumped[i] ^= state[i];
+                }
+                (*this)();
+            }
+        }
+
+        for (int i = 0; i < 4; i++)
+            state[i] = jumped[i];
+    }
+
+    static constexpr uint64_t min() { return 0; }
+    static constexpr uint64_t max() { return UINT64_MAX; }
+
+private:
+    template <uint32_t Lanes>
+    friend class GambitBatchRandom;
+
+    uint64_t state[4];
+
+    static uint64_t rotate(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+};
+
+// Shuffles the list in place, as `shuffle(list)` does, with every order equally likely
+template <typename T, uint32_t Capacity>
+inline void gambit_shuffle(GambitList<T, Capacity> &list, GambitRandom &random)
+{
+    for (uint32_t i = list.length; i > 1; i--)
+    {
+        uint32_t j = random.below(i);
+        T item = list.items[i - 1];
+        gambit_write(list.items[i - 1], list.items[j]);
+        gambit_write(list.items[j], item);
+    }
+}
+
+// A policy that makes random moves, for playing games out without anyone making decisions
+inline GambitPolicy gambit_random_policy(GambitRandom &random)
+{
+    GambitPolicy policy;
+    policy.choose = [](void *context, uint32_t, const uint32_t *, uint32_t count)
+    { return static_cast<GambitRandom *>(context)->below(count); };
+    policy.context = &random;
+    return policy;
+}
+
+#endif
@@ -0,0 +1,487 @@
+/*
+selfplay.h
+
+Plays many games between computer players, with no one making decisions, to measure how a game
+plays out: how often each player wins, how long games last, and how many games can be played a
+second. Games are shared out between threads, which each take the next game to play from a
+counter until every game has been played, so that threads which draw short games are not left
+waiting on the others.
+
+Each player is one of the following, given as a comma separated list such as `random,mcts:1000`,
+for the first player, the second player and so on. Players past the end of the list repeat it.
+
+    random          Makes a random move
+    mcts:N          Searches for N iterations (see mcts.h)
+    mcts:Fs         Searches for F seconds
+
+The result of every game is streamed to a file as it is played, as CSV if the file name ends in
+.csv, and otherwise as a compact binary file. CSV rows give the number of the game, the number of
+the player that won (from 1, as `player.number` does) or `draw`, and the length of the game in
+moves. Each binary record is 7 little endian bytes: the number of the game (32 bits), its length
+(16 bits) and its winner (8 bits, signed), which is the index of the player that won, -1 for a
+draw, or -2 for a game that did not end. Games are written in the order they finish.
+
+Games that are described in the way mcts.h expects are played with `gambit_selfplay`. Generated
+programs are played with `gambit_main`, which the generator calls from the `main` of any program
+that has one, when it is run with `--selfplay N`. Their decisions are made through `gambit_policy`,
+so they can only be played by random players.
+*/
+
+#pragma once
+#ifndef GAMBIT_SELFPLAY_H
+#define GAMBIT_SELFPLAY_H
+
+#include "mcts.h"
+#include "moves.h"
+#include "random.h"
+#include "state.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct GambitPlayer
+{
+    enum Kind
+    {
+        RANDOM,
+        MCTS,
+    } kind = RANDOM;
+    GambitSearchBudget budget;
+};
+
+struct GambitSelfplayOptions
+{
+    uint64_t games = 1000;
+    uint32_t threads = 0; // 0 for one per hardware thread
+    uint64_t seed = 0;
+    std::vector<GambitPlayer> players = {GambitPlayer{}};
+    std::string output; // Where to stream the result of each game, if anywhere
+};
+
+constexpr int8_t GAMBIT_DRAW = -1;
+constexpr int8_t GAMBIT_UNFINISHED = -2;
+
+struct GambitGameResult
+{
+    int8_t winner; // The index of the player that won, GAMBIT_DRAW or GAMBIT_UNFINISHED
+    uint32_t length;
+};
+
+struct GambitSelfplaySummary
+{
+    uint64_t games = 0;
+    std::vector<uint64_t> wins; // Indexed by player
+    uint64_t draws = 0;
+    uint64_t unfinished = 0;
+    std::vector<uint64_t> lengths; // How many games lasted each number of moves
+    double seconds = 0;
+
+    double games_per_second() const { return seconds > 0 ? games / seconds : 0; }
+
+    void add(GambitGameResult result)
+    {
+        games++;
+        if (result.winner == GAMBIT_DRAW)
+            draws++;
+        else if (result.winner == GAMBIT_UNFINISHED)
+            unfinished++;
+        else
+        {
+            if ((size_t)result.winner >= wins.size())
+                wins.resize(result.winner + 1, 0);
+            wins[result.winner]++;
+        }
+
+        if (result.length >= lengths.size())
+            lengths.resize(result.length + 1, 0);
+        lengths[result.length]++;
+    }
+
+    void merge(const GambitSelfplaySummary &other)
+    {
+        games += other.games;
+        draws += other.draws;
+        unfinished += other.unfinished;
+        if (other.wins.size() > wins.size())
+            wins.resize(other.wins.size(), 0);
+        for (size_t i = 0; i < other.wins.size(); i++)
+            wins[i] += other.wins[i];
+        if (other.lengths.size() > lengths.size())
+            lengths.resize(other.lengths.size(), 0);
+        for (size_t i = 0; i < other.lengths.size(); i++)
+            lengths[i] += other.lengths[i];
+    }
+
+    // The length that the given fraction of games are no longer than
+    uint32_t length_percentile(double fraction) const
+    {
+        uint64_t target = (uint64_t)(fraction * games);
+        uint64_t seen = 0;
+        for (size_t length = 0; length < lengths.size(); length++)
+        {
+            seen += lengths[length];
+            if (seen > target || seen == games)
+                return (uint32_t)length;
+        }
+        return 0;
+    }
+
+    double mean_length() const
+    {
+        double total = 0;
+        for (size_t length = 0; length < lengths.size(); length++)
+            total += (double)length * lengths[length];
+        return games > 0 ? total / games : 0;
+    }
+};
+
+// PLAYERS //
+
+// Returns false if the list is not valid
+inline bool gambit_parse_players(const std::string &list, std::vector<GambitPlayer> &players)
+{
+    players.clear();
+    size_t start = 0;
+    while (start <= list.size())
+    {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos)
+            end = list.size();
+        std::string name = list.substr(start, end - start);
+        start = end + 1;
+
+        GambitPlayer player;
+        if (name == "random")
+            player.kind = GambitPlayer::RANDOM;
+        else if (name.compare(0, 5, "mcts:") == 0 && name.size() > 5)
+        {
+            player.kind = GambitPlayer::MCTS;
+            std::string budget = name.substr(5);
+            char *rest = nullptr;
+            if (budget.back() == 's')
+            {
+                player.budget.iterations = 0;
+                player.budget.seconds = std::strtod(budget.c_str(), &rest);
+                if (rest != budget.c_str() + budget.size() - 1 || player.budget.seconds <= 0)
+                    return false;
+            }
+            else
+            {
+                player.budget.iterations = std::strtoull(budget.c_str(), &rest, 10);
+                if (*rest != '\0' || player.budget.iterations == 0)
+                    return false;
+            }
+        }
+        else
+            return false;
+
+        players.push_back(player);
+    }
+    return !players.empty();
+}
+
+// OUTPUT //
+
+// Results are written in blocks, which each thread fills before taking the lock on the file
+class GambitSelfplayWriter
+{
+public:
+    static constexpr size_t BLOCK_SIZE = 4096;
+
+    bool open(const std::string &path)
+    {
+        file = std::fopen(path.c_str(), "wb");
+        if (!file)
+            return false;
+
+        csv = path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+        if (csv)
+            std::fputs("game,winner,length\n", file);
+        return true;
+    }
+
+    ~GambitSelfplayWriter()
+    {
+        if (file)
+            std::fclose(file);
+    }
+
+    void write(const std::vector<std::pair<uint64_t, GambitGameResult>> &block)
+    {
+        if (!file)
+            return;
+
+        std::string buffer;
+        buffer.reserve(block.size() * 24);
+        for (const auto &entry : block)
+        {
+            uint32_t game = (uint32_t)entry.first;
+            uint16_t length = (uint16_t)std::min<uint32_t>(entry.second.length, UINT16_MAX);
+            if (csv)
+            {
+                char line[64];
+                if (entry.second.winner == GAMBIT_DRAW)
+                    std::snprintf(line, sizeof(line), "%u,draw,%u\n", game, entry.second.length);
+                else if (entry.second.winner == GAMBIT_UNFINISHED)
+                    std::snprintf(line, sizeof(line), "%u,,%u\n", game, entry.second.length);
+                else
+                    std::snprintf(line, sizeof(line), "%u,%d,%u\n", game, entry.second.winner + 1, entry.second.length);
+                buffer += line;
+            }
+            else
+            {
+                char record[7] = {
+                    (char)game, (char)(game >> 8), (char)(game >> 16), (char)(game >> 24),
+                    (char)length, (char)(length >> 8),
+                    (char)entry.second.winner};
+                buffer.append(record, sizeof(record));
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        std::fwrite(buffer.data(), 1, buffer.size(), file);
+    }
+
+private:
+    std::FILE *file = nullptr;
+    bool csv = false;
+    std::mutex mutex;
+};
+
+// RUNNING //
+
+// Plays every game across the threads. `make_player(thread)` is called once on each thread, and
+// returns a function that plays one game with the thread's random number generator.
+template <typename MakePlayer>
+inline GambitSelfplaySummary gambit_run_selfplay(const GambitSelfplayOptions &options, GambitSelfplayWriter &writer, MakePlayer make_player)
+{
+    uint32_t thread_count = options.threads > 0 ? options.threads : std::max(std::thread::hardware_concurrency(), 1u);
+    thread_count = (uint32_t)std::min<uint64_t>(thread_count, std::max<uint64_t>(options.games, 1));
+
+    std::atomic<uint64_t> next_game{0};
+    std::vector<GambitSelfplaySummary> summaries(thread_count);
+
+    auto run = [&](uint32_t thread)
+    {
+        GambitRandom random(options.seed, thread);
+        auto play = make_player(thread);
+
+        std::vector<std::pair<uint64_t, GambitGameResult>> block;
+        block.reserve(GambitSelfplayWriter::BLOCK_SIZE);
+        for (uint64_t game = next_game++; game < options.games; game = next_game++)
+        {
+            GambitGameResult result = play(random);
+            summaries[thread].add(result);
+            block.push_back({game, result});
+            if (block.size() == GambitSelfplayWriter::BLOCK_SIZE)
+            {
+                writer.write(block);
+                block.clear();
+            }
+        }
+        writer.write(block);
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (uint32_t thread = 1; thread < thread_count; thread++)
+        threads.emplace_back(run, thread);
+    run(0);
+    for (auto &thread : threads)
+        thread.join();
+
+    GambitSelfplaySummary summary;
+    for (const auto &thread_summary : summaries)
+        summary.merge(thread_summary);
+    summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return summary;
+}
+
+// Plays games described in the way mcts.h expects, each starting from a state given by `setup(State &,
+// GambitRandom &)`. Returns false if the output file could not be opened.
+template <typename Game, typename Setup>
+inline bool gambit_selfplay(const GambitSelfplayOptions &options, Setup setup, GambitSelfplaySummary &summary)
+{
+    using State = typename Game::State;
+
+    GambitSelfplayWriter writer;
+    if (!options.output.empty() && !writer.open(options.output))
+        return false;
+
+    summary = gambit_run_selfplay(options, writer, [&](uint32_t thread)
+                                  {
+        // A search for each player that uses one, which is given as many nodes as its budget could use
+        std::vector<std::unique_ptr<GambitMCTS<Game>>> searches(Game::PLAYER_COUNT);
+        for (uint32_t i = 0; i < Game::PLAYER_COUNT; i++)
+        {
+            const GambitPlayer &player = options.players[i % options.players.size()];
+            if (player.kind != GambitPlayer::MCTS)
+                continue;
+
+            GambitSearchOptions search_options;
+            search_options.budget = player.budget;
+            search_options.seed = options.seed + thread * Game::PLAYER_COUNT + i;
+            if (player.budget.iterations > 0)
+                search_options.max_nodes = (uint32_t)std::min<uint64_t>(search_options.max_nodes, player.budget.iterations * Game::MAX_MOVES + 1);
+            searches[i].reset(new GambitMCTS<Game>(search_options));
+        }
+
+        std::unique_ptr<State> state(new State);
+        return [&setup, searches = std::move(searches), state = std::move(state)](GambitRandom &random) mutable
+        {
+            setup(*state, random);
+            uint32_t moves[Game::MAX_MOVES];
+            uint32_t length = 0;
+            while (!Game::is_terminal(*state))
+            {
+                // A game with no legal moves cannot go any further, and is left unfinished
+                uint32_t count = Game::legal_moves(*state, moves);
+                if (count == 0)
+                    break;
+
+                uint32_t player = Game::current_player(*state);
+                uint32_t move = searches[player] ? searches[player]->search(*state) : moves[random.below(count)];
+                Game::apply(*state, move);
+                length++;
+            }
+            return GambitGameResult{state->outcome.ended ? state->outcome.winner : GAMBIT_UNFINISHED, length};
+        }; });
+
+    // Players that never won are still listed
+    if (summary.wins.size() < Game::PLAYER_COUNT)
+        summary.wins.resize(Game::PLAYER_COUNT, 0);
+    return true;
+}
+
+inline void gambit_print_summary(const GambitSelfplaySummary &summary)
+{
+    std::printf("%llu games in %.2f seconds (%.0f games/sec)\n", (unsigned long long)summary.games, summary.seconds, summary.games_per_second());
+    for (size_t i = 0; i < summary.wins.size(); i++)
+        std::printf("player %zu wins   %6.2f%%\n", i + 1, 100.0 * summary.wins[i] / summary.games);
+    std::printf("draws           %6.2f%%\n", 100.0 * summary.draws / summary.games);
+    if (summary.unfinished > 0)
+        std::printf("unfinished      %6.2f%%\n", 100.0 * summary.unfinished / summary.games);
+    std::printf("length          mean %.1f, min %u, median %u, 90%% %u, max %u\n",
+                summary.mean_length(),
+                summary.length_percentile(0),
+                summary.length_percentile(0.5),
+                summary.length_percentile(0.9),
+                summary.lengths.empty() ? 0 : (uint32_t)summary.lengths.size() - 1);
+}
+
+// PROGRAMS //
+
+// Reads `--selfplay N`, `--players LIST`, `--threads N`, `--seed N` and `--output FILE`. Returns
+// false, having printed why, if the arguments are not valid.
+inline bool gambit_parse_selfplay(int argc, char *argv[], bool &selfplay, GambitSelfplayOptions &options)
+{
+    selfplay = false;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string flag = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if (flag == "--selfplay" && has_value)
+        {
+            selfplay = true;
+            options.games = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (flag == "--players" && has_value)
+        {
+            if (!gambit_parse_players(argv[++i], options.players))
+            {
+                std::printf("Players must be a list of random, mcts:N or mcts:Fs, not %s\n", argv[i]);
+                return false;
+            }
+        }
+        else if (flag == "--threads" && has_value)
+            options.threads = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        else if (flag == "--seed" && has_value)
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (flag == "--output" && has_value)
+            options.output = argv[++i];
+        else
+        {
+            std::printf("USAGE: %s [--selfplay N] [--players LIST] [--threads N] [--seed N] [--output FILE]\n", argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+// The entry point of generated programs. `play(State *)` plays one game of the program on a state
+// that has been reset to zero. Without `--selfplay`, the program is played once.
+template <typename State, typename Play>
+inline int gambit_main(int argc, char *argv[], Play play)
+{
+    bool selfplay;
+    GambitSelfplayOptions options;
+    if (!gambit_parse_selfplay(argc, argv, selfplay, options))
+        return 1;
+
+    if (!selfplay)
+    {
+        std::unique_ptr<State> state(new State);
+        std::memset(state.get(), 0, sizeof(State));
+        play(state.get());
+        return 0;
+    }
+
+    for (const auto &player : options.players)
+    {
+        if (player.kind != GambitPlayer::RANDOM)
+        {
+            std::printf("Programs can only be played by random players, as searches need the moves of each decision\n");
+            return 1;
+        }
+    }
+
+    GambitSelfplayWriter writer;
+    if (!options.output.empty() && !writer.open(options.output))
+    {
+        std::printf("Could not open %s\n", options.output.c_str());
+        return 1;
+    }
+
+    // Each decision is counted by the policy, which also makes it
+    struct Policy
+    {
+        GambitRandom *random;
+        uint32_t decisions;
+    };
+
+    auto summary = gambit_run_selfplay(options, writer, [&](uint32_t)
+                                       {
+        std::unique_ptr<State> state(new State);
+        return [&play, state = std::move(state)](GambitRandom &random)
+        {
+            Policy context{&random, 0};
+            gambit_policy.context = &context;
+            gambit_policy.choose = [](void *context, uint32_t, const uint32_t *, uint32_t count)
+            {
+                Policy *policy = static_cast<Policy *>(context);
+                policy->decisions++;
+                return policy->random->below(count);
+            };
+
+            std::memset(state.get(), 0, sizeof(State));
+            play(state.get());
+            gambit_policy = {};
+
+            return GambitGameResult{state->outcome.ended ? state->outcome.winner : GAMBIT_UNFINISHED, context.decisions};
+        }; });
+
+    gambit_print_summary(summary);
+    return 0;
+}
+
+#endif
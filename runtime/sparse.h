@@ -0,0 +1,136 @@
+/*
+sparse.h
+
+State properties with several entity parameters, such as `state int (Card a, Card b).affinity`,
+are stored in a sparse map. A dense array over every combination of entities would need
+capacity^N values, almost all of which would never be assigned, so the map only stores the
+combinations that have been. Looking up any other combination gives the property's initial value.
+
+The map uses open addressing with linear probing, with the key and value of each entry stored in
+separate arrays so that probing only touches keys. Like the rest of the game state, it has a
+fixed capacity and contains no pointers.
+
+Keys are made from the ids of each entity, so an entry belonging to an entity that has been
+destroyed is never found again by the entity that reuses its index. Entries are never removed,
+so the capacity should allow for every combination that is assigned over the course of a game.
+Each map is part of the state, and so is copied whenever the state is, so generated programs size
+each one from the capacities of its key's entities, up to GAMBIT_SPARSE_CAPACITY. The capacity of
+a single property can be set by defining GAMBIT_SPARSE_CAPACITY_<property>, such as
+`-DGAMBIT_SPARSE_CAPACITY_Card_Card_affinity=1024`. Assigning a new combination to a map that is
+already full aborts the program.
+*/
+
+#pragma once
+#ifndef GAMBIT_SPARSE_H
+#define GAMBIT_SPARSE_H
+
+#include "entity.h"
+#include <cstdint>
+
+// The largest number of slots that a sparse map is given by default, which must be a power of two
+#ifndef GAMBIT_SPARSE_CAPACITY
+#define GAMBIT_SPARSE_CAPACITY 256
+#endif
+
+template <uint32_t N>
+struct GambitKey
+{
+    uint32_t ids[N];
+
+    bool operator==(const GambitKey &other) const
+    {
+        for (uint32_t i = 0; i < N; i++)
+        {
+            if (ids[i] != other.ids[i])
+                return false;
+        }
+        return true;
+    }
+
+    uint64_t hash() const
+    {
+        uint64_t hash = 0;
+        for (uint32_t i = 0; i < N; i++)
+        {
+            hash = (hash ^ ids[i]) * 0x9E3779B97F4A7C15ull;
+            hash ^= hash >> 32;
+        }
+        return hash;
+    }
+};
+
+inline GambitKey<2> gambit_key(GambitEntity a, GambitEntity b)
+{
+    return {{a.id, b.id}};
+}
+
+template <uint32_t N>
+inline GambitKey<N + 1> gambit_key(const GambitKey<N> &key, GambitEntity entity)
+{
+    GambitKey<N + 1> result;
+    for (uint32_t i = 0; i < N; i++)
+        result.ids[i] = key.ids[i];
+    result.ids[N] = entity.id;
+    return result;
+}
+
+// The smallest capacity of a map with room for `combinations` entries, but no more than
+// GAMBIT_SPARSE_CAPACITY
+constexpr uint32_t gambit_sparse_capacity(uint64_t combinations)
+{
+    uint32_t capacity = 4;
+    while (capacity < GAMBIT_SPARSE_CAPACITY && capacity / 4 * 3 < combinations)
+        capacity *= 2;
+    return capacity;
+}
+
+// A zero-initialised map is empty. Entries whose first id is 0 are unused, as 0 is never the id
+// of an entity.
+template <typename T, uint32_t N, uint32_t Capacity = GAMBIT_SPARSE_CAPACITY>
+struct GambitSparseMap
+{
+    static_assert(N >= 2, "Properties with a single parameter should be stored in a column");
+    static_assert((Capacity & (Capacity - 1)) == 0, "The capacity of a sparse map must be a power of two");
+
+    // Probe sequences grow quickly as the map fills, so it is never filled beyond this
+    static constexpr uint32_t MAX_COUNT = Capacity / 4 * 3;
+
+    uint32_t count;
+    GambitKey<N> keys[Capacity];
+    T values[Capacity];
+
+    static constexpr uint32_t capacity() { return MAX_COUNT; }
+
+    T get(const GambitKey<N> &key, const T &initial_value) const
+    {
+        uint32_t slot = find(key);
+        return keys[slot].ids[0] == 0 ? initial_value : values[slot];
+    }
+
+    // Returns false if the key is new and the map is already full
+    bool set(const GambitKey<N> &key, const T &value)
+    {
+        uint32_t slot = find(key);
+        if (keys[slot].ids[0] == 0)
+        {
+            if (count >= MAX_COUNT)
+                return false;
+            keys[slot] = key;
+            count++;
+        }
+
+        values[slot] = value;
+        return true;
+    }
+
+    // The slot that contains the key, or the empty slot where it would be inserted
+    uint32_t find(const GambitKey<N> &key) const
+    {
+        uint32_t slot = (uint32_t)key.hash() & (Capacity - 1);
+        while (keys[slot].ids[0] != 0 && !(keys[slot] == key))
+            slot = (slot + 1) & (Capacity - 1);
+        return slot;
+    }
+};
+
+#endif
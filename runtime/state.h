@@ -0,0 +1,103 @@
+/*
+state.h
+
+Generated programs store everything about one game in a single `GambitState` struct: the table
+of each entity type, the column or sparse map of each state property, and the lists stored in
+them. Every one of these has a fixed capacity and refers to entities by id rather than by
+pointer, so the state is one contiguous block that can be moved or copied anywhere. Cloning a
+state, as a search does for every node it explores, is a single memcpy.
+
+States are large, so a search should not allocate a new one for every clone. GambitStatePool
+hands out states from blocks that it allocates up front, and takes them back to be reused.
+*/
+
+#pragma once
+#ifndef GAMBIT_STATE_H
+#define GAMBIT_STATE_H
+
+#include "entity.h"
+#include "journal.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// How a game ended. A zero-initialised outcome is a game that has not ended yet.
+struct GambitOutcome
+{
+    bool ended;
+    int8_t winner; // The index of the player that won, or -1 for a draw
+};
+
+template <typename State>
+inline void gambit_wins(State &state, GambitEntity player)
+{
+    gambit_write(state.outcome, GambitOutcome{true, (int8_t)entity_index(player)});
+}
+
+template <typename State>
+inline void gambit_draw(State &state)
+{
+    gambit_write(state.outcome, GambitOutcome{true, -1});
+}
+
+template <typename State>
+inline void gambit_clone(State &destination, const State &source)
+{
+    static_assert(std::is_trivially_copyable<State>::value, "Game state must be trivially copyable to be cloned");
+    std::memcpy(&destination, &source, sizeof(State));
+}
+
+// States given out by the pool are not initialised, so they should be cloned into (or reset)
+// before they are used. A state stays at the same address until it is released.
+template <typename State>
+class GambitStatePool
+{
+public:
+    explicit GambitStatePool(size_t block_size = 64)
+        : block_size(block_size > 0 ? block_size : 1) {}
+
+    GambitStatePool(const GambitStatePool &) = delete;
+    GambitStatePool &operator=(const GambitStatePool &) = delete;
+
+    State *acquire()
+    {
+        if (free_states.empty())
+            allocate_block();
+
+        State *state = free_states.back();
+        free_states.pop_back();
+        return state;
+    }
+
+    State *clone(const State &source)
+    {
+        State *state = acquire();
+        gambit_clone(*state, source);
+        return state;
+    }
+
+    void release(State *state) { free_states.push_back(state); }
+
+    size_t allocated() const { return blocks.size() * block_size; }
+    size_t in_use() const { return allocated() - free_states.size(); }
+
+private:
+    size_t block_size;
+    std::vector<std::unique_ptr<State[]>> blocks;
+    std::vector<State *> free_states;
+
+    void allocate_block()
+    {
+        blocks.emplace_back(new State[block_size]);
+        State *block = blocks.back().get();
+
+        // States are handed out from the start of the block first
+        for (size_t i = block_size; i > 0; i--)
+            free_states.push_back(&block[i - 1]);
+    }
+};
+
+#endif
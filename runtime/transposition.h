@@ -0,0 +1,102 @@
+/*
+transposition.h
+
+A transposition table maps the hash of a state (see hash.h) to the search node that was expanded
+for it, so that a search which reaches the same state by a different order of moves can share the
+children of that node, rather than growing a second copy of the same subtree.
+
+The table is open addressed, with a fixed number of entries that is a power of two. Entries are
+claimed by swapping their hash in with a compare-and-swap, so several threads can insert into
+and look up in the table at once without locking. A state whose probe sequence is full is simply
+not stored, which only means that its transpositions are not found.
+*/
+
+#pragma once
+#ifndef GAMBIT_TRANSPOSITION_H
+#define GAMBIT_TRANSPOSITION_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+class GambitTranspositionTable
+{
+public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    // The capacity is rounded up to a power of two
+    explicit GambitTranspositionTable(uint32_t capacity)
+    {
+        mask = 1;
+        while (mask < capacity)
+            mask <<= 1;
+        entries.reset(new Entry[mask]);
+        mask -= 1;
+        clear();
+    }
+
+    // Returns the node stored for the hash, or NONE if there is not one yet
+    uint32_t find(uint64_t hash) const
+    {
+        hash = key(hash);
+        for (uint32_t probe = 0; probe < MAX_PROBES; probe++)
+        {
+            const Entry &entry = entries[(hash + probe) & mask];
+            uint64_t stored = entry.hash.load(std::memory_order_acquire);
+            if (stored == hash)
+                return entry.node.load(std::memory_order_acquire);
+            if (stored == 0)
+                return NONE;
+        }
+        return NONE;
+    }
+
+    // Stores the node for the hash, unless the hash is already stored or its probe sequence is
+    // full. The node must be ready to be read by other threads.
+    void insert(uint64_t hash, uint32_t node)
+    {
+        hash = key(hash);
+        for (uint32_t probe = 0; probe < MAX_PROBES; probe++)
+        {
+            Entry &entry = entries[(hash + probe) & mask];
+            uint64_t stored = 0;
+            if (entry.hash.compare_exchange_strong(stored, hash, std::memory_order_acq_rel))
+            {
+                entry.node.store(node, std::memory_order_release);
+                return;
+            }
+            if (stored == hash)
+                return;
+        }
+    }
+
+    // Must not be called while other threads are using the table
+    void clear()
+    {
+        for (uint32_t i = 0; i <= mask; i++)
+        {
+            entries[i].hash.store(0, std::memory_order_relaxed);
+            entries[i].node.store(NONE, std::memory_order_relaxed);
+        }
+    }
+
+    uint32_t capacity() const { return mask + 1; }
+
+private:
+    static constexpr uint32_t MAX_PROBES = 8;
+
+    // A hash of 0 marks an empty entry, so it is stored as 1 instead
+    static uint64_t key(uint64_t hash) { return hash == 0 ? 1 : hash; }
+
+    // The node is NONE until the thread that claimed the entry has stored it
+    struct Entry
+    {
+        std::atomic<uint64_t> hash;
+        std::atomic<uint32_t> node;
+    };
+
+    std::unique_ptr<Entry[]> entries;
+    uint64_t mask;
+};
+
+#endif
@@ -0,0 +1 @@
+lua54 script/benchmark.lua %*
\ No newline at end of file
@@ -0,0 +1,68 @@
+-- This is a lua script designed to build and run the compiler benchmarks.
+-- The script depends on the Windows command prompt.
+-- g++ must be available via the path.
+--
+-- gcc version 8.2.0
+-- lua version 5.4.2
+--
+-- Unlike build.lua, this script is not incremental. The benchmarks are always built from scratch
+-- with optimisations enabled, so that they measure an optimised build of the current source code.
+-- All arguments are passed through to the benchmark executable (e.g. `do benchmark -max 128`).
+--
+-- To check a change for performance regressions, record a baseline before making the change
+-- with `do benchmark record local/baseline.json`, and then compare against it afterwards with
+-- `do benchmark compare local/baseline.json`. The comparison exits with a non-zero code if any
+-- phase of any program in the corpus has become slower or allocates more than it used to.
+
+local BUILD_DIR = "local/build/benchmark"
+local COMPILE_FLAGS = "-O2 --std=c++17"
+
+os.execute("if not exist local\\build\\benchmark mkdir local\\build\\benchmark")
+os.execute("if not exist local\\benchmark mkdir local\\benchmark")
+
+-- BUILD SOURCE FILES --
+local function build_directory(dir, exclude)
+    local handle = io.popen("dir " .. dir .. "\\*.cpp /b")
+    if not handle then
+        error("ERROR: Could not find " .. dir .. " .cpp files")
+    end
+
+    for name in handle:lines() do
+        if name ~= exclude then
+            print("> " .. dir .. "/" .. name)
+
+            local cmd = ("g++ %s -c -o %s/%s_%s.o %s/%s"):format(COMPILE_FLAGS, BUILD_DIR, dir, name:sub(1, -5), dir, name)
+            local start_time = os.clock()
+            local success = os.execute(cmd)
+            local time_taken = os.clock() - start_time
+
+            if success then
+                print(("  %.2f seconds"):format(time_taken))
+            else
+                error("ERROR: Could not compile " .. dir .. "/" .. name)
+            end
+        end
+    end
+
+    handle:close()
+end
+
+-- The compiler's own entry point is excluded, as the benchmark has its own
+build_directory("compiler", "main.cpp")
+build_directory("benchmark")
+
+-- FINAL BUILD --
+print("> Final build")
+local final_build_success = os.execute(("g++ %s -o %s/benchmark.exe %s/*.o -lm -lstdc++fs -pthread"):format(COMPILE_FLAGS, BUILD_DIR, BUILD_DIR))
+if not final_build_success then
+    error("ERROR: Error while linking object files in final build")
+end
+
+-- RUN --
+local cmd = "local\\build\\benchmark\\benchmark.exe"
+for _, flag in ipairs(arg) do
+    cmd = cmd .. " " .. flag
+end
+
+print()
+os.execute(cmd)
@@ -7,18 +7,21 @@
 
 -- FLAGS --
 local REBUILD_ALL = false
+local TRACE = false
 
 local arg_errors = false
 for _, flag in ipairs(arg) do
     if flag == "-r" or flag == "-rebuild" then
         REBUILD_ALL = true
+    elseif flag == "-t" or flag == "-trace" then
+        TRACE = true
     else
         arg_errors = true
     end
 end
 
 if arg_errors then
-    error("USAGE: do build [-rebuild]")
+    error("USAGE: do build [-rebuild] [-trace]")
 end
 
 -- CURRENT TIME --
@@ -56,6 +59,23 @@ else
     print("WARNING: Could not open build cache. This will prevent incremental builds.")
 end
 
+-- CHECK BUILD FLAGS FOR REBUILD --
+-- Object files built with and without tracing cannot be mixed, so the cache records
+-- whether the last build was a trace build, and everything is rebuilt if that changes.
+-- Trace builds define GAMBIT_TRACE, which enables the timers declared in trace.h.
+
+local COMPILE_FLAGS = TRACE and "-DGAMBIT_TRACE " or ""
+
+local trace_flag = TRACE and 1 or 0
+if (cache["-trace"] or 0) ~= trace_flag then
+    if not REBUILD_ALL then
+        print("Rebuilding entire project as the trace flag has changed")
+        print()
+    end
+    REBUILD_ALL = true
+end
+cache["-trace"] = trace_flag
+
 -- READ HEADER FILES --
 local header_dir_handle = io.popen("dir compiler\\*.h /t:w /-c /o:-d")
 if not header_dir_handle then
@@ -117,7 +137,7 @@ for line in source_dir_handle:lines() do
         if REBUILD_ALL or not cached_time or cached_time == CURRENT_TIME or cached_time < time_last_written then
             print("> " .. name)
 
-            local cmd = ("g++ -g --std=c++17 -c -o local/build/%s.o compiler/%s "):format(name:sub(1, -5), name)
+            local cmd = ("g++ -g --std=c++17 %s-c -o local/build/%s.o compiler/%s "):format(COMPILE_FLAGS, name:sub(1, -5), name)
             local start_time = os.clock()
             local success = os.execute(cmd)
             local time_taken = os.clock() - start_time
@@ -153,7 +173,7 @@ end
 
 print("> Final build")
 local start_time = os.clock()
-local final_build_success = os.execute("g++ -g --std=c++17 -lm -o local/build/main.exe local/build/*.o")
+local final_build_success = os.execute("g++ -g --std=c++17 -lm -o local/build/main.exe local/build/*.o -lstdc++fs -pthread")
 local time_taken = os.clock() - start_time
 
 if final_build_success then
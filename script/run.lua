@@ -1,6 +1,6 @@
 local cmd = "local\\build\\main.exe"
-if arg[1] then
-    cmd = cmd .. " " .. arg[1]
+for _, flag in ipairs(arg) do
+    cmd = cmd .. " " .. flag
 end
 
 local start_time = os.clock()